@@ -0,0 +1,44 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "camera.h"
+#include "light.h"
+
+// 基准工具共用的部分：相机和光源的脚本路径（GPU与CPU渲染的同一帧取景完全一致）和帧时间统计
+
+const float TWO_PI = 6.28318530718f;
+
+enum class CameraPath {
+    Orbit,      // 水平环绕一周，光源反向绕两圈
+    Sweep       // 俯仰和距离来回变化，近景与远景交替，光源上下移动并改变强度
+};
+
+// 相机和光源的位置只由帧号决定，每次运行都完全一致
+inline void applyPath(CameraPath path, int frame, int frames, Camera& camera, Light& light)
+{
+    float t = float(frame) / float(frames);
+    float angle = t * TWO_PI;
+
+    if (path == CameraPath::Orbit) {
+        camera.SetOrbit(-90.0f + 360.0f * t, 15.0f, 5.0f);
+        light.position = glm::vec3(2.0f * std::cos(-2.0f * angle), 1.5f, 2.0f * std::sin(-2.0f * angle));
+        light.intensity = 1.0f;
+    } else {
+        camera.SetOrbit(-90.0f + 90.0f * std::sin(angle), 60.0f * std::sin(2.0f * angle), 4.5f + 2.5f * std::cos(angle));
+        light.position = glm::vec3(1.5f * std::cos(angle), 2.0f * std::sin(3.0f * angle), 1.5f);
+        light.intensity = 1.0f + 0.5f * std::sin(angle);
+    }
+}
+
+// 已排序数据的百分位数
+inline double percentile(const std::vector<double>& sorted, double p)
+{
+    size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+#endif
@@ -0,0 +1,636 @@
+// 离屏渲染基准：EGL surfaceless上下文渲染到FBO，相机和光源沿确定的脚本路径运动
+// 用法: headless_bench [--width W] [--height H] [--frames N] [--warmup N]
+//                      [--model path.obj] [--path orbit|sweep] [--flat] [--deferred] [--no-lod] [--ppm out.ppm]
+//                      [--instances 1000,10000,100000] [--lights 16,256,1024]
+//                      [--optimize none|cache|overdraw] [--compare-optimize]
+//                      [--float-vertices] [--compare-format] [--no-meshlet-culling] [--compare-culling]
+//                      [--gizmos 16,256,1024] [--no-shader-cache]
+// 每帧末尾glFinish，帧时间包含GPU（或llvmpipe）完成渲染的时间
+// 指定--instances时，对每个实例数分别测量实例化绘制和逐实例绘制并输出对比表
+// 指定--lights时，对每个点光源数分别测量分簇着色和暴力遍历并输出对比表
+// 指定--compare-optimize时，分别以三种网格优化方式加载模型，输出ACMR/ATVR与帧时间对比表
+// 指定--compare-format时，分别以float和紧凑顶点格式渲染，输出缓冲大小、帧时间和最后一帧的像素差异
+// 指定--gizmos时，对每个点光源数分别逐个绘制和实例化绘制光源球体并输出对比表
+// 指定--compare-culling时，分别关闭簇剔除、只做视锥剔除、视锥加背面剔除，输出剔除比例、CPU耗时和帧时间
+#include "headless_context.h"
+#include "renderer.h"
+#include "profiler.h"
+#include "bench_common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    int width = 1280;
+    int height = 720;
+    int frames = 600;
+    int warmup = 30;
+    std::string model = "models/eight.uniform.obj";
+    CameraPath path = CameraPath::Orbit;
+    bool flat = false;
+    bool deferred = false;
+    bool lod = true;
+    MeshOptimize optimization = MeshOptimize::VertexCache;
+    bool compareOptimize = false;
+    VertexFormat vertexFormat = VertexFormat::Compact;
+    bool compareFormat = false;
+    bool meshletCulling = true;
+    bool backfaceCulling = false;   // 模型加载后取MeshData::closed
+    bool compareCulling = false;
+    std::string ppm;
+    std::vector<size_t> instanceCounts;
+    std::vector<size_t> lightCounts;
+    std::vector<size_t> gizmoCounts;
+    bool shaderCache = true;
+};
+
+// 解析逗号分隔的数量列表
+void parseCounts(const char* text, std::vector<size_t>& counts)
+{
+    std::stringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ','))
+        counts.push_back(std::max(1L, std::atol(item.c_str())));
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--width" && hasValue)
+            options.width = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--height" && hasValue)
+            options.height = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--frames" && hasValue)
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--warmup" && hasValue)
+            options.warmup = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--model" && hasValue)
+            options.model = argv[++i];
+        else if (arg == "--path" && hasValue) {
+            std::string name = argv[++i];
+            if (name == "orbit")
+                options.path = CameraPath::Orbit;
+            else if (name == "sweep")
+                options.path = CameraPath::Sweep;
+            else {
+                std::cout << "Unknown path: " << name << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--flat")
+            options.flat = true;
+        else if (arg == "--deferred")
+            options.deferred = true;
+        else if (arg == "--no-lod")
+            options.lod = false;
+        else if (arg == "--optimize" && hasValue) {
+            std::string name = argv[++i];
+            if (name == "none")
+                options.optimization = MeshOptimize::None;
+            else if (name == "cache")
+                options.optimization = MeshOptimize::VertexCache;
+            else if (name == "overdraw")
+                options.optimization = MeshOptimize::Overdraw;
+            else {
+                std::cout << "Unknown optimization: " << name << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--compare-optimize")
+            options.compareOptimize = true;
+        else if (arg == "--float-vertices")
+            options.vertexFormat = VertexFormat::Float;
+        else if (arg == "--compare-format")
+            options.compareFormat = true;
+        else if (arg == "--no-meshlet-culling")
+            options.meshletCulling = false;
+        else if (arg == "--compare-culling")
+            options.compareCulling = true;
+        else if (arg == "--ppm" && hasValue)
+            options.ppm = argv[++i];
+        else if (arg == "--instances" && hasValue)
+            parseCounts(argv[++i], options.instanceCounts);
+        else if (arg == "--lights" && hasValue)
+            parseCounts(argv[++i], options.lightCounts);
+        else if (arg == "--gizmos" && hasValue)
+            parseCounts(argv[++i], options.gizmoCounts);
+        else if (arg == "--no-shader-cache")
+            options.shaderCache = false;
+        else {
+            std::cout << "Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// 把count个实例排成立方网格，整个网格占据[-2,2]^3，与单个模型的取景相近
+// 旋转、轻微的非均匀缩放和颜色由固定种子生成，每次运行完全一致
+void buildInstances(const Model& model, size_t count, bool flat, std::vector<InstanceData>& instances)
+{
+    size_t side = 1;
+    while (side * side * side < count)
+        side++;
+
+    glm::vec3 extent = model.boundsMax - model.boundsMin;
+    glm::vec3 center = 0.5f * (model.boundsMin + model.boundsMax);
+    float size = std::max(extent.x, std::max(extent.y, extent.z));
+    float cell = 4.0f / side;
+    float scale = size > 0.0f ? 0.8f * cell / size : 1.0f;
+
+    std::mt19937 rng(20240601);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    instances.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 cellIndex(float(i % side), float(i / side % side), float(i / (side * side)));
+        glm::vec3 position = glm::vec3(-2.0f) + cell * (cellIndex + glm::vec3(0.5f));
+        glm::vec3 axis = glm::normalize(glm::vec3(unit(rng) - 0.5f, unit(rng) - 0.5f, unit(rng) - 0.5f) + glm::vec3(0.0f, 0.01f, 0.0f));
+
+        glm::mat4 transform = glm::translate(glm::mat4(1.0f), position);
+        transform = glm::rotate(transform, unit(rng) * TWO_PI, axis);
+        transform = glm::scale(transform, scale * glm::vec3(1.0f, 0.75f + 0.5f * unit(rng), 1.0f));
+        transform = glm::translate(transform, -center);
+
+        glm::vec3 color(0.3f + 0.7f * unit(rng), 0.3f + 0.7f * unit(rng), 0.3f + 0.7f * unit(rng));
+        instances[i] = makeInstance(transform, color, flat);
+    }
+}
+
+bool writePPM(const std::string& path, const HeadlessContext& context)
+{
+    std::vector<unsigned char> rgb(size_t(context.getWidth()) * context.getHeight() * 3);
+    context.readPixels(rgb.data());
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open())
+        return false;
+    out << "P6\n" << context.getWidth() << " " << context.getHeight() << "\n255\n";
+    out.write(reinterpret_cast<const char*>(rgb.data()), rgb.size());
+    return out.good();
+}
+
+} // namespace
+
+// 一次测量的帧时间与每帧的绘制统计
+struct RunResult {
+    std::vector<double> frameTimes;     // 已排序，毫秒
+    double total = 0.0;
+    unsigned int drawCalls = 0;
+    unsigned int uniformCalls = 0;
+    size_t triangles = 0;               // 每帧平均，LOD随相机距离变化
+
+    // 点光源分簇（取所有帧的平均）
+    double cullMilliseconds = 0.0;
+    size_t visibleLights = 0;
+    size_t clusterLightRefs = 0;
+
+    // 网格簇剔除（取所有帧的平均）
+    size_t meshlets = 0;
+    size_t frustumCulled = 0;
+    size_t backfaceCulled = 0;
+    size_t drawRanges = 0;
+    double meshletMilliseconds = 0.0;
+
+    double average() const { return total / frameTimes.size(); }
+    double megaTrianglesPerSecond() const { return triangles * frameTimes.size() / (total * 1000.0); }
+};
+
+RunResult runFrames(const Options& options, Renderer& renderer, const RenderSettings& settings, Profiler* profiler)
+{
+    Camera camera;
+    Light light;
+
+    RunResult result;
+    result.frameTimes.reserve(options.frames);
+
+    for (int frame = -options.warmup; frame < options.frames; frame++) {
+        applyPath(options.path, std::max(frame, 0), options.frames, camera, light);
+
+        // 预热帧（着色器的延迟编译、缓冲首次上传等）不计入统计
+        Profiler* activeProfiler = frame >= 0 ? profiler : nullptr;
+
+        auto start = std::chrono::steady_clock::now();
+        if (activeProfiler)
+            activeProfiler->BeginFrame();
+        Shader::uniformCalls = 0;
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        renderer.Render(camera, light, settings, options.width, options.height, activeProfiler);
+        if (activeProfiler)
+            activeProfiler->EndFrame();
+        glFinish();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        const RenderStats& stats = renderer.GetStats();
+        if (frame >= 0) {
+            result.frameTimes.push_back(ms);
+            result.total += ms;
+            result.cullMilliseconds += stats.cullMilliseconds;
+            result.visibleLights += stats.visibleLights;
+            result.clusterLightRefs += stats.clusterLightRefs;
+            result.triangles += stats.triangles;
+            result.meshlets += stats.meshlets;
+            result.frustumCulled += stats.frustumCulled;
+            result.backfaceCulled += stats.backfaceCulled;
+            result.drawRanges += stats.drawRanges;
+            result.meshletMilliseconds += stats.meshletMilliseconds;
+        }
+        result.drawCalls = stats.drawCalls;
+        result.uniformCalls = Shader::uniformCalls;
+    }
+
+    result.cullMilliseconds /= options.frames;
+    result.visibleLights /= options.frames;
+    result.clusterLightRefs /= options.frames;
+    result.triangles /= options.frames;
+    result.meshlets /= options.frames;
+    result.frustumCulled /= options.frames;
+    result.backfaceCulled /= options.frames;
+    result.drawRanges /= options.frames;
+    result.meshletMilliseconds /= options.frames;
+    std::sort(result.frameTimes.begin(), result.frameTimes.end());
+    return result;
+}
+
+// 实例化与逐实例绘制的对比表
+void runInstanceComparison(const Options& options, const Model& model, Renderer& renderer)
+{
+    std::cout << std::left << std::setw(11) << "instances" << std::setw(11) << "mode"
+              << std::setw(12) << "draw calls" << std::setw(15) << "uniform calls"
+              << std::setw(10) << "avg ms" << std::setw(10) << "p99 ms" << std::setw(10) << "Mtri/s" << "speedup" << std::endl;
+
+    std::vector<InstanceData> instances;
+    for (size_t count : options.instanceCounts) {
+        buildInstances(model, count, options.flat, instances);
+        renderer.SetInstances(instances.data(), instances.size());
+
+        RenderSettings settings;
+        settings.deferred = options.deferred;
+        settings.lod = options.lod;
+        settings.meshletCulling = options.meshletCulling;
+        settings.backfaceCulling = options.backfaceCulling;
+        settings.instancing = false;
+        RunResult separate = runFrames(options, renderer, settings, nullptr);
+        settings.instancing = true;
+        RunResult instanced = runFrames(options, renderer, settings, nullptr);
+
+        for (const RunResult* result : { &separate, &instanced }) {
+            std::cout << std::left << std::setw(11) << count << std::setw(11) << (result == &instanced ? "instanced" : "separate")
+                      << std::setw(12) << result->drawCalls << std::setw(15) << result->uniformCalls
+                      << std::setw(10) << result->average() << std::setw(10) << percentile(result->frameTimes, 0.99)
+                      << std::setw(10) << result->megaTrianglesPerSecond()
+                      << separate.average() / result->average() << "x" << std::endl;
+        }
+    }
+    renderer.SetInstances(nullptr, 0);
+}
+
+// 分簇着色与暴力遍历全部点光源的对比表
+void runLightComparison(const Options& options, Renderer& renderer)
+{
+    std::cout << std::left << std::setw(8) << "lights" << std::setw(13) << "mode"
+              << std::setw(10) << "avg ms" << std::setw(10) << "p99 ms" << std::setw(10) << "cull ms"
+              << std::setw(9) << "visible" << std::setw(12) << "refs/frame" << "speedup" << std::endl;
+
+    std::vector<PointLight> lights;
+    for (size_t count : options.lightCounts) {
+        generatePointLights(count, glm::vec3(0.0f), 2.5f, 1, lights);
+        renderer.SetPointLights(lights.data(), lights.size());
+
+        RenderSettings settings;
+        settings.deferred = options.deferred;
+        settings.lod = options.lod;
+        settings.meshletCulling = options.meshletCulling;
+        settings.backfaceCulling = options.backfaceCulling;
+        settings.lightCulling = LightCulling::BruteForce;
+        RunResult bruteForce = runFrames(options, renderer, settings, nullptr);
+        settings.lightCulling = LightCulling::Clustered;
+        RunResult clustered = runFrames(options, renderer, settings, nullptr);
+
+        for (const RunResult* result : { &bruteForce, &clustered }) {
+            bool isClustered = result == &clustered;
+            std::cout << std::left << std::setw(8) << count << std::setw(13) << (isClustered ? "clustered" : "brute force")
+                      << std::setw(10) << result->average() << std::setw(10) << percentile(result->frameTimes, 0.99)
+                      << std::setw(10) << result->cullMilliseconds
+                      << std::setw(9) << (isClustered ? result->visibleLights : count)
+                      << std::setw(12) << result->clusterLightRefs
+                      << bruteForce.average() / result->average() << "x" << std::endl;
+        }
+    }
+    renderer.SetPointLights(nullptr, 0);
+}
+
+// 光源球体逐个绘制与实例化绘制的对比表，CPU/GPU时间取球体绘制阶段的计时
+void runGizmoComparison(const Options& options, Renderer& renderer)
+{
+    std::cout << std::left << std::setw(8) << "gizmos" << std::setw(11) << "mode" << std::setw(12) << "draw calls"
+              << std::setw(15) << "uniform calls" << std::setw(10) << "CPU ms" << std::setw(10) << "GPU ms"
+              << std::setw(10) << "avg ms" << std::setw(10) << "p99 ms" << "speedup" << std::endl;
+
+    std::vector<PointLight> lights;
+    for (size_t count : options.gizmoCounts) {
+        generatePointLights(count, glm::vec3(0.0f), 2.5f, 1, lights);
+        renderer.SetPointLights(lights.data(), lights.size());
+
+        RunResult results[2];
+        double cpu[2] = { 0.0, 0.0 }, gpu[2] = { 0.0, 0.0 };
+        for (int i = 0; i < 2; i++) {
+            RenderSettings settings;
+            settings.deferred = options.deferred;
+            settings.lod = options.lod;
+            settings.meshletCulling = options.meshletCulling;
+            settings.backfaceCulling = options.backfaceCulling;
+            settings.instancing = i == 1;
+
+            Profiler profiler;
+            results[i] = runFrames(options, renderer, settings, &profiler);
+            profiler.Summarize();
+            for (const PassSummary& pass : profiler.GetSummary()) {
+                if (pass.name == "Sphere") {
+                    cpu[i] = pass.cpu.avg;
+                    gpu[i] = pass.gpu.avg;
+                }
+            }
+        }
+
+        for (int i = 0; i < 2; i++) {
+            const RunResult& result = results[i];
+            std::cout << std::left << std::setw(8) << count << std::setw(11) << (i == 1 ? "instanced" : "separate")
+                      << std::setw(12) << result.drawCalls << std::setw(15) << result.uniformCalls
+                      << std::setw(10) << cpu[i] << std::setw(10) << gpu[i]
+                      << std::setw(10) << result.average() << std::setw(10) << percentile(result.frameTimes, 0.99)
+                      << results[0].average() / result.average() << "x" << std::endl;
+        }
+    }
+    renderer.SetPointLights(nullptr, 0);
+}
+
+// 不同网格优化方式的对比表：每种方式都直接解析OBJ（不读写缓存），GPU时间取模型绘制阶段的计时查询
+void runOptimizeComparison(const Options& options, Sphere& lightSphere)
+{
+    const MeshOptimize modes[] = { MeshOptimize::None, MeshOptimize::VertexCache, MeshOptimize::Overdraw };
+    const char* names[] = { "none", "cache", "overdraw" };
+
+    struct Row {
+        VertexCacheStats cache;
+        RunResult result;
+        double gpu = 0.0;
+    };
+    Row rows[3];
+
+    RenderSettings settings;
+    settings.deferred = options.deferred;
+    settings.lod = options.lod;
+    settings.meshletCulling = options.meshletCulling;
+    settings.backfaceCulling = options.backfaceCulling;
+    for (int i = 0; i < 3; i++) {
+        Model model(options.model.c_str(), false, modes[i], options.vertexFormat);
+        model.modelColor = glm::vec3(0.8f, 0.5f, 0.3f);
+        model.useVertexNormal = !options.flat;
+        Renderer renderer(model, lightSphere);
+
+        Profiler profiler;
+        rows[i].cache = model.cacheStatsAfter;
+        rows[i].result = runFrames(options, renderer, settings, &profiler);
+        profiler.Summarize();
+        for (const PassSummary& pass : profiler.GetSummary()) {
+            if (pass.name == (options.deferred ? "GBuffer" : "Model"))
+                rows[i].gpu = pass.gpu.avg;
+        }
+    }
+
+    std::cout << std::left << std::setw(10) << "optimize" << std::setw(8) << "ACMR" << std::setw(8) << "ATVR"
+              << std::setw(10) << "avg ms" << std::setw(10) << "p99 ms" << std::setw(12) << "GPU ms" << "speedup" << std::endl;
+    for (int i = 0; i < 3; i++) {
+        const RunResult& result = rows[i].result;
+        std::cout << std::left << std::setw(10) << names[i] << std::setw(8) << rows[i].cache.acmr << std::setw(8) << rows[i].cache.atvr
+                  << std::setw(10) << result.average() << std::setw(10) << percentile(result.frameTimes, 0.99)
+                  << std::setw(12) << rows[i].gpu << rows[0].result.average() / result.average() << "x" << std::endl;
+    }
+}
+
+// 簇剔除的对比表：关闭、只做视锥剔除、视锥加背面剔除；像素差异以关闭剔除时的最后一帧为基准
+void runCullingComparison(const Options& options, Renderer& renderer, const HeadlessContext& context)
+{
+    const char* names[] = { "off", "frustum", "+backface" };
+
+    struct Row {
+        RunResult result;
+        double gpu = 0.0;
+        std::vector<unsigned char> pixels;
+    };
+    Row rows[3];
+
+    for (int i = 0; i < 3; i++) {
+        RenderSettings settings;
+        settings.deferred = options.deferred;
+        settings.lod = options.lod;
+        settings.meshletCulling = i > 0;
+        settings.backfaceCulling = i > 1;
+
+        Profiler profiler;
+        rows[i].result = runFrames(options, renderer, settings, &profiler);
+        profiler.Summarize();
+        for (const PassSummary& pass : profiler.GetSummary()) {
+            if (pass.name == (options.deferred ? "GBuffer" : "Model"))
+                rows[i].gpu = pass.gpu.avg;
+        }
+        rows[i].pixels.resize(size_t(context.getWidth()) * context.getHeight() * 3);
+        context.readPixels(rows[i].pixels.data());
+    }
+
+    std::cout << std::left << std::setw(11) << "culling" << std::setw(11) << "triangles" << std::setw(10) << "meshlets"
+              << std::setw(10) << "frustum" << std::setw(10) << "backface" << std::setw(8) << "ranges" << std::setw(9) << "cull ms"
+              << std::setw(10) << "avg ms" << std::setw(10) << "p99 ms" << std::setw(10) << "GPU ms" << std::setw(10) << "max diff"
+              << "speedup" << std::endl;
+    for (int i = 0; i < 3; i++) {
+        const RunResult& result = rows[i].result;
+        int maxDiff = 0;
+        for (size_t p = 0; p < rows[i].pixels.size(); p++)
+            maxDiff = std::max(maxDiff, std::abs(int(rows[i].pixels[p]) - int(rows[0].pixels[p])));
+        double tested = std::max<size_t>(result.meshlets, 1);
+        std::cout << std::left << std::setw(11) << names[i] << std::setw(11) << result.triangles << std::setw(10) << result.meshlets
+                  << std::setw(10) << 100.0 * result.frustumCulled / tested << std::setw(10) << 100.0 * result.backfaceCulled / tested
+                  << std::setw(8) << result.drawRanges << std::setw(9) << result.meshletMilliseconds
+                  << std::setw(10) << result.average() << std::setw(10) << percentile(result.frameTimes, 0.99)
+                  << std::setw(10) << rows[i].gpu << std::setw(10) << maxDiff
+                  << rows[0].result.average() / result.average() << "x" << std::endl;
+    }
+}
+
+// float与紧凑顶点格式的对比表：同一模型切换格式后重新上传，像素差异以float格式的最后一帧为基准
+void runFormatComparison(const Options& options, Model& model, Renderer& renderer, const HeadlessContext& context)
+{
+    const VertexFormat formats[] = { VertexFormat::Float, VertexFormat::Compact };
+    const char* names[] = { "float", "compact" };
+
+    struct Row {
+        size_t vertexBytes = 0;
+        size_t indexBytes = 0;
+        GLenum indexType = GL_UNSIGNED_INT;
+        VertexPackingError error;
+        RunResult result;
+        double gpu = 0.0;
+        std::vector<unsigned char> pixels;
+    };
+    Row rows[2];
+
+    RenderSettings settings;
+    settings.deferred = options.deferred;
+    settings.lod = options.lod;
+    settings.meshletCulling = options.meshletCulling;
+    settings.backfaceCulling = options.backfaceCulling;
+    for (int i = 0; i < 2; i++) {
+        model.SetVertexFormat(formats[i]);
+        rows[i].vertexBytes = model.vertexBufferBytes;
+        rows[i].indexBytes = model.indexBufferBytes;
+        rows[i].indexType = model.GetIndexType();
+        rows[i].error = model.packingError;
+
+        Profiler profiler;
+        rows[i].result = runFrames(options, renderer, settings, &profiler);
+        profiler.Summarize();
+        for (const PassSummary& pass : profiler.GetSummary()) {
+            if (pass.name == (options.deferred ? "GBuffer" : "Model"))
+                rows[i].gpu = pass.gpu.avg;
+        }
+        rows[i].pixels.resize(size_t(context.getWidth()) * context.getHeight() * 3);
+        context.readPixels(rows[i].pixels.data());
+    }
+    model.SetVertexFormat(options.vertexFormat);
+
+    std::cout << std::left << std::setw(9) << "format" << std::setw(11) << "VBO KB" << std::setw(11) << "EBO KB"
+              << std::setw(7) << "index" << std::setw(10) << "avg ms" << std::setw(10) << "p99 ms" << std::setw(10) << "GPU ms"
+              << std::setw(10) << "max diff" << std::setw(11) << "mean diff" << "speedup" << std::endl;
+    for (int i = 0; i < 2; i++) {
+        const RunResult& result = rows[i].result;
+        int maxDiff = 0;
+        double sumDiff = 0.0;
+        for (size_t p = 0; p < rows[i].pixels.size(); p++) {
+            int diff = std::abs(int(rows[i].pixels[p]) - int(rows[0].pixels[p]));
+            maxDiff = std::max(maxDiff, diff);
+            sumDiff += diff;
+        }
+        std::cout << std::left << std::setw(9) << names[i] << std::setw(11) << rows[i].vertexBytes / 1024.0
+                  << std::setw(11) << rows[i].indexBytes / 1024.0 << std::setw(7) << (rows[i].indexType == GL_UNSIGNED_SHORT ? 16 : 32)
+                  << std::setw(10) << result.average() << std::setw(10) << percentile(result.frameTimes, 0.99)
+                  << std::setw(10) << rows[i].gpu << std::setw(10) << maxDiff
+                  << std::setw(11) << sumDiff / rows[i].pixels.size() << rows[0].result.average() / result.average() << "x" << std::endl;
+    }
+
+    const Row& compact = rows[1];
+    std::cout << "Compact buffers: " << 100.0 * (compact.vertexBytes + compact.indexBytes) / (rows[0].vertexBytes + rows[0].indexBytes)
+              << "% of float, max position error " << std::scientific << compact.error.maxPosition << std::fixed
+              << " (bounds diagonal " << glm::length(model.boundsMax - model.boundsMin) << "), max normal error "
+              << compact.error.maxNormalDegrees << " deg" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+
+    HeadlessContext context;
+    if (!context.create(options.width, options.height))
+        return 1;
+
+    std::cout << "Renderer: " << glGetString(GL_RENDERER) << " (" << glGetString(GL_VERSION) << ")" << std::endl;
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    Model model(options.model.c_str(), true, options.optimization, options.vertexFormat);
+    if (model.IndexCount() == 0)
+        return 1;
+    model.modelColor = glm::vec3(0.8f, 0.5f, 0.3f);
+    model.useVertexNormal = !options.flat;
+    // 开放网格的背面可见，只对封闭网格做簇的背面剔除
+    options.backfaceCulling = model.closed;
+    Sphere lightSphere(0.25f);
+
+    if (!options.shaderCache)
+        setShaderCacheDirectory("");
+    Renderer renderer(model, lightSphere);
+    const ShaderBuildStats& shaderStats = shaderBuildStats();
+    std::cout << "Shaders: " << shaderStats.programs << " programs in " << shaderStats.milliseconds << " ms ("
+              << shaderStats.cacheHits << " from binary cache)" << std::endl;
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << options.width << "x" << options.height << ", " << options.frames << " frames (+" << options.warmup
+              << " warmup), path " << (options.path == CameraPath::Orbit ? "orbit" : "sweep")
+              << ", " << (options.flat ? "flat" : "smooth") << " normals, "
+              << (options.deferred ? "deferred" : "forward") << " shading, LOD " << (options.lod ? "on" : "off")
+              << ", " << (options.vertexFormat == VertexFormat::Compact ? "compact" : "float") << " vertices, "
+              << (model.closed ? "closed" : "open") << " mesh" << std::endl;
+
+    if (options.compareOptimize) {
+        runOptimizeComparison(options, lightSphere);
+    } else if (options.compareFormat) {
+        runFormatComparison(options, model, renderer, context);
+    } else if (options.compareCulling) {
+        runCullingComparison(options, renderer, context);
+    } else if (!options.instanceCounts.empty()) {
+        runInstanceComparison(options, model, renderer);
+    } else if (!options.lightCounts.empty()) {
+        runLightComparison(options, renderer);
+    } else if (!options.gizmoCounts.empty()) {
+        runGizmoComparison(options, renderer);
+    } else {
+        Profiler profiler;
+        RenderSettings settings;
+        settings.deferred = options.deferred;
+        settings.lod = options.lod;
+        settings.meshletCulling = options.meshletCulling;
+        settings.backfaceCulling = options.backfaceCulling;
+        RunResult result = runFrames(options, renderer, settings, &profiler);
+        const std::vector<double>& sorted = result.frameTimes;
+
+        std::cout << result.triangles << " triangles/frame, " << result.drawCalls << " draw calls/frame" << std::endl;
+        if (options.meshletCulling && result.meshlets > 0)
+            std::cout << "Meshlets/frame: " << result.meshlets << " tested, " << result.frustumCulled << " outside frustum, "
+                      << result.backfaceCulled << " back-facing, " << result.drawRanges << " draw ranges, cull "
+                      << result.meshletMilliseconds << " ms" << std::endl;
+        std::cout << "Frame ms: min " << sorted.front() << "  avg " << result.average() << "  p50 " << percentile(sorted, 0.50)
+                  << "  p90 " << percentile(sorted, 0.90) << "  p99 " << percentile(sorted, 0.99)
+                  << "  max " << sorted.back() << std::endl;
+        std::cout << "Throughput: " << 1000.0 / result.average() << " fps, "
+                  << result.megaTrianglesPerSecond() << " Mtri/s" << std::endl;
+
+        profiler.Summarize();
+        std::cout << "Per pass ms min/avg/p99 (last " << profiler.GetFrameStats().samples << " frames):" << std::endl;
+        for (const PassSummary& pass : profiler.GetSummary()) {
+            std::cout << "  " << std::left << std::setw(8) << pass.name << std::right
+                      << " CPU " << pass.cpu.min << "/" << pass.cpu.avg << "/" << pass.cpu.p99;
+            if (pass.gpu.samples > 0)
+                std::cout << "  GPU " << pass.gpu.min << "/" << pass.gpu.avg << "/" << pass.gpu.p99;
+            std::cout << std::endl;
+        }
+    }
+
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR)
+        std::cout << "GL error: 0x" << std::hex << error << std::dec << std::endl;
+
+    if (!options.ppm.empty()) {
+        if (writePPM(options.ppm, context))
+            std::cout << "Wrote last frame to " << options.ppm << std::endl;
+        else
+            std::cout << "Failed to open file: " << options.ppm << std::endl;
+    }
+    return error == GL_NO_ERROR ? 0 : 1;
+}
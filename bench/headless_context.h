@@ -0,0 +1,125 @@
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+#include <GL/glew.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <iostream>
+
+// 无窗口的OpenGL 3.3 core上下文，渲染到FBO
+// 优先使用Mesa的surfaceless平台（无显示器、无GPU时由llvmpipe软件渲染），否则退回默认显示
+class HeadlessContext {
+public:
+    HeadlessContext() : display(EGL_NO_DISPLAY), context(EGL_NO_CONTEXT), fbo(0), colorBuffer(0), depthBuffer(0), width(0), height(0) {}
+
+    ~HeadlessContext()
+    {
+        if (fbo) {
+            glDeleteFramebuffers(1, &fbo);
+            glDeleteRenderbuffers(1, &colorBuffer);
+            glDeleteRenderbuffers(1, &depthBuffer);
+        }
+        if (context != EGL_NO_CONTEXT) {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            eglDestroyContext(display, context);
+        }
+        if (display != EGL_NO_DISPLAY)
+            eglTerminate(display);
+    }
+
+    bool create(int w, int h)
+    {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+        if (getPlatformDisplay)
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+#endif
+        if (display == EGL_NO_DISPLAY)
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+        EGLint major, minor;
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+            std::cout << "ERROR::EGL: Failed to initialize display" << std::endl;
+            display = EGL_NO_DISPLAY;
+            return false;
+        }
+        if (!eglBindAPI(EGL_OPENGL_API)) {
+            std::cout << "ERROR::EGL: OpenGL API not supported" << std::endl;
+            return false;
+        }
+
+        // 不需要任何表面，所以不选择EGLConfig（EGL_KHR_no_config_context + EGL_KHR_surfaceless_context）
+        const EGLint attributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 3,
+            EGL_CONTEXT_MINOR_VERSION, 3,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+        if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+            std::cout << "ERROR::EGL: Failed to create a surfaceless OpenGL 3.3 core context" << std::endl;
+            return false;
+        }
+
+        // GLEW按GLX构建时没有X显示会返回GLEW_ERROR_NO_GLX_DISPLAY，但函数指针已经加载
+        glewExperimental = GL_TRUE;
+        GLenum result = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+        if (result == GLEW_ERROR_NO_GLX_DISPLAY)
+            result = GLEW_OK;
+#endif
+        if (result != GLEW_OK) {
+            std::cout << "Failed to initialize GLEW" << std::endl;
+            return false;
+        }
+
+        width = w;
+        height = h;
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glGenRenderbuffers(1, &colorBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+        glGenRenderbuffers(1, &depthBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cout << "ERROR::FRAMEBUFFER: Offscreen framebuffer is not complete" << std::endl;
+            return false;
+        }
+        glViewport(0, 0, width, height);
+        return true;
+    }
+
+    // 读回颜色缓冲，按从上到下的行序写入rgb（width*height*3字节）
+    void readPixels(unsigned char* rgb) const
+    {
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, rgb);
+        for (int y = 0; y < height / 2; y++) {
+            unsigned char* a = rgb + size_t(y) * width * 3;
+            unsigned char* b = rgb + size_t(height - 1 - y) * width * 3;
+            for (int i = 0; i < width * 3; i++) {
+                unsigned char t = a[i];
+                a[i] = b[i];
+                b[i] = t;
+            }
+        }
+    }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+private:
+    EGLDisplay display;
+    EGLContext context;
+    GLuint fbo, colorBuffer, depthBuffer;
+    int width, height;
+};
+
+#endif
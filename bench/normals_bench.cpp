@@ -0,0 +1,94 @@
+// 顶点法线计算的线程扩展性基准
+// 用法: normals_bench [model.obj] [重复次数]
+// 不指定模型时生成一个约两百万顶点的波浪网格
+#include "obj_loader.h"
+#include "mesh_normals.h"
+#include "parallel.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+void buildGrid(unsigned int n, ObjMesh& mesh)
+{
+    mesh.positions.resize(size_t(n) * n);
+    for (unsigned int j = 0; j < n; j++) {
+        for (unsigned int i = 0; i < n; i++) {
+            float u = float(i) / (n - 1), v = float(j) / (n - 1);
+            mesh.positions[size_t(j) * n + i] = glm::vec3(u, 0.05f * std::sin(u * 40.0f) * std::cos(v * 30.0f), v);
+        }
+    }
+    mesh.indices.clear();
+    mesh.indices.reserve(size_t(n - 1) * (n - 1) * 6);
+    for (unsigned int j = 0; j + 1 < n; j++) {
+        for (unsigned int i = 0; i + 1 < n; i++) {
+            unsigned int a = j * n + i, b = a + 1, c = a + n, d = c + 1;
+            mesh.indices.insert(mesh.indices.end(), { a, c, b, b, c, d });
+        }
+    }
+}
+
+const char* weightingName(NormalWeighting w)
+{
+    switch (w) {
+    case NormalWeighting::Area: return "area";
+    case NormalWeighting::Angle: return "angle";
+    default: return "uniform";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    ObjMesh mesh;
+    if (argc > 1) {
+        if (!loadObj(argv[1], mesh))
+            return 1;
+    } else {
+        buildGrid(1448, mesh);
+    }
+    int repeats = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+
+    size_t triangles = mesh.indices.size() / 3;
+    std::cout << mesh.positions.size() << " vertices, " << triangles << " triangles, "
+              << hardwareThreads() << " hardware threads" << std::endl;
+
+    PositionsSoA soa;
+    splitPositions(mesh.positions.data(), mesh.positions.size(), soa);
+    std::vector<glm::vec3> vertexNormals(mesh.positions.size());
+    std::vector<glm::vec3> faceNormals(triangles);
+
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int t = 1; t < hardwareThreads(); t *= 2)
+        threadCounts.push_back(t);
+    threadCounts.push_back(hardwareThreads());
+
+    std::cout << std::left << std::setw(10) << "weighting" << std::setw(9) << "threads"
+              << std::setw(12) << "best ms" << std::setw(10) << "Mtri/s" << "speedup" << std::endl;
+
+    for (NormalWeighting w : { NormalWeighting::Uniform, NormalWeighting::Area, NormalWeighting::Angle }) {
+        double baseline = 0.0;
+        for (unsigned int threads : threadCounts) {
+            double best = 1e30;
+            for (int r = 0; r < repeats; r++) {
+                auto start = std::chrono::steady_clock::now();
+                computeVertexNormals(soa, mesh.indices.data(), mesh.indices.size(), vertexNormals.data(),
+                                     w, faceNormals.data(), threads);
+                best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            }
+            if (threads == 1)
+                baseline = best;
+            std::cout << std::left << std::setw(10) << weightingName(w) << std::setw(9) << threads
+                      << std::setw(12) << std::fixed << std::setprecision(2) << best
+                      << std::setw(10) << triangles / (best * 1000.0)
+                      << baseline / best << "x" << std::endl;
+        }
+    }
+    return 0;
+}
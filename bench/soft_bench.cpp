@@ -0,0 +1,202 @@
+// CPU软件光栅化基准：不需要GPU，用SoftRasterizer沿与headless_bench相同的脚本路径渲染模型
+// 用法: soft_bench [--width W] [--height H] [--frames N] [--warmup N]
+//                  [--model path.obj] [--path orbit|sweep] [--flat] [--shininess S]
+//                  [--no-ambient] [--no-diffuse] [--no-specular]
+//                  [--threads 1,2,4,8] [--ppm out.ppm]
+// 对每个线程数分别测量帧时间、Mtri/s（提交的三角形）与Mpix/s（着色的像素），并输出相对第一个线程数的加速比
+// 不指定--threads时依次测量1、2、4……直到全部硬件线程
+#include "soft_rasterizer.h"
+#include "bench_common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    int width = 1280;
+    int height = 720;
+    int frames = 120;
+    int warmup = 5;
+    std::string model = "models/eight.uniform.obj";
+    CameraPath path = CameraPath::Orbit;
+    bool flat = false;
+    RenderSettings settings;
+    std::vector<size_t> threadCounts;
+    std::string ppm;
+};
+
+// 解析逗号分隔的数量列表
+void parseCounts(const char* text, std::vector<size_t>& counts)
+{
+    std::stringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ','))
+        counts.push_back(std::max(1L, std::atol(item.c_str())));
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--width" && hasValue)
+            options.width = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--height" && hasValue)
+            options.height = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--frames" && hasValue)
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--warmup" && hasValue)
+            options.warmup = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--model" && hasValue)
+            options.model = argv[++i];
+        else if (arg == "--path" && hasValue) {
+            std::string name = argv[++i];
+            if (name == "orbit")
+                options.path = CameraPath::Orbit;
+            else if (name == "sweep")
+                options.path = CameraPath::Sweep;
+            else {
+                std::cout << "Unknown path: " << name << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--flat")
+            options.flat = true;
+        else if (arg == "--shininess" && hasValue)
+            options.settings.shininess = std::max(1.0f, float(std::atof(argv[++i])));
+        else if (arg == "--no-ambient")
+            options.settings.enableAmbient = false;
+        else if (arg == "--no-diffuse")
+            options.settings.enableDiffuse = false;
+        else if (arg == "--no-specular")
+            options.settings.enableSpecular = false;
+        else if (arg == "--threads" && hasValue)
+            parseCounts(argv[++i], options.threadCounts);
+        else if (arg == "--ppm" && hasValue)
+            options.ppm = argv[++i];
+        else {
+            std::cout << "Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// 一个线程数下的测量结果
+struct RunResult {
+    unsigned int threads = 0;
+    std::vector<double> frameTimes;     // 已排序，毫秒
+    double total = 0.0;
+    size_t triangles = 0;               // 全部测量帧的合计
+    size_t rasterized = 0;
+    size_t pixels = 0;
+    double vertexMilliseconds = 0.0;
+    double setupMilliseconds = 0.0;
+    double rasterMilliseconds = 0.0;
+
+    double average() const { return total / frameTimes.size(); }
+    double megaTrianglesPerSecond() const { return triangles / (total * 1000.0); }
+    double megaPixelsPerSecond() const { return pixels / (total * 1000.0); }
+};
+
+RunResult runFrames(const Options& options, const MeshData& mesh, unsigned int threads, SoftFramebuffer& target)
+{
+    SoftRasterizer rasterizer(threads);
+    Camera camera;
+    Light light;
+    RunResult result;
+    result.threads = rasterizer.Threads();
+
+    for (int frame = -options.warmup; frame < options.frames; frame++) {
+        applyPath(options.path, std::max(frame, 0), options.frames, camera, light);
+
+        auto start = std::chrono::steady_clock::now();
+        rasterizer.Render(mesh, camera, light, options.settings, target);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (frame >= 0) {
+            const SoftRenderStats& stats = rasterizer.GetStats();
+            result.frameTimes.push_back(ms);
+            result.total += ms;
+            result.triangles += stats.triangles;
+            result.rasterized += stats.rasterized;
+            result.pixels += stats.pixelsShaded;
+            result.vertexMilliseconds += stats.vertexMilliseconds;
+            result.setupMilliseconds += stats.setupMilliseconds;
+            result.rasterMilliseconds += stats.rasterMilliseconds;
+        }
+    }
+    std::sort(result.frameTimes.begin(), result.frameTimes.end());
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+    if (options.threadCounts.empty()) {
+        for (unsigned int n = 1; n < hardwareThreads(); n *= 2)
+            options.threadCounts.push_back(n);
+        options.threadCounts.push_back(hardwareThreads());
+    }
+
+    // 只加载CPU端的网格，不需要GL
+    MeshData mesh(options.model.c_str(), true, MeshOptimize::VertexCache);
+    if (mesh.IndexCount() == 0)
+        return 1;
+    mesh.modelColor = glm::vec3(0.8f, 0.5f, 0.3f);
+    mesh.useVertexNormal = !options.flat;
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Software rasterizer: " << SoftRasterizer::InstructionSet() << ", " << SoftRasterizer::Lanes()
+              << " pixels per group, " << SoftRasterizer::TILE_SIZE << "px tiles, " << hardwareThreads()
+              << " hardware threads" << std::endl;
+    std::cout << options.width << "x" << options.height << ", " << options.frames << " frames (+" << options.warmup
+              << " warmup), path " << (options.path == CameraPath::Orbit ? "orbit" : "sweep")
+              << ", " << (options.flat ? "flat" : "smooth") << " normals, " << mesh.IndexCount() / 3
+              << " triangles, lighting" << (options.settings.enableAmbient ? " ambient" : "")
+              << (options.settings.enableDiffuse ? " diffuse" : "") << (options.settings.enableSpecular ? " specular" : "")
+              << std::endl;
+
+    SoftFramebuffer target;
+    target.Resize(options.width, options.height);
+
+    std::cout << std::left << std::setw(9) << "threads" << std::setw(10) << "avg ms" << std::setw(10) << "p99 ms"
+              << std::setw(10) << "Mtri/s" << std::setw(10) << "Mpix/s" << std::setw(10) << "vertex"
+              << std::setw(10) << "setup" << std::setw(10) << "raster" << "speedup" << std::endl;
+
+    std::vector<RunResult> results;
+    for (size_t threads : options.threadCounts) {
+        results.push_back(runFrames(options, mesh, static_cast<unsigned int>(threads), target));
+        const RunResult& result = results.back();
+        std::cout << std::left << std::setw(9) << result.threads << std::setw(10) << result.average()
+                  << std::setw(10) << percentile(result.frameTimes, 0.99)
+                  << std::setw(10) << result.megaTrianglesPerSecond() << std::setw(10) << result.megaPixelsPerSecond()
+                  << std::setw(10) << result.vertexMilliseconds / options.frames
+                  << std::setw(10) << result.setupMilliseconds / options.frames
+                  << std::setw(10) << result.rasterMilliseconds / options.frames
+                  << results.front().average() / result.average() << "x" << std::endl;
+    }
+
+    const RunResult& last = results.back();
+    std::cout << "Per frame: " << last.rasterized / options.frames << " triangles rasterized (after clipping), "
+              << last.pixels / options.frames << " pixels shaded" << std::endl;
+
+    if (!options.ppm.empty()) {
+        if (target.WritePPM(options.ppm))
+            std::cout << "Wrote last frame to " << options.ppm << std::endl;
+        else
+            std::cout << "Failed to open file: " << options.ppm << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,10 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstddef>
+
+// 调用线程上全局operator new的调用次数（由alloc_counter.cpp替换全局分配函数统计）
+// 只统计本线程，用于验证空闲帧的HUD绘制是否产生堆分配；需在运行该代码的线程上前后各读一次
+size_t allocationCount();
+
+#endif
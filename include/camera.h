@@ -1,7 +1,6 @@
 #ifndef CAMERA_H
 #define CAMERA_H
 
-#include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -49,7 +48,7 @@ public:
     }
     
     // 获取视图矩阵
-    glm::mat4 GetViewMatrix()
+    glm::mat4 GetViewMatrix() const
     {
         return glm::lookAt(Position, Target, Up);
     }
@@ -108,6 +107,15 @@ public:
         updateCameraVectors();
     }
 
+    // 直接设置轨道角度和距离，用于脚本化的相机路径
+    void SetOrbit(float yaw, float pitch, float distance)
+    {
+        Yaw = yaw;
+        Pitch = pitch;
+        Distance = distance;
+        updateCameraVectors();
+    }
+
 private:
     // 根据更新的欧拉角和距离更新相机位置与向量
     void updateCameraVectors()
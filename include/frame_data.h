@@ -0,0 +1,21 @@
+#ifndef FRAME_DATA_H
+#define FRAME_DATA_H
+
+#include <glm/glm.hpp>
+
+// 与着色器中 layout(std140) uniform FrameData 一一对应，全部使用vec4/mat4避免std140填充问题
+struct FrameData {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 viewPos;
+
+    // 光源（对应着色器中的 Light light）
+    glm::vec4 lightPosition;
+    glm::vec4 lightAmbient;
+    glm::vec4 lightDiffuse;
+    glm::vec4 lightSpecular;
+};
+
+static_assert(sizeof(FrameData) == 2 * 64 + 5 * 16, "FrameData must match the std140 layout");
+
+#endif
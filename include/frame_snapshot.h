@@ -0,0 +1,30 @@
+#ifndef FRAME_SNAPSHOT_H
+#define FRAME_SNAPSHOT_H
+
+#include <glm/glm.hpp>
+
+#include "camera.h"
+#include "light.h"
+#include "renderer.h"
+#include "vertex_format.h"
+
+// 输入和场景更新之后发布的一帧状态，发布后不再修改
+// 绘制只读取快照，不读取输入线程的全局状态，两者可以在不同线程上
+struct FrameSnapshot {
+    unsigned long long sequence = 0;        // 发布序号，从1开始
+    Camera camera;
+    Light light;
+    RenderSettings settings;                // 光泽度和光照开关
+    glm::vec3 modelColor = glm::vec3(1.0f);
+    bool vertexNormals = true;
+    VertexFormat vertexFormat = VertexFormat::Compact;
+    int pointLightStep = 0;
+    bool onDemand = true;
+    bool showProfiler = false;
+    unsigned int profileExports = 0;        // 请求导出计时数据的累计次数
+    int framebufferWidth = 1;
+    int framebufferHeight = 1;
+    double inputTime = -1.0;                // 最早一个尚未呈现的输入事件的时间（glfwGetTime），没有时为负
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "frame_data.h"
+
+// 每帧共享的uniform块名称与绑定点，model与sphere着色器共用
+const char FRAME_DATA_BLOCK[] = "FrameData";
+const unsigned int FRAME_DATA_BINDING = 0;
+
+// 每帧只上传一次的uniform缓冲
+class FrameUniforms
+{
+public:
+    // 缓冲上传次数，与Shader::uniformCalls一起统计
+    unsigned int uploads;
+
+    FrameUniforms() : uploads(0)
+    {
+        glGenBuffers(1, &UBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, UBO);
+    }
+
+    ~FrameUniforms()
+    {
+        glDeleteBuffers(1, &UBO);
+    }
+
+    void update(const FrameData &data)
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        uploads++;
+    }
+
+private:
+    unsigned int UBO;
+};
+
+#endif
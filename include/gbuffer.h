@@ -0,0 +1,113 @@
+#ifndef GBUFFER_H
+#define GBUFFER_H
+
+#include <GL/glew.h>
+
+#include <iostream>
+
+#include "shader.h"
+
+// 延迟着色的G-buffer，尺寸随帧缓冲变化时重建
+//   gNormal  RGBA16F           xyz为世界空间法线，w为shininess
+//   gAlbedo  RGBA8             rgb为物体颜色
+//   gDepth   DEPTH_COMPONENT32F 光照阶段由深度重建世界坐标，并写回目标帧缓冲
+class GBuffer
+{
+public:
+    // 光照阶段采样G-buffer使用的纹理单元（1~3留给点光源池）
+    static const int NORMAL_UNIT = 4;
+    static const int ALBEDO_UNIT = 5;
+    static const int DEPTH_UNIT = 6;
+
+    GBuffer()
+    {
+        glGenFramebuffers(1, &fbo);
+        glGenTextures(3, textures);
+        // 全屏三角形的顶点由gl_VertexID生成，核心模式下仍需绑定一个VAO
+        glGenVertexArrays(1, &screenVAO);
+    }
+
+    ~GBuffer()
+    {
+        glDeleteVertexArrays(1, &screenVAO);
+        glDeleteTextures(3, textures);
+        glDeleteFramebuffers(1, &fbo);
+    }
+
+    GBuffer(const GBuffer&) = delete;
+    GBuffer& operator=(const GBuffer&) = delete;
+
+    // 光照着色器中G-buffer采样器固定到各自的纹理单元，程序链接后调用一次
+    static void bindSamplers(const Shader& shader)
+    {
+        shader.setInt("gNormal", NORMAL_UNIT);
+        shader.setInt("gAlbedo", ALBEDO_UNIT);
+        shader.setInt("gDepth", DEPTH_UNIT);
+    }
+
+    // 尺寸变化时重新分配附件，尺寸不变时什么都不做
+    bool resize(int newWidth, int newHeight)
+    {
+        if (newWidth == width && newHeight == height)
+            return complete;
+        width = newWidth;
+        height = newHeight;
+
+        allocate(textures[0], GL_RGBA16F, GL_RGBA, GL_FLOAT);
+        allocate(textures[1], GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+        allocate(textures[2], GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textures[0], 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, textures[1], 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, textures[2], 0);
+        const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glDrawBuffers(2, drawBuffers);
+
+        complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        if (!complete)
+            std::cout << "ERROR::GBUFFER::FRAMEBUFFER_INCOMPLETE" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return complete;
+    }
+
+    GLuint framebuffer() const { return fbo; }
+
+    // 绑定G-buffer纹理供光照阶段采样
+    void bindTextures() const
+    {
+        for (int i = 0; i < 3; i++) {
+            glActiveTexture(GL_TEXTURE0 + NORMAL_UNIT + i);
+            glBindTexture(GL_TEXTURE_2D, textures[i]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // 绘制覆盖整个视口的三角形
+    void drawFullscreenTriangle() const
+    {
+        glBindVertexArray(screenVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+    }
+
+private:
+    GLuint fbo = 0;
+    GLuint textures[3];
+    GLuint screenVAO = 0;
+    int width = 0;
+    int height = 0;
+    bool complete = false;
+
+    void allocate(GLuint texture, GLint internalFormat, GLenum format, GLenum type)
+    {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
+        // 只用texelFetch按像素读取，不需要过滤和mipmap
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+};
+
+#endif
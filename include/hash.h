@@ -0,0 +1,79 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace hash_detail {
+
+const uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+const uint64_t PRIME3 = 0x165667B19E3779F9ull;
+const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+
+inline uint64_t rotl(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t mixRound(uint64_t acc, uint64_t input)
+{
+    acc += input * PRIME2;
+    acc = rotl(acc, 31);
+    return acc * PRIME1;
+}
+
+inline uint64_t readWord(const unsigned char* p)
+{
+    uint64_t w;
+    std::memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+} // namespace hash_detail
+
+// 64位非加密哈希，用于源文件指纹、缓存校验和缓存键
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0)
+{
+    using namespace hash_detail;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const uint64_t length = size;
+
+    // 四路独立累加，打断乘法依赖链
+    uint64_t v0 = seed + PRIME1 + PRIME2;
+    uint64_t v1 = seed + PRIME2;
+    uint64_t v2 = seed;
+    uint64_t v3 = seed - PRIME1;
+    while (size >= 32) {
+        v0 = mixRound(v0, readWord(p));
+        v1 = mixRound(v1, readWord(p + 8));
+        v2 = mixRound(v2, readWord(p + 16));
+        v3 = mixRound(v3, readWord(p + 24));
+        p += 32;
+        size -= 32;
+    }
+
+    uint64_t h = rotl(v0, 1) + rotl(v1, 7) + rotl(v2, 12) + rotl(v3, 18) + length;
+    while (size >= 8) {
+        h ^= mixRound(0, readWord(p));
+        h = rotl(h, 27) * PRIME1 + PRIME4;
+        p += 8;
+        size -= 8;
+    }
+    while (size > 0) {
+        h ^= (*p) * PRIME3;
+        h = rotl(h, 11) * PRIME1;
+        p++;
+        size--;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef INPUT_QUEUE_H
+#define INPUT_QUEUE_H
+
+#include <cstddef>
+#include <vector>
+
+// 一个带时间戳的输入事件，由GLFW回调写入，时间为glfwGetTime()
+struct InputEvent {
+    enum Type {
+        Key,
+        MouseButton,
+        CursorPos,
+        Scroll
+    };
+
+    Type type;
+    double time;
+    int code;           // 键码或鼠标按键
+    int action;         // GLFW_PRESS / GLFW_RELEASE / GLFW_REPEAT
+    double x, y;        // 光标位置或滚动量
+};
+
+// 输入事件队列：回调只追加事件，每帧开始时一次取出并按时间顺序处理
+// 同时按事件时间戳记录按键的按下区间，按住类动作按实际按住的时长积分，与帧率无关
+class InputQueue {
+public:
+    static const int KEY_COUNT = 512;
+
+    InputQueue();
+
+    // GLFW回调中调用
+    void PushKey(int key, int action, double time);
+    void PushMouseButton(int button, int action, double time);
+    void PushCursor(double x, double y, double time);
+    void PushScroll(double x, double y, double time);
+
+    // 取出截至now的全部事件（按到达顺序），同时计算本帧[上一帧的now, now]内每个键被按住的时长
+    const std::vector<InputEvent>& BeginFrame(double now);
+
+    // 本帧内按住的秒数，按键在区间中途按下或松开时只计算按住的部分
+    double HeldSeconds(int key) const;
+
+    // 最近一次BeginFrame所处理区间的起点（即上一次BeginFrame的now）
+    double FrameStart() const { return lastFrameStart; }
+
+    // 当前（本帧末尾）是否按住
+    bool IsDown(int key) const;
+
+    // 累计的事件数（自动重复的按键事件不算）
+    size_t TotalEvents() const { return totalEvents; }
+
+private:
+    std::vector<InputEvent> incoming;
+    std::vector<InputEvent> frameEvents;
+
+    bool keyDown[KEY_COUNT];
+    double downSince[KEY_COUNT];
+    double held[KEY_COUNT];
+    double frameStart;
+    double lastFrameStart;
+    bool started;
+    size_t totalEvents;
+};
+
+#endif
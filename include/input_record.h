@@ -0,0 +1,67 @@
+#ifndef INPUT_RECORD_H
+#define INPUT_RECORD_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "input_queue.h"
+
+// 录制文件头：回放前恢复的初始状态
+struct InputRecordHeader {
+    uint32_t colorSeed = 0;         // 模型随机颜色的种子
+    float modelColor[3] = {};       // 模型的初始颜色
+    int32_t width = 0;              // 录制时的帧缓冲大小
+    int32_t height = 0;
+};
+
+// 把每帧取出的输入事件和该帧的deltaTime写入紧凑的二进制文件
+// 文件格式：文件头，之后每帧 { deltaTime, 帧区间长度, 事件数, 事件... }，事件时间保存为相对帧起点的偏移
+class InputRecorder {
+public:
+    bool Open(const std::string& path, const InputRecordHeader& header);
+
+    // frameStart/frameEnd为InputQueue::BeginFrame所对应的区间
+    void WriteFrame(float deltaTime, double frameStart, double frameEnd, const std::vector<InputEvent>& events);
+
+    size_t Frames() const { return frames; }
+    size_t Events() const { return events; }
+
+private:
+    std::ofstream file;
+    size_t frames = 0;
+    size_t events = 0;
+};
+
+// 读取录制文件，以固定时间步长把事件重新放进InputQueue，走与实时输入相同的处理路径
+class InputReplay {
+public:
+    bool Open(const std::string& path);
+
+    const InputRecordHeader& Header() const { return header; }
+
+    // 把下一帧的事件按比例映射到[start, start + step]放入队列，没有更多帧时返回false
+    // recordedDelta为录制时这一帧的deltaTime
+    bool NextFrame(InputQueue& queue, double start, double step, float& recordedDelta);
+
+    size_t Frames() const { return frames.size(); }
+
+    // 录制时各帧的deltaTime（毫秒），用于与回放的帧时间对比
+    std::vector<float> RecordedFrameMilliseconds() const;
+
+private:
+    struct Frame {
+        float deltaTime;
+        float span;
+        size_t firstEvent;
+        size_t eventCount;
+    };
+
+    InputRecordHeader header;
+    std::vector<Frame> frames;
+    std::vector<InputEvent> events;     // 时间为相对帧起点的偏移
+    size_t nextFrame = 0;
+};
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef INSTANCING_H
+#define INSTANCING_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+// 每实例数据，与model.vs中location 2起的实例属性一一对应
+struct InstanceData {
+    glm::mat4 model;
+    glm::vec4 normalMatrix[3];  // 法线矩阵（模型矩阵左上3x3的逆转置）的三列，w未用
+    glm::vec4 color;            // rgb为物体颜色，w非0时该实例使用面法线
+};
+
+static_assert(sizeof(InstanceData) == 128, "InstanceData must match the instance attribute layout");
+
+// 由模型矩阵生成实例数据，法线矩阵在CPU上每实例算一次，顶点着色器中不再求逆
+inline InstanceData makeInstance(const glm::mat4& model, const glm::vec3& color, bool flatShading)
+{
+    InstanceData instance;
+    instance.model = model;
+    glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+    for (int i = 0; i < 3; i++)
+        instance.normalMatrix[i] = glm::vec4(normalMatrix[i], 0.0f);
+    instance.color = glm::vec4(color, flatShading ? 1.0f : 0.0f);
+    return instance;
+}
+
+// 实例属性缓冲
+class InstanceBuffer
+{
+public:
+    // 实例属性占用的第一个location：mat4占2~5，法线矩阵占6~8，颜色占9
+    static const GLuint FIRST_LOCATION = 2;
+
+    InstanceBuffer() : count(0), capacity(0)
+    {
+        glGenBuffers(1, &VBO);
+    }
+
+    ~InstanceBuffer()
+    {
+        glDeleteBuffers(1, &VBO);
+    }
+
+    InstanceBuffer(const InstanceBuffer&) = delete;
+    InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+    // 上传实例数据，容量不够时重新分配，否则原地覆盖
+    void upload(const InstanceData* data, size_t instanceCount)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        if (instanceCount > capacity) {
+            glBufferData(GL_ARRAY_BUFFER, instanceCount * sizeof(InstanceData), data, GL_DYNAMIC_DRAW);
+            capacity = instanceCount;
+        } else if (instanceCount > 0) {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, instanceCount * sizeof(InstanceData), data);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        count = instanceCount;
+    }
+
+    // 在当前绑定的VAO上配置实例属性，每个实例前进一次
+    void bindAttributes() const
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        const GLsizei stride = sizeof(InstanceData);
+        for (GLuint i = 0; i < 8; i++) {
+            GLuint location = FIRST_LOCATION + i;
+            glEnableVertexAttribArray(location);
+            glVertexAttribPointer(location, i < 4 ? 4 : (i < 7 ? 3 : 4), GL_FLOAT, GL_FALSE, stride, (void*)(i * sizeof(glm::vec4)));
+            glVertexAttribDivisor(location, 1);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    GLuint buffer() const { return VBO; }
+    size_t size() const { return count; }
+
+private:
+    GLuint VBO;
+    size_t count;
+    size_t capacity;
+};
+
+#endif
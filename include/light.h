@@ -4,7 +4,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
-#include "shader.h"
+#include "frame_data.h"
 
 class Light 
 {
@@ -26,12 +26,13 @@ public:
     {
     }
     
-    void setUniforms(Shader &shader) 
+    // 写入每帧uniform块，随FrameUniforms一次性上传
+    void setUniforms(FrameData &frame) const
     {
-        shader.setVec3("light.position", position);
-        shader.setVec3("light.ambient", ambient * intensity);
-        shader.setVec3("light.diffuse", diffuse * intensity);
-        shader.setVec3("light.specular", specular * intensity);
+        frame.lightPosition = glm::vec4(position, 1.0f);
+        frame.lightAmbient = glm::vec4(ambient * intensity, 0.0f);
+        frame.lightDiffuse = glm::vec4(diffuse * intensity, 0.0f);
+        frame.lightSpecular = glm::vec4(specular * intensity, 0.0f);
     }
     
     void adjustIntensity(float amount) 
@@ -0,0 +1,66 @@
+#ifndef LIGHT_CLUSTERS_H
+#define LIGHT_CLUSTERS_H
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 点光源的着色方式
+enum class LightCulling {
+    Clustered,      // 片段只遍历所在簇的光源
+    BruteForce      // 片段遍历全部光源，用于对比
+};
+
+// 点光源，世界空间；与着色器中光源缓冲的两个texel一一对应
+struct PointLight {
+    glm::vec4 positionRadius;   // xyz为位置，w为影响半径（半径外贡献为0）
+    glm::vec4 color;            // rgb为颜色乘以强度，w未用
+};
+
+static_assert(sizeof(PointLight) == 32, "PointLight must be two RGBA32F texels");
+
+// 分簇参数：屏幕按TILE_SIZE像素分块，视空间深度按指数分为DEPTH_SLICES层
+struct ClusterGrid {
+    static const int TILE_SIZE = 64;
+    static const int DEPTH_SLICES = 16;
+
+    int tilesX = 0;
+    int tilesY = 0;
+    float nearPlane = 0.1f;
+    float farPlane = 100.0f;
+
+    // slice = floor(log(depth) * sliceScale + sliceBias)
+    float sliceScale = 0.0f;
+    float sliceBias = 0.0f;
+
+    size_t clusterCount() const { return size_t(tilesX) * tilesY * DEPTH_SLICES; }
+};
+
+// 分簇结果：每个簇在lightIndices中的起始位置和数量
+struct LightClusterData {
+    ClusterGrid grid;
+    std::vector<uint32_t> offsetCount;     // 每簇两个值：offset, count
+    std::vector<uint32_t> lightIndices;
+
+    // 内部使用：每个可见光源的簇范围（光源下标, x0, x1, y0, y1, z0, z1）
+    std::vector<int32_t> lightRanges;
+
+    // 分簇统计
+    size_t visibleLights = 0;
+    double cpuMilliseconds = 0.0;
+};
+
+// 在CPU上把光源分配到与其包围球相交的簇中（计数 + 前缀和 + 填充，两遍完成）
+// 包围球的屏幕范围由视空间AABB的8个角点投影得到，是保守估计
+void buildLightClusters(const PointLight* lights, size_t count,
+                        const glm::mat4& view, const glm::mat4& projection,
+                        int width, int height, float nearPlane, float farPlane,
+                        LightClusterData& clusters);
+
+// 以固定种子在球体范围内生成count个点光源，基准测试和交互程序使用同一组光源
+void generatePointLights(size_t count, const glm::vec3& center, float spread, unsigned int seed,
+                         std::vector<PointLight>& lights);
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef LIGHT_POOL_H
+#define LIGHT_POOL_H
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "shader.h"
+#include "light_clusters.h"
+
+// 点光源池及分簇结果在GPU上的存储，均为纹理缓冲（TBO），光源数量不受uniform块大小限制
+//   pointLights    RGBA32F  每个光源两个texel
+//   clusterLights  RG32UI   每簇 offset, count
+//   clusterIndices R32UI    按簇排列的光源下标
+class LightPool
+{
+public:
+    // 三个纹理缓冲使用的纹理单元（单元0留给普通纹理）
+    static const int LIGHTS_UNIT = 1;
+    static const int CLUSTERS_UNIT = 2;
+    static const int INDICES_UNIT = 3;
+
+    LightPool()
+    {
+        glGenBuffers(3, buffers);
+        glGenTextures(3, textures);
+        const GLenum formats[3] = { GL_RGBA32F, GL_RG32UI, GL_R32UI };
+        for (int i = 0; i < 3; i++) {
+            // 先放一个空元素，保证纹理缓冲始终有有效存储
+            glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+            glBufferData(GL_TEXTURE_BUFFER, 16, NULL, GL_STREAM_DRAW);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+            glTexBuffer(GL_TEXTURE_BUFFER, formats[i], buffers[i]);
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    ~LightPool()
+    {
+        glDeleteTextures(3, textures);
+        glDeleteBuffers(3, buffers);
+    }
+
+    LightPool(const LightPool&) = delete;
+    LightPool& operator=(const LightPool&) = delete;
+
+    // 着色器中三个纹理缓冲采样器固定到各自的纹理单元，程序链接后调用一次
+    static void bindSamplers(const Shader& shader)
+    {
+        shader.setInt("pointLights", LIGHTS_UNIT);
+        shader.setInt("clusterLights", CLUSTERS_UNIT);
+        shader.setInt("clusterIndices", INDICES_UNIT);
+    }
+
+    // 每帧上传一次光源；clusters为空时只上传光源（暴力遍历不需要分簇结果）
+    void upload(const PointLight* lights, size_t count, const LightClusterData* clusters)
+    {
+        uploadBuffer(0, lights, count * sizeof(PointLight));
+        if (clusters) {
+            uploadBuffer(1, clusters->offsetCount.data(), clusters->offsetCount.size() * sizeof(uint32_t));
+            uploadBuffer(2, clusters->lightIndices.data(), clusters->lightIndices.size() * sizeof(uint32_t));
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    // 绑定纹理缓冲并设置着色方式；count为0时着色器跳过点光源
+    void bind(const Shader& shader, LightCulling culling, size_t count, const ClusterGrid& grid) const
+    {
+        for (int i = 0; i < 3; i++) {
+            glActiveTexture(GL_TEXTURE0 + LIGHTS_UNIT + i);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+
+        int mode = count == 0 ? 0 : (culling == LightCulling::Clustered ? 1 : 2);
+        shader.setInt("pointLightMode", mode);
+        shader.setInt("pointLightCount", static_cast<int>(count));
+        if (mode == 1) {
+            shader.setInt("clusterTilesX", grid.tilesX);
+            shader.setInt("clusterTilesY", grid.tilesY);
+            shader.setVec3("clusterParams", 1.0f / ClusterGrid::TILE_SIZE, grid.sliceScale, grid.sliceBias);
+        }
+    }
+
+private:
+    GLuint buffers[3];
+    GLuint textures[3];
+
+    void uploadBuffer(int index, const void* data, size_t bytes)
+    {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[index]);
+        if (bytes > 0)
+            glBufferData(GL_TEXTURE_BUFFER, bytes, data, GL_STREAM_DRAW);
+    }
+};
+
+#endif
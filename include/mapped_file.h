@@ -0,0 +1,97 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstddef>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// 只读内存映射文件，POSIX平台使用mmap，其他平台退化为一次性读入内存
+class MappedFile
+{
+public:
+    MappedFile() {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path)
+    {
+        close();
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+
+        fileSize = static_cast<size_t>(st.st_size);
+        if (fileSize > 0) {
+            void* ptr = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr == MAP_FAILED) {
+                ::close(fd);
+                fileSize = 0;
+                return false;
+            }
+            // 解析器顺序扫描整个文件，提示内核预读
+            madvise(ptr, fileSize, MADV_SEQUENTIAL);
+            mapped = static_cast<const char*>(ptr);
+        }
+        ::close(fd);
+        opened = true;
+        return true;
+#else
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+            return false;
+
+        fileSize = static_cast<size_t>(file.tellg());
+        buffer.resize(fileSize);
+        file.seekg(0);
+        file.read(buffer.data(), fileSize);
+        mapped = buffer.data();
+        opened = true;
+        return true;
+#endif
+    }
+
+    void close()
+    {
+#ifndef _WIN32
+        if (mapped && fileSize > 0)
+            munmap(const_cast<char*>(mapped), fileSize);
+#else
+        buffer.clear();
+        buffer.shrink_to_fit();
+#endif
+        mapped = nullptr;
+        fileSize = 0;
+        opened = false;
+    }
+
+    bool isOpen() const { return opened; }
+    const char* data() const { return mapped; }
+    size_t size() const { return fileSize; }
+
+private:
+    const char* mapped = nullptr;
+    size_t fileSize = 0;
+    bool opened = false;
+#ifdef _WIN32
+    std::vector<char> buffer;
+#endif
+};
+
+#endif
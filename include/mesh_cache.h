@@ -0,0 +1,148 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "mapped_file.h"
+#include "mesh_simplify.h"
+#include "mesh_optimize.h"
+#include "meshlets.h"
+#include "vertex_packing.h"
+
+// .meshbin 二进制网格缓存
+// 布局：MeshCacheHeader + 按16字节对齐的数据段
+//   顶点段：交错的 位置(3 float) + 顶点法线(3 float)，即Float格式的VBO内容
+//   紧凑顶点段：每个顶点一个PackedVertex（相对包围盒量化），即Compact格式的VBO内容
+//   索引段：unsigned int三角形索引，所有LOD级别依次拼接，第0级为原网格
+//   16位索引段：与索引段相同的uint16_t索引，即Compact格式的EBO内容；顶点数超过65536时不存在
+//   LOD段：每级一个MeshLod（索引段中的范围与误差）
+//   簇段：所有级别的Meshlet依次拼接
+//   簇包围段：MeshletSet的centerX、centerY、centerZ、radius、axisX、axisY、axisZ、cutoff，每个数组meshletCount个float
+//   LOD簇段：lodCount + 1个uint32_t，第i级的簇为[lodMeshlets[i], lodMeshlets[i + 1])
+// flags记录网格的性质（MESH_CACHE_CLOSED）
+// 两种格式的VBO/EBO内容都可以从映射的文件直接交给glBufferData，加载时不再做逐三角形的计算
+const char MESH_CACHE_MAGIC[8] = { 'M', 'E', 'S', 'H', 'B', 'I', 'N', '\0' };
+const uint32_t MESH_CACHE_VERSION = 8;
+
+// MeshCacheHeader::flags
+const uint32_t MESH_CACHE_CLOSED = 1;      // 第0级没有边界边（isClosedMesh）
+
+struct MeshCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+
+    // 源文件标识，任一不匹配即视为失效
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    uint64_t sourceHash;
+    uint32_t optimization;      // 生成缓存时的MeshOptimize
+    uint32_t flags;
+
+    uint32_t vertexCount;
+    uint32_t indexCount;        // 第0级的索引数
+    uint32_t lodIndexCount;     // 索引段中全部级别的索引数
+    uint32_t lodCount;
+    float boundsMin[3];
+    float boundsMax[3];
+    float maxPositionError;     // 紧凑顶点的量化误差（VertexPackingError）
+    float maxNormalDegrees;
+    uint32_t shortIndexCount;   // 16位索引段的索引数，为0或lodIndexCount
+    uint32_t meshletCount;
+    float cacheStats[4];        // 第0级优化前的ACMR、ATVR与优化后的ACMR、ATVR
+
+    uint64_t vertexOffset;
+    uint64_t packedVertexOffset;
+    uint64_t indexOffset;
+    uint64_t shortIndexOffset;
+    uint64_t lodOffset;
+    uint64_t meshletOffset;
+    uint64_t meshletBoundsOffset;
+    uint64_t lodMeshletOffset;
+
+    // 头部之后全部数据的大小与校验和
+    uint64_t payloadSize;
+    uint64_t payloadChecksum;
+};
+
+// 源OBJ文件的标识：大小、修改时间、内容哈希，以及加载时的网格优化方式
+struct MeshSourceKey {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t hash = 0;
+    MeshOptimize optimization = MeshOptimize::None;
+};
+
+// 计算源文件标识（optimization由调用方设置），失败返回false
+bool computeMeshSourceKey(const std::string& path, MeshSourceKey& key);
+
+// 与OBJ同目录的缓存路径，文件名带上网格优化方式，不同优化方式的缓存互不覆盖
+// 例如 models/eight.uniform.obj -> models/eight.uniform.cache.meshbin
+std::string meshCachePath(const std::string& objPath, MeshOptimize optimization);
+
+// 写入缓存的各段数据
+struct MeshCacheData {
+    const float* vertexData = nullptr;              // 交错的 位置+法线
+    const PackedVertex* packedVertices = nullptr;   // 按boundsMin/boundsMax量化的紧凑顶点
+    size_t vertexCount = 0;
+    VertexPackingError packingError;
+    const unsigned int* indices = nullptr;          // 所有LOD级别拼接的索引，lods[0]为原网格
+    const uint16_t* shortIndices = nullptr;         // 与indices相同的16位索引，没有时为nullptr
+    size_t indexCount = 0;
+    const MeshLod* lods = nullptr;
+    size_t lodCount = 0;
+    const MeshletSet* meshlets = nullptr;           // 所有级别的簇
+    const size_t* lodMeshlets = nullptr;            // lodCount + 1项，每级在meshlets中的起始位置
+    VertexCacheStats cacheStatsBefore;
+    VertexCacheStats cacheStatsAfter;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    bool closed = false;
+};
+
+// 写入缓存（先写临时文件再重命名）
+bool writeMeshCache(const std::string& path, const MeshSourceKey& key, const MeshCacheData& data);
+
+// 以内存映射方式打开的缓存，数据指针在对象存活期间有效
+class MeshCache
+{
+public:
+    // 打开并校验缓存：魔数、版本、源文件标识和数据校验和
+    bool open(const std::string& path, const MeshSourceKey& key);
+    void close() { file.close(); header = nullptr; }
+
+    size_t vertexCount() const { return header->vertexCount; }
+    size_t indexCount() const { return header->indexCount; }
+    size_t lodIndexCount() const { return header->lodIndexCount; }
+    size_t lodCount() const { return header->lodCount; }
+    glm::vec3 boundsMin() const { return glm::vec3(header->boundsMin[0], header->boundsMin[1], header->boundsMin[2]); }
+    glm::vec3 boundsMax() const { return glm::vec3(header->boundsMax[0], header->boundsMax[1], header->boundsMax[2]); }
+    VertexPackingError packingError() const { return { header->maxPositionError, header->maxNormalDegrees }; }
+    VertexCacheStats cacheStatsBefore() const { return { header->cacheStats[0], header->cacheStats[1] }; }
+    VertexCacheStats cacheStatsAfter() const { return { header->cacheStats[2], header->cacheStats[3] }; }
+    bool closed() const { return (header->flags & MESH_CACHE_CLOSED) != 0; }
+
+    const float* vertexData() const { return reinterpret_cast<const float*>(file.data() + header->vertexOffset); }
+    const PackedVertex* packedVertices() const { return reinterpret_cast<const PackedVertex*>(file.data() + header->packedVertexOffset); }
+    const unsigned int* indices() const { return reinterpret_cast<const unsigned int*>(file.data() + header->indexOffset); }
+    // 没有16位索引段时为nullptr
+    const uint16_t* shortIndices() const
+    {
+        return header->shortIndexCount ? reinterpret_cast<const uint16_t*>(file.data() + header->shortIndexOffset) : nullptr;
+    }
+    const MeshLod* lods() const { return reinterpret_cast<const MeshLod*>(file.data() + header->lodOffset); }
+
+    // 把簇及其包围数据整块拷贝到set，lodMeshlets为每级的起始位置（末尾多一项为总数）
+    void copyMeshlets(MeshletSet& set, std::vector<size_t>& lodMeshlets) const;
+
+private:
+    MappedFile file;
+    const MeshCacheHeader* header = nullptr;
+};
+
+#endif
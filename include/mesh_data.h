@@ -0,0 +1,117 @@
+#ifndef MESH_DATA_H
+#define MESH_DATA_H
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "obj_loader.h"
+#include "mesh_cache.h"
+#include "mesh_simplify.h"
+#include "mesh_optimize.h"
+#include "meshlets.h"
+#include "vertex_packing.h"
+
+struct Vertex {
+    glm::vec3 Position;
+    glm::vec3 Normal;
+};
+
+// Vertex的内存布局和Float格式VBO的交错数据一致，缓存中的顶点段可以直接当作Vertex数组读取
+static_assert(sizeof(Vertex) == 6 * sizeof(float), "Vertex must be tightly packed");
+
+// 模型在CPU端的网格数据，不依赖GL：顶点、各级LOD的索引与簇、颜色和法线模式
+// Model在此之上管理GPU缓冲；SoftRasterizer和不需要GL的工具直接使用
+class MeshData
+{
+public:
+    // LOD链：所有级别的索引依次存放在同一个索引数组中，共用顶点；lods[0]为原网格
+    std::vector<MeshLod> lods;
+    // 每级LOD切分出的簇，lodMeshlets[level]为该级在meshlets中的起始位置（末尾多一项为总数）
+    MeshletSet meshlets;
+    std::vector<size_t> lodMeshlets;
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+    glm::vec3 modelColor;
+
+    // 第0级索引的顶点缓存统计：优化前（文件顺序）与优化后，与网格一起保存在缓存中
+    VertexCacheStats cacheStatsBefore;
+    VertexCacheStats cacheStatsAfter;
+
+    bool useVertexNormal;
+
+    // 第0级是封闭网格：看不到背面，默认开启簇的背面剔除（RenderSettings::backfaceCulling）
+    bool closed;
+
+    // 加载时生成的LOD级别数上限（含原网格）
+    static const size_t MAX_LOD_LEVELS = 6;
+
+    // useCache为true时优先读取同目录的.meshbin缓存，缺失或失效时解析OBJ并重新写入
+    // optimization为解析OBJ后对三角形和顶点顺序的优化，不同的优化方式各自使用一个缓存文件（meshCachePath）
+    // 不调用GL，可以在工作线程中构造
+    MeshData(const char* path, bool useCache = true, MeshOptimize optimization = MeshOptimize::VertexCache);
+
+    // 顶点和索引：从缓存加载时直接指向映射的文件，解析OBJ时指向本对象的数组
+    size_t VertexCount() const { return vertexCount; }
+    const Vertex* Vertices() const { return vertexData; }
+
+    // 所有LOD级别依次拼接的索引，第0级（原网格）在开头，共IndexCount()个
+    size_t IndexCount() const { return lods.empty() ? 0 : lods[0].indexCount; }
+    size_t LodIndexCount() const { return lodIndexCount; }
+    const unsigned int* Indices() const { return indexData; }
+
+    // 紧凑布局：按包围盒量化的顶点及其误差，顶点数超过65536时ShortIndices()为nullptr
+    const PackedVertex* PackedVertices() const { return packedData; }
+    const uint16_t* ShortIndices() const { return shortIndexData; }
+    const VertexPackingError& CompactError() const { return compactError; }
+
+    void randomColor();
+
+    // 两种法线都无需重建顶点数据：顶点法线常驻顶点缓冲，面法线由三角形求得
+    void toggleNormalMode()
+    {
+        useVertexNormal = !useVertexNormal;
+    }
+
+private:
+    MeshOptimize optimization;
+
+    // 从缓存加载时保持文件映射，上传和CPU端读取都直接使用其中的数据
+    MeshCache cache;
+
+    // 解析OBJ时生成的数据，从缓存加载时为空
+    std::vector<Vertex> vertices;
+    std::vector<PackedVertex> packedVertices;
+    std::vector<unsigned int> lodIndices;
+    std::vector<uint16_t> shortIndices;
+
+    // 两种布局的顶点和索引，指向cache或上面的数组
+    const Vertex* vertexData;
+    const PackedVertex* packedData;
+    const unsigned int* indexData;
+    const uint16_t* shortIndexData;
+    size_t vertexCount;
+    size_t lodIndexCount;
+    VertexPackingError compactError;
+
+    // 三角形按顶点缓存（及可选的过度绘制）重排，顶点按首次使用的顺序重排，未被引用的顶点丢弃
+    // 在计算顶点法线之前进行
+    void optimizeMesh(ObjMesh& mesh);
+    // 按优化方式原地重排一段三角形索引
+    void reorderTriangles(unsigned int* triangleIndices, size_t indexCount, const glm::vec3* positions, size_t vertexCount);
+    // 二次误差简化生成LOD链，生成lodIndices（全部级别的索引）和lods
+    void buildLods(const std::vector<unsigned int>& indices);
+    // 解析OBJ并计算顶点法线，生成vertices与包围盒；indices为第0级的三角形，只用于生成LOD
+    void loadModel(const std::string& path, std::vector<unsigned int>& indices);
+    // 打包紧凑格式的顶点和16位索引，之后的上传和缓存都使用打包好的数据
+    void packMesh();
+    // 保持缓存的映射，顶点和索引直接使用映射的数据；簇和统计数据也来自缓存，不做逐三角形的计算
+    bool loadFromCache(const std::string& cachePath, const MeshSourceKey& key);
+    // 每级LOD分别切分为簇，结果与LOD一起写入缓存
+    void buildMeshletSet();
+};
+
+#endif
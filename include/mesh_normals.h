@@ -0,0 +1,39 @@
+#ifndef MESH_NORMALS_H
+#define MESH_NORMALS_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstddef>
+
+// 顶点法线的加权方式
+enum class NormalWeighting {
+    Uniform,    // 相邻面的单位法线直接相加（与原实现一致）
+    Area,       // 按面积加权
+    Angle       // 按顶点所在角的角度加权
+};
+
+// 结构体数组(SoA)形式的顶点位置，便于SIMD一次处理多个三角形
+struct PositionsSoA {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+
+    size_t size() const { return x.size(); }
+};
+
+// AoS顶点位置转换为SoA
+void splitPositions(const glm::vec3* positions, size_t count, PositionsSoA& soa, unsigned int threadCount = 0);
+
+// 计算三角形列表的单位面法线，退化三角形输出零向量
+void computeFaceNormals(const PositionsSoA& positions, const unsigned int* indices, size_t indexCount,
+                        glm::vec3* faceNormals, unsigned int threadCount = 0);
+
+// 计算单位顶点法线，可同时输出面法线（faceNormals非空时）
+// 三角形按线程分段，每个线程累加到自己的部分和中，最后按顶点区间并行归约，热路径上没有原子操作
+// threadCount为0时使用全部硬件线程
+void computeVertexNormals(const PositionsSoA& positions, const unsigned int* indices, size_t indexCount,
+                          glm::vec3* vertexNormals, NormalWeighting weighting = NormalWeighting::Uniform,
+                          glm::vec3* faceNormals = nullptr, unsigned int threadCount = 0);
+
+#endif
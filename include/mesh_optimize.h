@@ -0,0 +1,47 @@
+#ifndef MESH_OPTIMIZE_H
+#define MESH_OPTIMIZE_H
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+// 加载时的网格顺序优化
+enum class MeshOptimize : uint32_t {
+    None = 0,               // 保持文件中的面和顶点顺序
+    VertexCache = 1,        // 按变换后顶点缓存重排三角形，再按首次使用顺序重排顶点
+    Overdraw = 2            // 在VertexCache基础上按簇重排，外侧朝外的簇先画以减少过度绘制
+};
+
+// 模拟的变换后顶点缓存大小（FIFO），也是Tipsify的缓存参数
+const size_t VERTEX_CACHE_SIZE = 16;
+
+// 顶点缓存统计
+//   ACMR：每个三角形平均变换的顶点数（0.5~3，越小越好）
+//   ATVR：变换的顶点数与顶点总数之比（1为每个顶点只变换一次）
+struct VertexCacheStats {
+    float acmr = 0.0f;
+    float atvr = 0.0f;
+};
+
+// 用FIFO缓存模拟统计索引序列的顶点变换次数
+VertexCacheStats analyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount,
+                                    size_t cacheSize = VERTEX_CACHE_SIZE);
+
+// Tipsify（Sander等，2007）：沿扇形依次输出三角形，下一个扇心优先选仍在缓存中且剩余三角形少的顶点
+// destination与indices不能重叠
+void optimizeVertexCache(unsigned int* destination, const unsigned int* indices, size_t indexCount,
+                         size_t vertexCount, size_t cacheSize = VERTEX_CACHE_SIZE);
+
+// 在缓存优化后的顺序上按簇排序：所有顶点都未命中缓存的三角形开始一个新簇
+// 簇按 dot(簇中心 - 网格中心, 簇法线) 从大到小排列，凸出朝外的部分先画；簇内顺序不变
+// destination与indices不能重叠
+void optimizeOverdraw(unsigned int* destination, const unsigned int* indices, size_t indexCount,
+                      const glm::vec3* positions, size_t vertexCount, size_t cacheSize = VERTEX_CACHE_SIZE);
+
+// 按索引中首次使用的顺序生成顶点重映射 remap[旧下标] = 新下标，未使用的顶点为~0u
+// 返回使用到的顶点数
+size_t optimizeVertexFetchRemap(unsigned int* remap, const unsigned int* indices, size_t indexCount,
+                                size_t vertexCount);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef MESH_SIMPLIFY_H
+#define MESH_SIMPLIFY_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// 一级LOD在合并索引缓冲中的范围，所有级别共用同一个顶点缓冲
+struct MeshLod {
+    uint32_t indexOffset;
+    uint32_t indexCount;
+    float error;            // 相对原网格的几何误差（模型空间距离），第0级为0
+};
+
+static_assert(sizeof(MeshLod) == 12, "MeshLod is stored as-is in the mesh cache");
+
+// 二次误差度量（QEM）简化到targetIndexCount个索引，或误差超过maxError时停止
+// 只做半边折叠（顶点并入相邻顶点），结果仍然索引原顶点，不新增顶点
+// 边界顶点只沿边界折叠；折叠前检查相邻三角形不翻转
+// 返回实际误差；threadCount为0时大网格使用全部硬件线程
+float simplifyMesh(const glm::vec3* positions, size_t vertexCount,
+                   const unsigned int* indices, size_t indexCount,
+                   size_t targetIndexCount, float maxError,
+                   std::vector<unsigned int>& result, unsigned int threadCount = 0);
+
+// 生成LOD链：第0级为原索引，之后每级三角形数减半，逐级连续简化（二次误差在级别之间累积）
+// 达到maxLevels、三角形过少或无法继续简化时停止；lodIndices为所有级别依次拼接的索引
+void buildLodChain(const glm::vec3* positions, size_t vertexCount,
+                   const unsigned int* indices, size_t indexCount, size_t maxLevels,
+                   std::vector<unsigned int>& lodIndices, std::vector<MeshLod>& lods,
+                   unsigned int threadCount = 0);
+
+// 选择屏幕空间误差不超过maxErrorPixels的最粗级别
+// pixelsPerUnit为模型空间单位长度在屏幕上的像素数
+size_t selectLod(const MeshLod* lods, size_t count, float pixelsPerUnit, float maxErrorPixels);
+
+// 网格是否封闭：每条有向边都有反向的边，即没有简化时所说的边界边
+// 封闭且朝向一致的网格从外部看不到背面，按法线锥剔除背向的簇不会留下空洞
+bool isClosedMesh(const unsigned int* indices, size_t indexCount, size_t vertexCount);
+
+#endif
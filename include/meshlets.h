@@ -0,0 +1,54 @@
+#ifndef MESHLETS_H
+#define MESHLETS_H
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 每个簇的顶点数和三角形数上限
+const size_t MESHLET_MAX_VERTICES = 64;
+const size_t MESHLET_MAX_TRIANGLES = 124;
+
+// 网格簇：索引缓冲中连续的一段三角形，剔除后直接作为glMultiDrawElements的一个范围
+struct Meshlet {
+    uint32_t indexOffset;
+    uint32_t indexCount;
+};
+
+// 所有簇及其包围数据；包围球和法线锥按SoA存放，剔除时一次测试4个簇
+struct MeshletSet {
+    std::vector<Meshlet> meshlets;
+    std::vector<float> centerX, centerY, centerZ, radius;
+    std::vector<float> axisX, axisY, axisZ;
+    // 背面剔除：dot(center - eye, axis) >= cutoff * |center - eye| + radius 时整簇背向相机
+    // 法线分布过宽的簇cutoff为1，永远不会被剔除
+    std::vector<float> cutoff;
+
+    size_t size() const { return meshlets.size(); }
+    void clear();
+};
+
+// 一次剔除的统计
+struct MeshletCullStats {
+    size_t tested = 0;
+    size_t frustumCulled = 0;
+    size_t backfaceCulled = 0;
+    size_t visibleTriangles = 0;
+    double cpuMilliseconds = 0.0;
+};
+
+// 把indices[indexOffset, indexOffset + indexCount)按顺序贪心切分为簇并追加到set
+// 索引已经按顶点缓存优化时相邻三角形在空间上也相邻，不需要重排索引
+void buildMeshlets(const glm::vec3* positions, size_t vertexCount,
+                   const unsigned int* indices, size_t indexOffset, size_t indexCount, MeshletSet& set);
+
+// 剔除set中[first, first + count)的簇，modelViewProjection为模型空间到裁剪空间的变换
+// eye为模型空间中的相机位置；backface为false时只做视锥剔除
+// 可见簇写入ranges（每个范围两个值：索引偏移、索引数），相邻的可见簇合并为一个范围
+void cullMeshlets(const MeshletSet& set, size_t first, size_t count,
+                  const glm::mat4& modelViewProjection, const glm::vec3& eye, bool backface,
+                  std::vector<uint32_t>& ranges, MeshletCullStats& stats);
+
+#endif
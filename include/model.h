@@ -4,181 +4,216 @@
 #include <GL/glew.h>
 
 #include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
 
 #include <vector>
-#include <string>
-#include <fstream>
-#include <sstream>
-#include <iostream>
-#include <map>
-#include <random>
+#include <algorithm>
 
 #include "shader.h"
+#include "mesh_data.h"
+#include "instancing.h"
+#include "vertex_format.h"
+#include "meshlets.h"
 
-struct Vertex {
-    glm::vec3 Position;
-    glm::vec3 Normal;
-};
-
-struct Face {
-    unsigned int v1, v2, v3;
-};
-
-class Model 
+// 在MeshData之上管理GPU缓冲与绘制：VAO、顶点和索引缓冲、LOD选择与簇剔除的结果
+class Model : public MeshData
 {
 public:
-    std::vector<Vertex> vertices;
-    std::vector<Face> faces;
-    std::vector<glm::vec3> faceNormals;
-    std::vector<unsigned int> indices;
-    glm::vec3 modelColor;
-    bool useVertexNormal;
+    // 当前GPU缓冲的大小与紧凑格式的量化误差（Float格式时为0）
+    size_t vertexBufferBytes = 0;
+    size_t indexBufferBytes = 0;
+    VertexPackingError packingError;
     
     unsigned int VAO;
     
-    Model(const char* path)
+    // path、useCache与optimization见MeshData
+    // format为GPU顶点缓冲的布局，可以之后用SetVertexFormat切换；缓存文件同时保存两种布局的顶点和索引
+    // upload为false时构造过程不调用GL（可以在工作线程中构造），之后在GL线程上调用Upload
+    Model(const char* path, bool useCache = true, MeshOptimize optimization = MeshOptimize::VertexCache,
+          VertexFormat format = VertexFormat::Compact, bool upload = true)
+        : MeshData(path, useCache, optimization), VAO(0), VBO(0), EBO(0), instanceVAO(0), instanceSource(0), lodLevel(0),
+          vertexFormat(format), indexType(GL_UNSIGNED_INT)
+    {
+        if (upload)
+            Upload();
+    }
+    
+    // 创建顶点数组并上传顶点和索引缓冲，需要当前线程有GL上下文；已上传时什么也不做
+    void Upload()
+    {
+        if (!VAO)
+            setupMesh();
+    }
+    
+    ~Model()
     {
-        loadModel(path);
-        setupMesh();
-        useVertexNormal = true;
-        randomColor();
+        // 从未上传（upload为false且没有调用Upload）时不调用GL，没有上下文的工具也能析构
+        if (!VAO)
+            return;
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteVertexArrays(1, &instanceVAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
     }
     
     void Draw(Shader &shader) 
     {
+        setQuantization(shader);
+        shader.setBool("instanced", false);
         shader.setVec3("objectColor", modelColor);
+        shader.setBool("flatShading", !useVertexNormal);
         
         glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
+        drawElements();
         glBindVertexArray(0);
     }
     
-    void randomColor() 
+    // 以单个实例的变换、颜色和法线模式绘制一次，作为实例化绘制的对照
+    void Draw(Shader &shader, const InstanceData &instance)
     {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_real_distribution<float> dis(0.0, 1.0);
+        setQuantization(shader);
+        shader.setBool("instanced", false);
+        shader.setMat4("model", instance.model);
+        shader.setVec3("objectColor", glm::vec3(instance.color));
+        shader.setBool("flatShading", instance.color.w != 0.0f);
         
-        modelColor = glm::vec3(dis(gen), dis(gen), dis(gen));
-    }
-    
-    void toggleNormalMode() 
-    {
-        useVertexNormal = !useVertexNormal;
-        updateNormals();
+        glBindVertexArray(VAO);
+        drawElements();
+        glBindVertexArray(0);
     }
     
-private:
-    unsigned int VBO, EBO;
-    
-    void loadModel(const std::string& path)
+    // 一次调用绘制缓冲中的全部实例，变换、法线矩阵、颜色和法线模式都来自实例属性
+    void DrawInstanced(Shader &shader, const InstanceBuffer &instances)
     {
-        std::ifstream file(path);
-        if (!file.is_open()) {
-            std::cout << "Failed to open file: " << path << std::endl;
+        if (instances.size() == 0 || lods.empty())
             return;
-        }
         
-        std::vector<glm::vec3> positions;
-        std::vector<glm::vec3> tempNormals;
-        
-        std::string line;
-        while (std::getline(file, line)) {
-            std::istringstream iss(line);
-            std::string prefix;
-            iss >> prefix;
-            
-            if (prefix == "v") {
-                float x, y, z;
-                iss >> x >> y >> z;
-                positions.push_back(glm::vec3(x, y, z));
-                
-                Vertex vertex;
-                vertex.Position = glm::vec3(x, y, z);
-                vertex.Normal = glm::vec3(0.0f); // 初始化法线为0
-                vertices.push_back(vertex);
-            }
-            else if (prefix == "f") {
-                Face face;
-                iss >> face.v1 >> face.v2 >> face.v3;
-                
-                // OBJ文件索引从1开始，需要减1
-                face.v1 -= 1;
-                face.v2 -= 1;
-                face.v3 -= 1;
-                faces.push_back(face);
-                
-                // 添加到索引数组中用于绘制
-                indices.push_back(face.v1);
-                indices.push_back(face.v2);
-                indices.push_back(face.v3);
-                
-                // 计算面法线
-                glm::vec3 pos1 = positions[face.v1];
-                glm::vec3 pos2 = positions[face.v2];
-                glm::vec3 pos3 = positions[face.v3];
-                
-                glm::vec3 normal = glm::normalize(glm::cross(pos2 - pos1, pos3 - pos1));
-                faceNormals.push_back(normal);
-                
-                // 将面法线累加到顶点法线上，后续会归一化
-                vertices[face.v1].Normal += normal;
-                vertices[face.v2].Normal += normal;
-                vertices[face.v3].Normal += normal;
-            }
-        }
-        
-        // 归一化顶点法线
-        for (auto& vertex : vertices) {
-            if (glm::length(vertex.Normal) > 0) {
-                vertex.Normal = glm::normalize(vertex.Normal);
-            }
+        // 实例化绘制使用单独的VAO，共享顶点和索引缓冲，普通绘制不受实例属性影响
+        if (instanceSource != instances.buffer()) {
+            if (!instanceVAO)
+                glGenVertexArrays(1, &instanceVAO);
+            glBindVertexArray(instanceVAO);
+            bindVertexAttributes();
+            instances.bindAttributes();
+            glBindVertexArray(0);
+            instanceSource = instances.buffer();
         }
         
-        file.close();
+        setQuantization(shader);
+        shader.setBool("instanced", true);
+        glBindVertexArray(instanceVAO);
+        const MeshLod& lod = lods[lodLevel];
+        glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(lod.indexCount), indexType,
+                                reinterpret_cast<const void*>(size_t(lod.indexOffset) * indexTypeSize(indexType)),
+                                static_cast<GLsizei>(instances.size()));
+        glBindVertexArray(0);
+    }
+    
+    // 剔除当前LOD级别中在视锥外或整体背向相机的簇，之后由DrawVisible绘制剩下的簇
+    // modelViewProjection为模型空间到裁剪空间的变换，eye为模型空间中的相机位置
+    const MeshletCullStats& CullMeshlets(const glm::mat4& modelViewProjection, const glm::vec3& eye, bool backface)
+    {
+        size_t first = lodMeshlets.empty() ? 0 : lodMeshlets[lodLevel];
+        size_t count = lodMeshlets.empty() ? 0 : lodMeshlets[lodLevel + 1] - first;
+        cullMeshlets(meshlets, first, count, modelViewProjection, eye, backface, visibleRanges, cullStats);
+        return cullStats;
     }
     
-    void updateNormals()
+    // 用一次glMultiDrawElements绘制上次CullMeshlets留下的簇（相邻的簇已合并为一个范围）
+    void DrawVisible(Shader &shader)
     {
-        std::vector<glm::vec3> newNormals;
+        setQuantization(shader);
+        shader.setBool("instanced", false);
+        shader.setVec3("objectColor", modelColor);
+        shader.setBool("flatShading", !useVertexNormal);
         
-        if (useVertexNormal) {
-            // 使用之前计算好的顶点法线
-            for (const auto& vertex : vertices) {
-                newNormals.push_back(vertex.Normal);
-            }
-        } else {
-            // 使用面法线
-            newNormals.resize(vertices.size(), glm::vec3(0.0f));
-            for (size_t i = 0; i < faces.size(); i++) {
-                Face face = faces[i];
-                glm::vec3 faceNormal = faceNormals[i];
-                
-                newNormals[face.v1] = faceNormal;
-                newNormals[face.v2] = faceNormal;
-                newNormals[face.v3] = faceNormal;
-            }
+        size_t rangeCount = visibleRanges.size() / 2;
+        if (rangeCount == 0)
+            return;
+        drawCounts.resize(rangeCount);
+        drawOffsets.resize(rangeCount);
+        for (size_t i = 0; i < rangeCount; i++) {
+            drawOffsets[i] = reinterpret_cast<const void*>(size_t(visibleRanges[i * 2]) * indexTypeSize(indexType));
+            drawCounts[i] = static_cast<GLsizei>(visibleRanges[i * 2 + 1]);
         }
         
-        // 更新VBO中的法线数据
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBindVertexArray(VAO);
+        glMultiDrawElements(GL_TRIANGLES, drawCounts.data(), indexType, drawOffsets.data(), static_cast<GLsizei>(rangeCount));
+        glBindVertexArray(0);
+    }
+    
+    // 上次剔除后可见的三角形数和绘制范围数
+    size_t VisibleTriangles() const { return cullStats.visibleTriangles; }
+    size_t VisibleRanges() const { return visibleRanges.size() / 2; }
+    
+    // 以新的布局重新上传顶点和索引缓冲
+    void SetVertexFormat(VertexFormat format)
+    {
+        if (format == vertexFormat || !VAO)
+            return;
+        vertexFormat = format;
         
-        // 先更新顶点数据
-        std::vector<float> data;
-        for (size_t i = 0; i < vertices.size(); i++) {
-            // 位置
-            data.push_back(vertices[i].Position.x);
-            data.push_back(vertices[i].Position.y);
-            data.push_back(vertices[i].Position.z);
-            
-            // 法线
-            data.push_back(newNormals[i].x);
-            data.push_back(newNormals[i].y);
-            data.push_back(newNormals[i].z);
-        }
+        glBindVertexArray(VAO);
+        uploadBuffers();
+        bindVertexAttributes();
+        glBindVertexArray(0);
         
-        glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_STATIC_DRAW);
+        // 实例化VAO在下次绘制时按新布局重新配置
+        instanceSource = 0;
+    }
+    
+    VertexFormat GetVertexFormat() const { return vertexFormat; }
+    GLenum GetIndexType() const { return indexType; }
+    
+    // 之后的绘制使用的LOD级别，超出范围时取最粗一级
+    void SetLod(size_t level)
+    {
+        lodLevel = lods.empty() ? 0 : std::min(level, lods.size() - 1);
+    }
+    
+    size_t GetLod() const { return lodLevel; }
+    
+    // 按屏幕空间误差选择级别：pixelsPerUnit为模型空间单位长度投影到屏幕上的像素数
+    size_t SelectLod(float pixelsPerUnit, float maxErrorPixels)
+    {
+        SetLod(selectLod(lods.data(), lods.size(), pixelsPerUnit, maxErrorPixels));
+        return lodLevel;
+    }
+    
+    // 当前级别每次绘制的三角形数
+    size_t DrawnTriangles() const
+    {
+        return lods.empty() ? 0 : lods[lodLevel].indexCount / 3;
+    }
+    
+private:
+    unsigned int VBO, EBO;
+    unsigned int instanceVAO;
+    unsigned int instanceSource;   // instanceVAO所配置的实例缓冲
+    size_t lodLevel;
+    VertexFormat vertexFormat;
+    GLenum indexType;
+    PositionQuantization quantization;
+    
+    // 最近一次簇剔除的结果，每帧复用
+    std::vector<uint32_t> visibleRanges;
+    std::vector<GLsizei> drawCounts;
+    std::vector<const void*> drawOffsets;
+    MeshletCullStats cullStats;
+    
+    // 紧凑格式的位置相对包围盒量化，着色器中反量化；Float格式时为恒等变换
+    void setQuantization(Shader &shader)
+    {
+        shader.setVec3("positionScale", quantization.scale);
+        shader.setVec3("positionOffset", quantization.offset);
+    }
+    
+    void drawElements()
+    {
+        if (lods.empty())
+            return;
+        const MeshLod& lod = lods[lodLevel];
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(lod.indexCount), indexType,
+                       reinterpret_cast<const void*>(size_t(lod.indexOffset) * indexTypeSize(indexType)));
     }
     
     void setupMesh()
@@ -188,39 +223,38 @@ private:
         glGenBuffers(1, &EBO);
         
         glBindVertexArray(VAO);
+        uploadBuffers();
+        bindVertexAttributes();
+        glBindVertexArray(0);
+    }
+    
+    // 按当前布局上传顶点（位置 + 法线）和全部LOD级别的索引，两种布局都已打包好，直接交给glBufferData
+    void uploadBuffers()
+    {
+        bool compact = vertexFormat == VertexFormat::Compact;
+        quantization = compact ? positionQuantization(boundsMin, boundsMax) : PositionQuantization();
+        packingError = compact ? CompactError() : VertexPackingError();
         
-        // 顶点数据
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        vertexBufferBytes = VertexCount() * (compact ? sizeof(PackedVertex) : sizeof(Vertex));
+        glBufferData(GL_ARRAY_BUFFER, vertexBufferBytes,
+                     compact ? static_cast<const void*>(PackedVertices()) : static_cast<const void*>(Vertices()), GL_STATIC_DRAW);
         
-        std::vector<float> data;
-        for (const auto& vertex : vertices) {
-            // 位置
-            data.push_back(vertex.Position.x);
-            data.push_back(vertex.Position.y);
-            data.push_back(vertex.Position.z);
-            
-            // 法线
-            data.push_back(vertex.Normal.x);
-            data.push_back(vertex.Normal.y);
-            data.push_back(vertex.Normal.z);
-        }
-        
-        glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_STATIC_DRAW);
-        
-        // 索引数据
+        // 紧凑格式在有16位索引时使用16位索引
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-        
-        // 设置顶点属性指针
-        // 位置属性
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-        
-        // 法线属性
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-        
-        glBindVertexArray(0);
+        indexType = compact && ShortIndices() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        indexBufferBytes = LodIndexCount() * indexTypeSize(indexType);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBufferBytes,
+                     indexType == GL_UNSIGNED_SHORT ? static_cast<const void*>(ShortIndices()) : static_cast<const void*>(Indices()),
+                     GL_STATIC_DRAW);
+    }
+    
+    // 在当前绑定的VAO上配置顶点缓冲、索引缓冲和位置/法线属性
+    void bindVertexAttributes()
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        setVertexAttributes(vertexFormat);
     }
 };
 
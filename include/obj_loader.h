@@ -0,0 +1,36 @@
+#ifndef OBJ_LOADER_H
+#define OBJ_LOADER_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+// OBJ解析结果：只保留顶点位置和三角化后的索引
+struct ObjMesh {
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+};
+
+// 加载统计信息
+struct ObjLoadStats {
+    size_t bytes = 0;
+    unsigned int threads = 0;
+    double seconds = 0.0;
+
+    double megabytesPerSecond() const
+    {
+        return seconds > 0.0 ? (bytes / (1024.0 * 1024.0)) / seconds : 0.0;
+    }
+};
+
+// 内存映射OBJ文件，按换行对齐分块并行解析后合并
+// 支持 f v、v/vt、v//vn、v/vt/vn 形式、负索引以及多边形（扇形三角化）
+// threadCount为0时使用全部硬件线程
+bool loadObj(const std::string& path, ObjMesh& mesh, unsigned int threadCount = 0, ObjLoadStats* stats = nullptr);
+
+// 从内存中的OBJ文本解析，loadObj的核心实现
+bool parseObj(const char* data, size_t size, ObjMesh& mesh, unsigned int threadCount = 0);
+
+#endif
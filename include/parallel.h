@@ -0,0 +1,130 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+// 可用的硬件线程数，无法检测时返回1
+inline unsigned int hardwareThreads()
+{
+    unsigned int n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+// 将[0, count)均分为threadCount段并行执行，fn(begin, end, threadIndex)
+// 第0段在调用线程上执行，threadCount为0时使用全部硬件线程
+template <typename Fn>
+void parallelFor(size_t count, unsigned int threadCount, Fn&& fn)
+{
+    if (threadCount == 0)
+        threadCount = hardwareThreads();
+    threadCount = static_cast<unsigned int>(std::min<size_t>(threadCount, std::max<size_t>(count, 1)));
+
+    if (threadCount <= 1) {
+        fn(size_t(0), count, 0u);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount - 1);
+    for (unsigned int t = 1; t < threadCount; t++) {
+        size_t begin = count * t / threadCount;
+        size_t end = count * (t + 1) / threadCount;
+        workers.emplace_back([&fn, begin, end, t]() { fn(begin, end, t); });
+    }
+
+    fn(size_t(0), count / threadCount, 0u);
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+// 常驻线程池：每次Run在全部线程（含调用线程，编号0）上各执行一次fn(threadIndex)，全部返回后Run才返回
+// 工作线程在两次Run之间休眠，适合每帧多次分发的短任务；任务的划分由fn自己决定（如原子计数器取块）
+class ThreadPool {
+public:
+    // threadCount为0时使用全部硬件线程
+    explicit ThreadPool(unsigned int threadCount = 0)
+        : threads(threadCount ? threadCount : hardwareThreads())
+    {
+        workers.reserve(threads - 1);
+        for (unsigned int t = 1; t < threads; t++)
+            workers.emplace_back([this, t]() { workerLoop(t); });
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        start.notify_all();
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned int Size() const { return threads; }
+
+    void Run(const std::function<void(unsigned int)>& fn)
+    {
+        if (threads == 1) {
+            fn(0);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &fn;
+            running = threads - 1;
+            generation++;
+        }
+        start.notify_all();
+        fn(0);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]() { return running == 0; });
+        task = nullptr;
+    }
+
+private:
+    void workerLoop(unsigned int index)
+    {
+        unsigned long long seen = 0;
+        for (;;) {
+            const std::function<void(unsigned int)>* current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                start.wait(lock, [&]() { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+                current = task;
+            }
+            (*current)(index);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                running--;
+            }
+            done.notify_one();
+        }
+    }
+
+    unsigned int threads;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable done;
+    const std::function<void(unsigned int)>* task = nullptr;
+    unsigned long long generation = 0;
+    unsigned int running = 0;
+    bool stopping = false;
+};
+
+#endif
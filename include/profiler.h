@@ -0,0 +1,147 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+class TextRenderer;
+
+// 一组采样的滚动统计（毫秒）
+struct ProfileStats {
+    float min = 0.0f;
+    float avg = 0.0f;
+    float p50 = 0.0f;
+    float p99 = 0.0f;
+    float max = 0.0f;
+    unsigned int samples = 0;
+};
+
+// 对samples排序后计算统计，samples会被修改
+ProfileStats computeStats(std::vector<float>& samples);
+
+// 一个命名区段的统计结果，同一帧内多次出现的同名区段先求和
+struct PassSummary {
+    std::string name;
+    ProfileStats cpu;
+    ProfileStats gpu;       // 没有GPU计时的区段samples为0
+};
+
+// 每帧的CPU/GPU分段计时器
+// CPU时间用steady_clock，GPU时间用GL_TIME_ELAPSED查询；查询对象按帧轮换，
+// 结果在QUERY_RING帧之后才读取，结果尚未可用时直接丢弃该帧的GPU数据，从不等待GPU
+class Profiler {
+public:
+    static const int QUERY_RING = 4;          // 查询环的帧数
+    static const int MAX_SCOPES = 32;         // 每帧最多记录的区段数
+    static const int MAX_PASSES = 32;         // 不同名称的区段上限
+    static const int MAX_DEPTH = 8;           // 区段最大嵌套深度
+    static const int HISTORY_FRAMES = 240;    // 参与统计和导出的帧数
+
+    Profiler();
+    ~Profiler();
+
+    // 每帧开始时调用，回收QUERY_RING帧之前的查询结果
+    void BeginFrame();
+    void EndFrame();
+
+    // 开始/结束一个命名区段，name须为字符串常量
+    // GL_TIME_ELAPSED查询不能嵌套，嵌套区段只记录CPU时间
+    void Begin(const char* name, bool gpu = true);
+    void End();
+
+    // 根据最近HISTORY_FRAMES帧计算统计
+    void Summarize();
+    const std::vector<PassSummary>& GetSummary() const { return summary; }
+    const ProfileStats& GetFrameStats() const { return frameStats; }
+
+    // GPU结果未能及时取回而被丢弃的帧数
+    unsigned long long GetDroppedFrames() const { return droppedFrames; }
+
+    // 每隔若干帧刷新一次统计并更新叠加层文本，visible为false时清空叠加层
+    void DrawOverlay(TextRenderer& text, float x, float y, bool visible);
+
+    // 导出最近HISTORY_FRAMES帧的全部区段
+    bool ExportCSV(const std::string& path) const;
+    // Chrome trace（chrome://tracing / Perfetto），GPU区段画在单独的轨道上，起点取CPU提交时刻
+    bool ExportChromeTrace(const std::string& path) const;
+
+private:
+    struct ScopeEvent {
+        unsigned int pass;
+        unsigned int depth;
+        double cpuStart;        // 相对于Profiler创建时刻的毫秒数
+        double cpuEnd;
+        float gpuMilliseconds;  // 小于0表示没有GPU数据
+        int query;              // 使用的查询对象下标，-1表示没有
+    };
+
+    struct FrameRecord {
+        unsigned long long frame;
+        double cpuStart;
+        double cpuEnd;
+        unsigned int eventCount;
+        ScopeEvent events[MAX_SCOPES];
+    };
+
+    struct FrameSlot {
+        FrameRecord record;
+        GLuint queries[MAX_SCOPES];
+        unsigned int queryCount;
+        bool pending;
+    };
+
+    double now() const;
+    unsigned int passIndex(const char* name);
+    void resolve(FrameSlot& slot);
+    void formatStats(char* buffer, size_t size, const char* label, const ProfileStats& cpu, const ProfileStats* gpu) const;
+
+    std::chrono::steady_clock::time_point epoch;
+
+    std::vector<FrameSlot> slots;
+    FrameSlot* current;
+    unsigned long long frameIndex;
+    unsigned long long droppedFrames;
+
+    int stack[MAX_DEPTH];
+    int depth;
+    bool gpuActive;
+
+    std::vector<const char*> passNames;
+
+    std::vector<FrameRecord> history;
+    size_t historyHead;
+    size_t historyCount;
+
+    std::vector<PassSummary> summary;
+    ProfileStats frameStats;
+    std::vector<float> scratch;
+
+    std::vector<unsigned int> overlayText;
+    unsigned long long lastOverlayFrame;
+    bool overlayVisible;
+};
+
+// 作用域内自动Begin/End
+class ProfileScope {
+public:
+    ProfileScope(Profiler& profiler, const char* name, bool gpu = true) : profiler(profiler)
+    {
+        profiler.Begin(name, gpu);
+    }
+
+    ~ProfileScope()
+    {
+        profiler.End();
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    Profiler& profiler;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef RENDER_SETTINGS_H
+#define RENDER_SETTINGS_H
+
+#include "light_clusters.h"
+
+// 渲染参数，不依赖GL，Renderer与SoftRasterizer共用
+
+// 透视投影的近/远平面，分簇的深度分层与之一致
+const float NEAR_PLANE = 0.1f;
+const float FAR_PLANE = 100.0f;
+
+// 光照开关与材质参数
+struct RenderSettings {
+    float shininess = 32.0f;
+    bool enableAmbient = true;
+    bool enableDiffuse = true;
+    bool enableSpecular = true;
+
+    // 设置了实例时：true用一次glDrawElementsInstanced绘制全部实例，false逐个实例绘制（用于对比）
+    bool instancing = true;
+
+    // 设置了点光源时的着色方式
+    LightCulling lightCulling = LightCulling::Clustered;
+
+    // true：先把法线、材质和颜色写入G-buffer，再对每个像素做一次全屏光照（延迟着色）
+    // false：绘制模型时直接在片段着色器中计算光照（前向着色）
+    bool deferred = false;
+
+    // 按屏幕空间误差为模型选择LOD级别，lodErrorPixels为允许的几何误差（像素）；false时总是绘制原网格
+    bool lod = true;
+    float lodErrorPixels = 1.0f;
+
+    // 绘制单个模型时按簇剔除视锥外的部分，backfaceCulling同时剔除整体背向相机的簇
+    // 剩下的簇用一次glMultiDrawElements绘制；false时整级LOD一次glDrawElements
+    // 开放网格的背面可见，backfaceCulling应只对封闭网格（MeshData::closed）开启；开启时光栅化也剔除背面，
+    // 留下的三角形与簇的划分无关
+    bool meshletCulling = true;
+    bool backfaceCulling = false;
+
+    // 为每个点光源画一个小球体；instancing为true时全部球体一次实例化绘制
+    bool lightGizmos = true;
+};
+
+#endif
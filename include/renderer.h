@@ -0,0 +1,127 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "shader.h"
+#include "camera.h"
+#include "light.h"
+#include "model.h"
+#include "sphere.h"
+#include "frame_uniforms.h"
+#include "instancing.h"
+#include "light_clusters.h"
+#include "light_pool.h"
+#include "gbuffer.h"
+#include "render_settings.h"
+
+class Profiler;
+
+// 点光源球体的半径和细分，远小于主光源球体
+const float POINT_LIGHT_GIZMO_RADIUS = 0.03f;
+const int POINT_LIGHT_GIZMO_SECTORS = 12;
+const int POINT_LIGHT_GIZMO_STACKS = 6;
+
+// 最近一帧的绘制统计
+struct RenderStats {
+    unsigned int drawCalls = 0;
+    size_t triangles = 0;
+    size_t lodLevel = 0;            // 最后一次绘制模型使用的LOD级别
+    
+    // 点光源
+    size_t pointLights = 0;
+    size_t visibleLights = 0;       // 分簇时与视锥相交的光源数
+    size_t clusterLightRefs = 0;    // 所有簇中光源下标的总数
+    double cullMilliseconds = 0.0;  // CPU分簇耗时
+    
+    // 网格簇剔除
+    size_t meshlets = 0;            // 测试的簇数
+    size_t frustumCulled = 0;
+    size_t backfaceCulled = 0;
+    size_t drawRanges = 0;          // 合并后glMultiDrawElements的范围数
+    double meshletMilliseconds = 0.0;
+};
+
+// 场景渲染：主模型和光源球体，窗口程序与离屏基准测试共用同一份绘制代码
+class Renderer {
+public:
+    Shader modelShader;
+    Shader sphereShader;
+    Shader gbufferShader;
+    Shader deferredShader;
+    FrameUniforms frameUniforms;
+
+    // 模型和球体由调用方持有，需在Renderer之前创建、之后销毁
+    Renderer(Model& model, Sphere& lightSphere);
+
+    // 构造时读取的全部着色器文件（同一文件被几个程序使用就出现几次），用于在工作线程中预读
+    static std::vector<std::string> ShaderFiles();
+
+    // 设置场景中模型的实例，上传一次后每帧复用；count为0时恢复绘制单个模型
+    void SetInstances(const InstanceData* data, size_t count);
+
+    // 设置点光源池（世界空间），count为0时只保留主光源
+    void SetPointLights(const PointLight* lights, size_t count);
+
+    // 绘制一帧到当前绑定的帧缓冲（width x height像素），profiler非空时为每个阶段计时
+    void Render(const Camera& camera, const Light& light, const RenderSettings& settings, int width, int height, Profiler* profiler = nullptr);
+
+    const RenderStats& GetStats() const { return stats; }
+
+    // 重新构建用到这些着色器文件（路径形如"shaders/model.fs"）的程序，不等待完成
+    void ReloadShaders(const std::vector<std::string>& files);
+
+    // 每帧调用一次：换上已链接的新程序并重新绑定uniform块和采样器
+    // 有重建结束时返回true；失败的程序继续使用旧版本，日志见GetShaderErrors
+    bool UpdateShaderReloads();
+
+    // 最近一次重建失败的编译链接日志，所有程序都构建成功后为空
+    const std::string& GetShaderErrors() const { return shaderErrors; }
+
+    // 是否还有程序在后台重建，需要继续调用UpdateShaderReloads
+    bool ShaderReloadsPending() const;
+
+private:
+    static const int SHADER_COUNT = 4;
+    Shader* shaders[SHADER_COUNT];
+    std::string reloadErrors[SHADER_COUNT];
+    std::string shaderErrors;
+
+    // uniform块绑定点和采样器单元只需设置一次，程序重建后要重新设置
+    void configureShaders();
+
+    // 主光源与点光源的着色参数，前向着色的模型着色器和延迟着色的光照着色器共用
+    void setLighting(Shader& shader, const RenderSettings& settings);
+    // 按当前的实例设置绘制模型（单个、实例化或逐实例）
+    void drawModel(Shader& shader, const RenderSettings& settings);
+    // 模型空间单位长度经transform变换后在屏幕上的像素数，按包围球最近处估计
+    float pixelsPerUnit(const glm::mat4& transform) const;
+    void chooseLod(const RenderSettings& settings, float pixels);
+    // 点光源球体：实例化时一次绘制，否则逐个绘制
+    void drawLightGizmos(const RenderSettings& settings);
+    // 延迟着色：几何阶段写入G-buffer，光照阶段绘制到调用时绑定的帧缓冲
+    void renderDeferred(const RenderSettings& settings, const FrameData& frame, int width, int height, Profiler* profiler);
+
+    Model& model;
+    Sphere& lightSphere;
+    RenderStats stats;
+    
+    // 本帧的相机位置与投影尺度（视口高度 / (2 * tan(fov/2))），用于选择LOD
+    glm::vec3 lodEye;
+    float lodPixelScale = 1.0f;
+    glm::mat4 viewProjection;
+
+    std::vector<InstanceData> instances;
+    InstanceBuffer instanceBuffer;
+
+    std::vector<PointLight> pointLights;
+    std::vector<SphereInstance> gizmoInstances;
+    Sphere pointLightGizmo;
+    LightClusterData clusters;
+    LightPool lightPool;
+    GBuffer gbuffer;
+};
+
+#endif
@@ -5,129 +5,181 @@
 #include <glm/glm.hpp>
 
 #include <string>
-#include <fstream>
-#include <sstream>
-#include <iostream>
+#include <vector>
+#include <cstring>
+#include <unordered_map>
+
+#include "shader_utils.h"
 
 class Shader
 {
 public:
     unsigned int ID;
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::string fragmentPrelude;    // 插入片段着色器的公共源码文件，没有时为空
+    
+    // 实际发出的glUniform*调用次数，用于统计每帧的uniform开销
+    inline static unsigned int uniformCalls = 0;
     
-    Shader(const char* vertexPath, const char* fragmentPath)
+    // 编译链接（或从程序二进制缓存加载）后缓存全部uniform位置
+    Shader(const char* vertexPath, const char* fragmentPath, const char* fragmentPrelude = nullptr)
+        : vertexPath(vertexPath), fragmentPath(fragmentPath), fragmentPrelude(fragmentPrelude ? fragmentPrelude : "")
     {
-        // 1. 从文件路径中获取顶点/片段着色器
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        
-        // 保证ifstream对象可以抛出异常
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        try
-        {
-            // 打开文件
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            
-            // 读取文件的缓冲内容到数据流中
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            
-            // 关闭文件处理器
-            vShaderFile.close();
-            fShaderFile.close();
-            
-            // 转换数据流到string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch(std::ifstream::failure& e)
-        {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
-        }
-        const char* vShaderCode = vertexCode.c_str();
-        const char* fShaderCode = fragmentCode.c_str();
-        
-        // 2. 编译着色器
-        unsigned int vertex, fragment;
-        int success;
-        char infoLog[512];
-        
-        // 顶点着色器
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        // 打印编译错误（如果有的话）
-        glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-        if(!success)
-        {
-            glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-            std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-        }
-        
-        // 片段着色器
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        // 打印编译错误（如果有的话）
-        glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-        if(!success)
-        {
-            glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-            std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-        }
+        ID = createShaderProgram(vertexPath, fragmentPath, fragmentPrelude);
+        cacheUniforms();
+    }
+    
+    // 程序是否由该文件构建（与构造时的路径字符串比较）
+    bool UsesFile(const std::string &path) const
+    {
+        return path == vertexPath || path == fragmentPath || (!fragmentPrelude.empty() && path == fragmentPrelude);
+    }
+    
+    // 从文件重新构建程序，新程序链接成功之前继续使用旧程序；上一次重建未完成时直接放弃它
+    void BeginReload()
+    {
+        if (reloading)
+            cancelShaderProgram(pendingReload);
+        beginShaderProgram(vertexPath.c_str(), fragmentPath.c_str(), pendingReload,
+                           fragmentPrelude.empty() ? nullptr : fragmentPrelude.c_str());
+        reloading = true;
+    }
+    
+    // 重建结束时返回true：链接成功则换上新程序并重新缓存uniform（之前设置的值需要重新设置），
+    // 失败时删除新程序、保留旧程序；编译链接日志写入errors
+    // 驱动支持并行编译时未完成的重建立即返回false，否则在这里同步完成
+    bool UpdateReload(std::string &errors)
+    {
+        if (!reloading)
+            return false;
+        ShaderBuildStatus status = finishShaderProgram(pendingReload, false, errors);
+        if (status == ShaderBuildStatus::Pending)
+            return false;
         
-        // 着色器程序
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        // 打印连接错误（如果有的话）
-        glGetProgramiv(ID, GL_LINK_STATUS, &success);
-        if(!success)
-        {
-            glGetProgramInfoLog(ID, 512, NULL, infoLog);
-            std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+        reloading = false;
+        if (status == ShaderBuildStatus::Linked) {
+            glDeleteProgram(ID);
+            ID = pendingReload.program;
+            cacheUniforms();
+        } else {
+            glDeleteProgram(pendingReload.program);
         }
-        
-        // 删除着色器，它们已经链接到我们的程序中了，已经不再需要了
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+        pendingReload = PendingShaderProgram();
+        return true;
     }
     
+    bool IsReloading() const { return reloading; }
+    
     // 使用/激活程序
     void use() 
     { 
         glUseProgram(ID); 
     }
     
+    // 将uniform块绑定到指定的绑定点，着色器中没有该块时忽略
+    void bindUniformBlock(const char* blockName, unsigned int binding) const
+    {
+        unsigned int index = glGetUniformBlockIndex(ID, blockName);
+        if (index != GL_INVALID_INDEX)
+            glUniformBlockBinding(ID, index, binding);
+    }
+    
     // uniform工具函数
+    // 位置在链接后一次性缓存；值与上次相同时不再发出GL调用
+    // 因此程序的uniform只能通过这些函数修改
     void setBool(const std::string &name, bool value) const
     {         
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+        setInt(name, (int)value);
     }
     void setInt(const std::string &name, int value) const
     { 
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+        UniformSlot* slot = findChanged(name, &value, sizeof(value));
+        if (slot)
+            glUniform1i(slot->location, value);
     }
     void setFloat(const std::string &name, float value) const
     { 
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+        UniformSlot* slot = findChanged(name, &value, sizeof(value));
+        if (slot)
+            glUniform1f(slot->location, value);
     }
     void setVec3(const std::string &name, const glm::vec3 &value) const
     { 
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        UniformSlot* slot = findChanged(name, &value[0], sizeof(float) * 3);
+        if (slot)
+            glUniform3fv(slot->location, 1, &value[0]);
     }
     void setVec3(const std::string &name, float x, float y, float z) const
     { 
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z); 
+        setVec3(name, glm::vec3(x, y, z));
     }
     void setMat4(const std::string &name, const glm::mat4 &mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        UniformSlot* slot = findChanged(name, &mat[0][0], sizeof(float) * 16);
+        if (slot)
+            glUniformMatrix4fv(slot->location, 1, GL_FALSE, &mat[0][0]);
+    }
+    
+private:
+    // 缓存的uniform位置及最近一次上传的值
+    struct UniformSlot {
+        int location;
+        bool hasValue;
+        unsigned char value[sizeof(float) * 16];
+    };
+    
+    mutable std::unordered_map<std::string, UniformSlot> uniforms;
+    
+    PendingShaderProgram pendingReload;
+    bool reloading = false;
+    
+    // 链接后枚举所有活动uniform（uniform块中的成员没有位置，跳过）
+    void cacheUniforms()
+    {
+        uniforms.clear();
+        
+        int count = 0;
+        int maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        
+        std::vector<char> name(maxLength + 1);
+        for (int i = 0; i < count; i++) {
+            int length = 0;
+            int size = 0;
+            unsigned int type = 0;
+            glGetActiveUniform(ID, i, maxLength + 1, &length, &size, &type, name.data());
+            
+            int location = glGetUniformLocation(ID, name.data());
+            if (location < 0)
+                continue;
+            
+            UniformSlot slot = { location, false, {} };
+            std::string uniformName(name.data(), length);
+            uniforms[uniformName] = slot;
+            
+            // 数组以"name[0]"报告，同时登记"name"
+            if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+                uniforms[uniformName.substr(0, uniformName.size() - 3)] = slot;
+        }
+    }
+    
+    // 查找uniform，值有变化时更新缓存并计数，否则返回nullptr
+    UniformSlot* findChanged(const std::string &name, const void* data, size_t bytes) const
+    {
+        auto it = uniforms.find(name);
+        if (it == uniforms.end())
+            return nullptr;
+        
+        UniformSlot& slot = it->second;
+        if (slot.hasValue && std::memcmp(slot.value, data, bytes) == 0)
+            return nullptr;
+        
+        std::memcpy(slot.value, data, bytes);
+        slot.hasValue = true;
+        uniformCalls++;
+        return &slot;
     }
 };
 
@@ -0,0 +1,68 @@
+#ifndef SHADER_UTILS_H
+#define SHADER_UTILS_H
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 从文件加载着色器源代码，失败时返回空串；有预读的源码时直接取用
+std::string loadShaderSource(const char* filePath);
+
+// 读取这些文件并暂存，供之后的loadShaderSource各取用一次（同一文件要用几次就列几次）
+// 只读文件不调用GL，可以在工作线程中执行；取用后再次加载（热重载）会重新读文件
+void preloadShaderSources(const std::vector<std::string>& paths);
+
+// 由顶点/片段着色器文件创建程序，Shader和TextRenderer共用这一条路径
+// 先按 源码 + 驱动标识 的哈希查找程序二进制缓存，缺失或被驱动拒绝时从源码编译链接并写回缓存
+// fragmentPrelude不为空时，该文件（如shaders/lighting.glsl）插入在片段着色器的#version之后，一并计入缓存键
+// 编译或链接失败时打印错误，返回的程序未成功链接
+GLuint createShaderProgram(const char* vertexPath, const char* fragmentPath, const char* fragmentPrelude = nullptr);
+
+// 正在构建的程序：源码已提交编译链接，驱动支持KHR_parallel_shader_compile时在驱动线程中进行
+struct PendingShaderProgram {
+    GLuint program = 0;
+    GLuint vertex = 0;
+    GLuint fragment = 0;
+    uint64_t key = 0;
+    bool useCache = false;
+    bool fromCache = false;
+    std::chrono::steady_clock::time_point start;
+};
+
+enum class ShaderBuildStatus {
+    Pending,
+    Linked,
+    Failed
+};
+
+// 读取源码并提交编译链接，命中程序二进制缓存时已经完成
+void beginShaderProgram(const char* vertexPath, const char* fragmentPath, PendingShaderProgram& pending,
+                        const char* fragmentPrelude = nullptr);
+
+// 查询构建状态，block为true时等待完成；完成后编译和链接日志写入errors（成功时为空）
+// 链接失败的程序不会删除，由调用方决定
+ShaderBuildStatus finishShaderProgram(PendingShaderProgram& pending, bool block, std::string& errors);
+
+// 放弃尚未取结果的构建，删除其中的着色器和程序
+void cancelShaderProgram(PendingShaderProgram& pending);
+
+// 让驱动在后台线程编译（KHR_parallel_shader_compile），不支持时返回false，之后的构建仍然同步完成
+bool enableParallelShaderCompile();
+
+// 程序二进制缓存目录，默认为工作目录下的shader_cache；空串关闭缓存
+void setShaderCacheDirectory(const std::string& directory);
+
+// 本进程中构建着色器程序的累计统计（包括热重载）
+struct ShaderBuildStats {
+    unsigned int programs = 0;
+    unsigned int cacheHits = 0;
+    unsigned int cacheRejected = 0;     // 缓存文件存在但被驱动拒绝（驱动升级等）
+    double milliseconds = 0.0;
+};
+
+const ShaderBuildStats& shaderBuildStats();
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef SHADER_WATCHER_H
+#define SHADER_WATCHER_H
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 监视着色器目录，文件写完或被替换（编辑器先写临时文件再重命名）时记录下来
+// Linux上用inotify在后台线程中等待，渲染线程每帧只取一次结果；其他平台不做任何事
+class ShaderWatcher {
+public:
+    explicit ShaderWatcher(const std::string& directory = "shaders");
+    ~ShaderWatcher();
+
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    // 监视是否在运行（目录不存在或平台不支持时为false）
+    bool IsWatching() const { return watching; }
+
+    // 取出上次调用以来改动过的文件，路径形如"shaders/model.fs"，同一文件只出现一次
+    std::vector<std::string> TakeChanged();
+
+private:
+    void run();
+
+    std::string directory;
+    bool watching = false;
+    int inotifyFd = -1;
+    std::atomic<bool> stopping{ false };
+    std::thread thread;
+
+    std::mutex mutex;
+    std::set<std::string> changed;
+};
+
+#endif
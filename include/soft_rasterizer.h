@@ -0,0 +1,112 @@
+#ifndef SOFT_RASTERIZER_H
+#define SOFT_RASTERIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "camera.h"
+#include "light.h"
+#include "mesh_data.h"
+#include "parallel.h"
+#include "render_settings.h"
+
+// CPU渲染的目标图像，RGB8，第0行在最上方
+struct SoftFramebuffer {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> color;
+
+    void Resize(int w, int h);
+    bool WritePPM(const std::string& path) const;
+};
+
+// 最近一帧的统计
+struct SoftRenderStats {
+    size_t triangles = 0;           // 提交的三角形
+    size_t rasterized = 0;          // 裁剪、剔除零面积后进入光栅化的三角形（近平面裁剪可能一分为二）
+    size_t pixelsShaded = 0;        // 被覆盖并着色的像素（每像素只着色一次）
+    double vertexMilliseconds = 0.0;
+    double setupMilliseconds = 0.0; // 裁剪、三角形建立和分块
+    double rasterMilliseconds = 0.0;// 各分块的光栅化、深度测试和着色
+    double totalMilliseconds = 0.0;
+};
+
+// 分块的CPU光栅化器，作为没有GPU时的参考渲染
+// 直接读取Model所用的CPU端网格数据（MeshData的顶点和第0级LOD索引），相机矩阵和主光源参数与Renderer相同，着色与shaders/model.fs一致：
+// Phong光照，环境光/漫反射/镜面反射开关，顶点法线或面法线（MeshData::useVertexNormal）；点光源和光源球体不绘制
+// 屏幕划分为TILE_SIZE见方的分块，由线程池并行处理；边函数、深度测试和着色每次处理一组像素，
+// 编译时启用AVX2时一组8个，否则用SSE2一组4个，都没有时逐像素
+class SoftRasterizer {
+public:
+    static const int TILE_SIZE = 32;
+
+    // threadCount为0时使用全部硬件线程
+    explicit SoftRasterizer(unsigned int threadCount = 0);
+
+    // 绘制模型到target，先清为黑色
+    void Render(const MeshData& mesh, const Camera& camera, const Light& light, const RenderSettings& settings,
+                SoftFramebuffer& target);
+
+    const SoftRenderStats& GetStats() const { return stats; }
+
+    unsigned int Threads() const { return pool.Size(); }
+
+    // 每组像素数（SIMD宽度）
+    static int Lanes();
+
+    // 编译时选择的指令集
+    static const char* InstructionSet();
+
+private:
+    // 屏幕空间三角形：顶点按逆时针（面积为正）排列，边函数的端点按固定顺序求值，
+    // 相邻三角形在公共边上得到互为相反数的结果，配合平局规则每个像素只归属一个三角形
+    struct Triangle {
+        float x[3], y[3];           // 像素坐标（吸附到1/16像素）
+        float z[3];                 // NDC深度
+        float invW[3];
+        glm::vec3 position[3];      // 世界空间位置与法线，用于着色
+        glm::vec3 normal[3];
+        glm::vec3 faceNormal;       // 朝向相机的几何法线，面法线模式使用
+        int minX, minY, maxX, maxY; // 覆盖的像素范围（含）
+    };
+
+    // 近平面裁剪时生成的顶点
+    struct ClipVertex {
+        glm::vec4 clip;
+        glm::vec3 position;
+        glm::vec3 normal;
+    };
+
+    void setupTriangles(unsigned int chunk, const MeshData& mesh, const glm::vec3& eye, int width, int height);
+    void emitTriangle(unsigned int chunk, const ClipVertex* v, const glm::vec3& eye, int width, int height);
+    void rasterTile(unsigned int thread, int tile, const RenderSettings& settings, const MeshData& mesh,
+                    const Light& light, const glm::vec3& eye, SoftFramebuffer& target);
+
+    ThreadPool pool;
+    SoftRenderStats stats;
+
+    std::vector<glm::vec4> clipPositions;
+
+    // 每个分段（线程）建立的三角形及其分块列表；分块按分段顺序遍历，保持提交顺序
+    std::vector<std::vector<Triangle>> triangles;
+    std::vector<std::vector<std::vector<uint32_t>>> bins;
+    std::vector<size_t> threadPixels;
+    int tilesX = 0;
+    int tilesY = 0;
+
+    // 每个线程的分块缓冲：深度、所属三角形（分段和下标）和透视校正后的重心坐标
+    struct TileScratch {
+        std::vector<float> depth;
+        std::vector<int32_t> chunk;
+        std::vector<uint32_t> triangle;
+        std::vector<float> b1;
+        std::vector<float> b2;
+    };
+    std::vector<TileScratch> scratch;
+};
+
+#endif
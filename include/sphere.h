@@ -4,150 +4,233 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <tuple>
 #include <vector>
 #include "shader.h"
+#include "vertex_format.h"
+
+// 光源球体的每实例数据，与sphere.vs中location 2、3的实例属性一一对应
+struct SphereInstance {
+    glm::vec4 positionRadius;   // xyz为世界位置，w为半径
+    glm::vec4 color;            // rgb为颜色，w未用
+};
+
+// 一种细分的单位球（GPU缓冲），同一细分和顶点格式的所有Sphere共用一份
+struct SphereMesh {
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    GLsizei indexCount = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    VertexFormat format = VertexFormat::Compact;
+    PositionQuantization quantization;
+
+    SphereMesh() = default;
+    SphereMesh(const SphereMesh&) = delete;
+    SphereMesh& operator=(const SphereMesh&) = delete;
+
+    ~SphereMesh() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+    }
+
+    // 在当前绑定的VAO上配置顶点缓冲、索引缓冲和位置/法线属性
+    void bindAttributes() const {
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        setVertexAttributes(format);
+    }
+};
+
+// 生成单位球的顶点（位置 + 法线交错）和索引，北极指向+y
+// 每条经线和纬线的sin/cos只算一次，顶点由两张表相乘得到
+inline void generateSphere(int sectorCount, int stackCount, std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+    std::vector<float> sectorCos(sectorCount + 1), sectorSin(sectorCount + 1);
+    for (int j = 0; j <= sectorCount; ++j) {
+        float sectorAngle = j * 2 * M_PI / sectorCount;  // 从0到2pi
+        sectorCos[j] = std::cos(sectorAngle);
+        sectorSin[j] = std::sin(sectorAngle);
+    }
+
+    vertices.clear();
+    vertices.reserve(size_t(stackCount + 1) * (sectorCount + 1) * 6);
+    for (int i = 0; i <= stackCount; ++i) {
+        float stackAngle = M_PI / 2 - i * M_PI / stackCount;  // 从北极到南极
+        float xy = std::cos(stackAngle);
+        float z = std::sin(stackAngle);
+
+        for (int j = 0; j <= sectorCount; ++j) {
+            float x = xy * sectorCos[j];
+            float y = xy * sectorSin[j];
+
+            // 单位球的法线即位置；交换y和z，使北极指向+y方向
+            const float vertex[6] = { x, z, y, x, z, y };
+            vertices.insert(vertices.end(), vertex, vertex + 6);
+        }
+    }
+
+    indices.clear();
+    for (int i = 0; i < stackCount; ++i) {
+        int k1 = i * (sectorCount + 1);
+        int k2 = k1 + sectorCount + 1;
+
+        for (int j = 0; j < sectorCount; ++j, ++k1, ++k2) {
+            // 对每个堆栈，除了第一个，添加2个三角形
+            if (i != 0) {
+                indices.push_back(k1);
+                indices.push_back(k2);
+                indices.push_back(k1 + 1);
+            }
+
+            // 对每个堆栈，除了最后一个，添加2个三角形
+            if (i != (stackCount - 1)) {
+                indices.push_back(k1 + 1);
+                indices.push_back(k2);
+                indices.push_back(k2 + 1);
+            }
+        }
+    }
+}
+
+// 按(sectors, stacks, format)取得共享的球体网格，首次请求时生成并上传
+// 缓存只保存弱引用，最后一个持有者释放后GL缓冲随之删除（需在GL上下文销毁之前）
+inline std::shared_ptr<SphereMesh> acquireSphereMesh(int sectorCount, int stackCount, VertexFormat format) {
+    static std::map<std::tuple<int, int, VertexFormat>, std::weak_ptr<SphereMesh>> cache;
+
+    std::weak_ptr<SphereMesh>& entry = cache[std::make_tuple(sectorCount, stackCount, format)];
+    if (std::shared_ptr<SphereMesh> mesh = entry.lock())
+        return mesh;
+
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    generateSphere(sectorCount, stackCount, vertices, indices);
+
+    std::shared_ptr<SphereMesh> mesh = std::make_shared<SphereMesh>();
+    mesh->format = format;
+    if (format == VertexFormat::Compact)
+        mesh->quantization = positionQuantization(glm::vec3(-1.0f), glm::vec3(1.0f));
+    mesh->indexCount = static_cast<GLsizei>(indices.size());
+
+    glGenVertexArrays(1, &mesh->VAO);
+    glGenBuffers(1, &mesh->VBO);
+    glGenBuffers(1, &mesh->EBO);
+    glBindVertexArray(mesh->VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->VBO);
+    uploadVertices(format, vertices.data(), vertices.size() / 6, mesh->quantization);
+
+    size_t indexBytes = 0;
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->EBO);
+    mesh->indexType = uploadIndices(format, indices.data(), indices.size(), vertices.size() / 6, indexBytes);
+
+    setVertexAttributes(format);
+    glBindVertexArray(0);
+
+    entry = mesh;
+    return mesh;
+}
 
 class Sphere {
 public:
-    unsigned int VAO, VBO, EBO;
     float radius;
     int sectorCount;
     int stackCount;
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
 
-    Sphere(float radius = 0.1f, int sectors = 36, int stacks = 18)
-        : radius(radius), sectorCount(sectors), stackCount(stacks) {
-        setupSphere();
+    Sphere(float radius = 0.1f, int sectors = 36, int stacks = 18, VertexFormat format = VertexFormat::Compact)
+        : radius(radius), sectorCount(sectors), stackCount(stacks),
+          mesh(acquireSphereMesh(sectors, stacks, format)), instanceVAO(0), instanceVBO(0), instanceCapacity(0) {
     }
 
     ~Sphere() {
-        glDeleteVertexArrays(1, &VAO);
-        glDeleteBuffers(1, &VBO);
-        glDeleteBuffers(1, &EBO);
+        glDeleteVertexArrays(1, &instanceVAO);
+        glDeleteBuffers(1, &instanceVBO);
+    }
+
+    Sphere(const Sphere&) = delete;
+    Sphere& operator=(const Sphere&) = delete;
+
+    // 光源强度对应的球体颜色
+    static glm::vec3 IntensityColor(float intensity) {
+        return glm::vec3(1.0f, 1.0f, 0.8f) * intensity;
     }
 
-    // 绘制球体，基于光源的位置和强度
+    // 绘制一个球体，基于光源的位置和强度；调用方负责shader.use()
     void Draw(Shader &shader, const glm::vec3 &position, float intensity) {
-        shader.use();
-
-        // 设置颜色 - 基于光源强度
-        glm::vec3 color = glm::vec3(1.0f, 1.0f, 0.8f) * intensity;
-        shader.setVec3("sphereColor", color);
-
-        // 创建模型矩阵
-        glm::mat4 model = glm::mat4(1.0f);
-        
-        // 移动到光源位置
-        model = glm::translate(model, position);
-        
-        // 应用固定缩放，不再随光照强度变化
-        model = glm::scale(model, glm::vec3(radius));
-        
-        // 设置模型矩阵
-        shader.setMat4("model", model);
-        
-        // 绘制球体
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+        // 固定缩放，不随光照强度变化
+        SphereInstance instance;
+        instance.positionRadius = glm::vec4(position, radius);
+        instance.color = glm::vec4(IntensityColor(intensity), 0.0f);
+        Draw(shader, instance);
     }
 
-private:
-    void setupSphere() {
-        // 生成球体的顶点和索引
-        generateVertices();
-        generateIndices();
+    // 以单个实例的位置、半径和颜色绘制一次，作为实例化绘制的对照
+    void Draw(Shader &shader, const SphereInstance &instance) {
+        shader.setBool("instanced", false);
+        shader.setVec3("sphereColor", glm::vec3(instance.color));
 
-        // 创建和配置顶点数组对象和相关缓冲区
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(instance.positionRadius));
+        model = glm::scale(model, glm::vec3(instance.positionRadius.w));
+        shader.setMat4("model", model);
+        setQuantization(shader);
 
-        glBindVertexArray(VAO);
+        glBindVertexArray(mesh->VAO);
+        glDrawElements(GL_TRIANGLES, mesh->indexCount, mesh->indexType, 0);
+        glBindVertexArray(0);
+    }
 
-        // 顶点数据
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    // 一次glDrawElementsInstanced绘制count个球体，每个实例有各自的位置、半径和颜色
+    void DrawInstanced(Shader &shader, const SphereInstance* instances, size_t count) {
+        if (count == 0)
+            return;
+        uploadInstances(instances, count);
 
-        // 索引数据
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        shader.setBool("instanced", true);
+        setQuantization(shader);
+        glBindVertexArray(instanceVAO);
+        glDrawElementsInstanced(GL_TRIANGLES, mesh->indexCount, mesh->indexType, 0, static_cast<GLsizei>(count));
+        glBindVertexArray(0);
+    }
 
-        // 设置顶点属性指针
-        // 位置属性
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-        
-        // 法线属性
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    size_t TriangleCount() const { return mesh->indexCount / 3; }
 
-        glBindVertexArray(0);
+private:
+    std::shared_ptr<SphereMesh> mesh;
+    unsigned int instanceVAO;
+    unsigned int instanceVBO;
+    size_t instanceCapacity;
+
+    void setQuantization(Shader &shader) {
+        shader.setVec3("positionScale", mesh->quantization.scale);
+        shader.setVec3("positionOffset", mesh->quantization.offset);
     }
 
-    void generateVertices() {
-        vertices.clear();
-        
-        float x, y, z, xy;
-        float nx, ny, nz;
-        float sectorStep = 2 * M_PI / sectorCount;
-        float stackStep = M_PI / stackCount;
-        float sectorAngle, stackAngle;
-
-        for (int i = 0; i <= stackCount; ++i) {
-            stackAngle = M_PI / 2 - i * stackStep;  // 从北极到南极
-            xy = radius * cos(stackAngle);
-            z = radius * sin(stackAngle);
-
-            for (int j = 0; j <= sectorCount; ++j) {
-                sectorAngle = j * sectorStep;  // 从0到2pi
-
-                // 顶点位置
-                x = xy * cos(sectorAngle);
-                y = xy * sin(sectorAngle);
-                
-                // 法线向量 (归一化的位置向量)
-                nx = x / radius;
-                ny = y / radius;
-                nz = z / radius;
-
-                // 添加顶点和法线
-                vertices.push_back(x);
-                vertices.push_back(z);  // 交换y和z，使北极指向+y方向
-                vertices.push_back(y);
-                vertices.push_back(nx);
-                vertices.push_back(nz);  // 同样交换法线的y和z
-                vertices.push_back(ny);
+    // 实例缓冲容量不够时重新分配，否则原地覆盖；实例VAO在第一次使用时创建
+    void uploadInstances(const SphereInstance* instances, size_t count) {
+        if (!instanceVAO) {
+            glGenVertexArrays(1, &instanceVAO);
+            glGenBuffers(1, &instanceVBO);
+            glBindVertexArray(instanceVAO);
+            mesh->bindAttributes();
+            glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+            for (GLuint i = 0; i < 2; i++) {
+                glEnableVertexAttribArray(2 + i);
+                glVertexAttribPointer(2 + i, 4, GL_FLOAT, GL_FALSE, sizeof(SphereInstance), (void*)(i * sizeof(glm::vec4)));
+                glVertexAttribDivisor(2 + i, 1);
             }
+            glBindVertexArray(0);
         }
-    }
 
-    void generateIndices() {
-        indices.clear();
-        int k1, k2;
-
-        for (int i = 0; i < stackCount; ++i) {
-            k1 = i * (sectorCount + 1);
-            k2 = k1 + sectorCount + 1;
-
-            for (int j = 0; j < sectorCount; ++j, ++k1, ++k2) {
-                // 对每个堆栈，除了第一个，添加2个三角形
-                if (i != 0) {
-                    indices.push_back(k1);
-                    indices.push_back(k2);
-                    indices.push_back(k1 + 1);
-                }
-
-                // 对每个堆栈，除了最后一个，添加2个三角形
-                if (i != (stackCount - 1)) {
-                    indices.push_back(k1 + 1);
-                    indices.push_back(k2);
-                    indices.push_back(k2 + 1);
-                }
-            }
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        if (count > instanceCapacity) {
+            glBufferData(GL_ARRAY_BUFFER, count * sizeof(SphereInstance), instances, GL_STREAM_DRAW);
+            instanceCapacity = count;
+        } else {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(SphereInstance), instances);
         }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 };
 
-#endif 
\ No newline at end of file
+#endif
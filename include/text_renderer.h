@@ -1,37 +1,108 @@
 #ifndef TEXT_RENDERER_H
 #define TEXT_RENDERER_H
 
-#include <map>
 #include <string>
+#include <vector>
 #include <glm/glm.hpp>
 #include <GL/glew.h>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+// 字形在图集中的位置及排版信息
 struct Character {
-    GLuint TextureID;
+    glm::vec4 UV;           // 图集中的纹理坐标 (u0, v0, u1, v1)
     glm::ivec2 Size;
     glm::ivec2 Bearing;
     GLuint Advance;
 };
 
+// 光栅化好的字形图集（单通道），由TextRenderer上传为纹理
+struct FontAtlas {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;
+    Character characters[128];
+};
+
+// 用FreeType光栅化前128个ASCII字形并排布到图集中；不调用GL，可以在工作线程中执行
+bool rasterizeFontAtlas(const std::string& font, unsigned int fontSize, FontAtlas& atlas);
+
+// 每帧的文本渲染统计
+struct TextStats {
+    unsigned int drawCalls = 0;
+    unsigned int glyphs = 0;
+    unsigned int layouts = 0;       // 重新排版的保留文本数
+    size_t uploadBytes = 0;         // 上传的顶点数据字节数
+    double cpuMilliseconds = 0.0;
+};
+
+// 保留模式文本的句柄
+typedef unsigned int TextHandle;
+
 class TextRenderer {
 public:
     TextRenderer(unsigned int width, unsigned int height);
     ~TextRenderer();
-    
+
+    // 将前128个ASCII字形光栅化到一张图集纹理中
     bool Load(std::string font, unsigned int fontSize);
-    
-    void RenderText(std::string text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
-    
+
+    // 上传已光栅化的图集，之前的图集被替换
+    void SetAtlas(const FontAtlas& atlas);
+
+    // 只把字形四边形追加到本帧的顶点队列，不发出GL调用
+    void RenderText(const std::string& text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+
+    // 创建保留模式文本：排版结果缓存在GPU上，每帧自动绘制
+    TextHandle CreateText();
+
+    // 更新保留文本；内容、位置、缩放和颜色都未变化时不做任何事（不分配内存、不上传）
+    void SetText(TextHandle handle, const char* text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+
+    // 排版变化的保留文本在此上传，随后绘制全部保留文本和本帧排队的文本，每帧调用一次
+    void Flush();
+
+    // 最近一次Flush所对应那一帧的统计
+    const TextStats& GetStats() const { return lastStats; }
+
 private:
+    // 每个顶点：位置(2) + 纹理坐标(2) + 颜色(3)
+    static const int FLOATS_PER_VERTEX = 7;
+
+    // 每条保留文本预留的额外字形数，文本稍微变长时不必重建缓冲
+    static const int RETAINED_SLACK_GLYPHS = 8;
+
+    struct RetainedText {
+        std::string text;
+        float x, y, scale;
+        glm::vec3 color;
+        size_t firstVertex;     // 在保留顶点缓冲中的起始顶点
+        size_t capacity;        // 预留的顶点数，多余部分填充退化三角形
+        bool dirty;
+    };
+
+    // 将文本排版为四边形追加到out中，返回字形数
+    unsigned int layoutText(const char* text, size_t length, float x, float y, float scale, glm::vec3 color, std::vector<float>& out) const;
+    void uploadRetained();
+
     GLuint shader;
-    
+
     glm::mat4 projection;
-    
-    std::map<char, Character> Characters;
-    
+
+    Character Characters[128];
+    GLuint atlasTexture;
+
     GLuint VAO, VBO;
+    size_t bufferCapacity;
+
+    std::vector<float> pending;
+
+    std::vector<RetainedText> retained;
+    std::vector<float> layoutScratch;
+    GLuint retainedVAO, retainedVBO;
+    size_t retainedVertices;
+    TextStats frameStats;
+    TextStats lastStats;
 };
 
-#endif
\ No newline at end of file
+#endif
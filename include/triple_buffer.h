@@ -0,0 +1,43 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+// 单写单读的无锁三缓冲：写端和读端各占一份，第三份在两者之间交换
+// 写端填好后Publish，读端Acquire时总是换到最新发布的一份，中间来不及读取的版本被覆盖
+// 双方都不会等待对方，也不会读写同一份数据
+template <typename T>
+class TripleBuffer {
+public:
+    // 写端：填写WriteBuffer()返回的一份，然后发布
+    T& WriteBuffer() { return buffers[writeIndex]; }
+
+    void Publish()
+    {
+        unsigned int previous = middle.exchange(writeIndex | FRESH, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    // 读端：有新发布的数据时换到最新一份并返回true，否则ReadBuffer()保持不变
+    bool Acquire()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH))
+            return false;
+        unsigned int previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    const T& ReadBuffer() const { return buffers[readIndex]; }
+
+private:
+    static const unsigned int INDEX_MASK = 3;
+    static const unsigned int FRESH = 4;
+
+    T buffers[3];
+    std::atomic<unsigned int> middle{ 1 };
+    unsigned int writeIndex = 0;
+    unsigned int readIndex = 2;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef VERTEX_FORMAT_H
+#define VERTEX_FORMAT_H
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "vertex_packing.h"
+
+// 上传顶点到当前绑定的GL_ARRAY_BUFFER，返回字节数
+inline size_t uploadVertices(VertexFormat format, const float* vertexData, size_t vertexCount,
+                             const PositionQuantization& q, VertexPackingError* error = nullptr)
+{
+    if (format == VertexFormat::Float) {
+        size_t bytes = vertexCount * 6 * sizeof(float);
+        glBufferData(GL_ARRAY_BUFFER, bytes, vertexData, GL_STATIC_DRAW);
+        if (error)
+            *error = VertexPackingError();
+        return bytes;
+    }
+
+    std::vector<PackedVertex> packed;
+    packVertices(vertexData, vertexCount, q, packed, error);
+    glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(PackedVertex), packed.data(), GL_STATIC_DRAW);
+    return packed.size() * sizeof(PackedVertex);
+}
+
+// 上传索引到当前绑定的GL_ELEMENT_ARRAY_BUFFER，返回索引类型；bytes为上传的字节数
+inline GLenum uploadIndices(VertexFormat format, const unsigned int* indices, size_t indexCount, size_t vertexCount,
+                            size_t& bytes)
+{
+    if (format == VertexFormat::Compact && fitsShortIndices(vertexCount)) {
+        std::vector<uint16_t> shortIndices;
+        packIndices(indices, indexCount, shortIndices);
+        bytes = indexCount * sizeof(uint16_t);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, bytes, shortIndices.data(), GL_STATIC_DRAW);
+        return GL_UNSIGNED_SHORT;
+    }
+
+    bytes = indexCount * sizeof(unsigned int);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, bytes, indices, GL_STATIC_DRAW);
+    return GL_UNSIGNED_INT;
+}
+
+inline size_t indexTypeSize(GLenum type)
+{
+    return type == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+}
+
+// 在当前绑定的VAO上配置位置（location 0）和法线（location 1）属性，需已绑定顶点缓冲
+inline void setVertexAttributes(VertexFormat format)
+{
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    if (format == VertexFormat::Float) {
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    } else {
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, position));
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, normal));
+    }
+}
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef VERTEX_PACKING_H
+#define VERTEX_PACKING_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 顶点布局与紧凑格式的打包，不依赖GL，网格缓存也使用这里的数据结构
+// 顶点缓冲的布局
+enum class VertexFormat {
+    Float,      // 位置 + 法线各3个float（24字节），32位索引
+    Compact     // 16位归一化位置 + GL_INT_2_10_10_10_REV法线（12字节），顶点数允许时用16位索引
+};
+
+// 紧凑顶点：位置相对包围盒量化为unorm16（第4个分量仅用于对齐），法线为有符号10位定点
+struct PackedVertex {
+    uint16_t position[4];
+    uint32_t normal;
+};
+
+static_assert(sizeof(PackedVertex) == 12, "PackedVertex must be 12 bytes");
+
+// 位置的反量化参数：p = q * scale + offset，q为着色器读到的[0,1]归一化值
+// Float格式时scale为1、offset为0，着色器中的计算不变
+struct PositionQuantization {
+    glm::vec3 offset = glm::vec3(0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+};
+
+// 量化带来的几何误差
+struct VertexPackingError {
+    float maxPosition = 0.0f;       // 模型空间距离
+    float maxNormalDegrees = 0.0f;
+};
+
+inline PositionQuantization positionQuantization(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+    PositionQuantization q;
+    q.offset = boundsMin;
+    // 退化的轴（如平面网格）保持非零，避免除0
+    q.scale = glm::max(boundsMax - boundsMin, glm::vec3(1e-20f));
+    return q;
+}
+
+inline uint16_t quantizeUnorm16(float value)
+{
+    return static_cast<uint16_t>(std::lround(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f));
+}
+
+// 按GL_INT_2_10_10_10_REV打包：x在低10位，依次为y、z，w（2位）为0
+inline uint32_t packNormal(const glm::vec3& n)
+{
+    uint32_t packed = 0;
+    for (int i = 0; i < 3; i++) {
+        int value = static_cast<int>(std::lround(std::min(std::max(n[i], -1.0f), 1.0f) * 511.0f));
+        packed |= (static_cast<uint32_t>(value) & 0x3FFu) << (10 * i);
+    }
+    return packed;
+}
+
+inline glm::vec3 unpackNormal(uint32_t packed)
+{
+    glm::vec3 n;
+    for (int i = 0; i < 3; i++) {
+        int value = static_cast<int>((packed >> (10 * i)) & 0x3FFu);
+        if (value & 0x200)
+            value -= 0x400;
+        n[i] = std::max(value / 511.0f, -1.0f);
+    }
+    return n;
+}
+
+// 把交错的 位置+法线（每顶点6个float）打包为紧凑顶点，error非空时统计量化误差
+inline void packVertices(const float* vertexData, size_t vertexCount, const PositionQuantization& q,
+                         std::vector<PackedVertex>& packed, VertexPackingError* error = nullptr)
+{
+    packed.resize(vertexCount);
+    VertexPackingError maxError;
+    for (size_t i = 0; i < vertexCount; i++) {
+        const float* v = vertexData + i * 6;
+        glm::vec3 position(v[0], v[1], v[2]);
+        glm::vec3 normal(v[3], v[4], v[5]);
+        glm::vec3 unit = (position - q.offset) / q.scale;
+
+        PackedVertex& out = packed[i];
+        out.position[0] = quantizeUnorm16(unit.x);
+        out.position[1] = quantizeUnorm16(unit.y);
+        out.position[2] = quantizeUnorm16(unit.z);
+        out.position[3] = 0;
+        out.normal = packNormal(normal);
+
+        if (error) {
+            glm::vec3 restored = glm::vec3(out.position[0], out.position[1], out.position[2]) / 65535.0f * q.scale + q.offset;
+            maxError.maxPosition = std::max(maxError.maxPosition, glm::length(restored - position));
+            float length = glm::length(normal);
+            if (length > 0.0f) {
+                float cosine = glm::dot(glm::normalize(unpackNormal(out.normal)), normal / length);
+                float degrees = std::acos(std::min(std::max(cosine, -1.0f), 1.0f)) * 57.2957795f;
+                maxError.maxNormalDegrees = std::max(maxError.maxNormalDegrees, degrees);
+            }
+        }
+    }
+    if (error)
+        *error = maxError;
+}
+
+// 全部顶点都能用16位索引寻址时，紧凑格式使用16位索引
+inline bool fitsShortIndices(size_t vertexCount)
+{
+    return vertexCount <= 65536;
+}
+
+inline void packIndices(const unsigned int* indices, size_t indexCount, std::vector<uint16_t>& packed)
+{
+    packed.assign(indices, indices + indexCount);
+}
+
+#endif
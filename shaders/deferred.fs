@@ -0,0 +1,31 @@
+#version 330 core
+// 延迟着色的光照阶段：从G-buffer读取每个像素的法线、材质和颜色，光照与model.fs共用lighting.glsl
+out vec4 FragColor;
+
+// G-buffer（GBuffer，gbuffer.h）
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedo;
+uniform sampler2D gDepth;
+
+// 由深度重建世界坐标
+uniform mat4 invViewProj;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    // 没有几何体的像素保留清屏颜色
+    if (depth == 1.0)
+        discard;
+
+    vec4 ndc = vec4(gl_FragCoord.xy / vec2(textureSize(gDepth, 0)) * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    vec4 world = invViewProj * ndc;
+
+    vec4 normalShininess = texelFetch(gNormal, pixel, 0);
+    Surface surface = Surface(world.xyz / world.w, normalize(normalShininess.xyz),
+                              texelFetch(gAlbedo, pixel, 0).rgb, normalShininess.w);
+    FragColor = vec4(shadeSurface(surface), 1.0);
+
+    // 写回深度，之后绘制的光源球体照常做深度测试
+    gl_FragDepth = depth;
+}
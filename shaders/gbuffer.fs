@@ -0,0 +1,20 @@
+#version 330 core
+// 延迟着色的几何阶段：只写入法线、材质和颜色，光照在deferred.fs中按像素计算一次
+layout (location = 0) out vec4 gNormal;     // xyz为世界空间法线，w为shininess
+layout (location = 1) out vec4 gAlbedo;     // rgb为物体颜色
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec3 ObjectColor;        // 来自objectColor uniform或实例颜色
+
+// 面法线模式：由屏幕空间导数求出三角形的几何法线，与model.fs一致
+flat in int FlatShading;
+
+uniform float shininess;
+
+void main()
+{
+    vec3 norm = FlatShading != 0 ? normalize(cross(dFdx(FragPos), dFdy(FragPos))) : normalize(Normal);
+    gNormal = vec4(norm, shininess);
+    gAlbedo = vec4(ObjectColor, 1.0);
+}
@@ -0,0 +1,107 @@
+// 前向（model.fs）与延迟（deferred.fs）共用的光照，构建程序时插入在片段着色器的#version之后
+// 错误日志中这一段的行号带源串号1，着色器自身的带0
+
+// 每帧共享数据，布局与FrameData（frame_uniforms.h）一致
+struct Light {
+    vec4 position;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+};
+
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+    Light light;
+};
+
+// 光照组件开关
+uniform bool enableAmbient;
+uniform bool enableDiffuse;
+uniform bool enableSpecular;
+
+// 点光源池（LightPool，light_pool.h）：每个光源两个texel，位置+半径、颜色
+uniform samplerBuffer pointLights;
+// 每簇的 offset, count 以及按簇排列的光源下标
+uniform usamplerBuffer clusterLights;
+uniform usamplerBuffer clusterIndices;
+
+// 0：没有点光源，1：只遍历所在簇的光源，2：遍历全部光源
+uniform int pointLightMode;
+uniform int pointLightCount;
+
+// 簇网格：屏幕分块数，clusterParams为 1/块大小、深度分层的scale和bias
+uniform int clusterTilesX;
+uniform int clusterTilesY;
+uniform vec3 clusterParams;
+
+const int CLUSTER_DEPTH_SLICES = 16;   // 与ClusterGrid::DEPTH_SLICES一致
+
+// 被着色的表面：世界坐标、单位法线、颜色和高光指数
+struct Surface {
+    vec3 position;
+    vec3 normal;
+    vec3 color;
+    float shininess;
+};
+
+// 单个点光源的漫反射与镜面反射，半径处平滑衰减到0
+vec3 pointLight(int index, Surface surface, vec3 viewDir)
+{
+    vec4 positionRadius = texelFetch(pointLights, index * 2);
+    vec3 toLight = positionRadius.xyz - surface.position;
+    float distance2 = dot(toLight, toLight);
+    float radius2 = positionRadius.w * positionRadius.w;
+    if (distance2 >= radius2)
+        return vec3(0.0);
+
+    float attenuation = 1.0 - distance2 / radius2;
+    attenuation *= attenuation;
+
+    vec3 lightDir = toLight * inversesqrt(distance2);
+    float diff = max(dot(surface.normal, lightDir), 0.0) * (enableDiffuse ? 1.0 : 0.0);
+    float spec = pow(max(dot(viewDir, reflect(-lightDir, surface.normal)), 0.0), surface.shininess) * (enableSpecular ? 1.0 : 0.0);
+    return texelFetch(pointLights, index * 2 + 1).rgb * attenuation * (diff + spec) * surface.color;
+}
+
+vec3 pointLighting(Surface surface, vec3 viewDir)
+{
+    vec3 result = vec3(0.0);
+    if (pointLightMode == 1) {
+        // 由屏幕位置和视空间深度求所在簇
+        float depth = -(view * vec4(surface.position, 1.0)).z;
+        ivec2 tile = ivec2(gl_FragCoord.xy * clusterParams.x);
+        int slice = clamp(int(floor(log(depth) * clusterParams.y + clusterParams.z)), 0, CLUSTER_DEPTH_SLICES - 1);
+        tile = clamp(tile, ivec2(0), ivec2(clusterTilesX - 1, clusterTilesY - 1));
+        int cluster = (slice * clusterTilesY + tile.y) * clusterTilesX + tile.x;
+
+        uvec2 range = texelFetch(clusterLights, cluster).xy;
+        for (uint i = 0u; i < range.y; i++)
+            result += pointLight(int(texelFetch(clusterIndices, int(range.x + i)).r), surface, viewDir);
+    } else if (pointLightMode == 2) {
+        for (int i = 0; i < pointLightCount; i++)
+            result += pointLight(i, surface, viewDir);
+    }
+    return result;
+}
+
+// 主光源的环境光、漫反射和镜面光，加上所有点光源
+vec3 shadeSurface(Surface surface)
+{
+    // 环境光
+    vec3 ambient = light.ambient.rgb * surface.color * (enableAmbient ? 1.0 : 0.0);
+
+    // 漫反射光
+    vec3 lightDir = normalize(light.position.xyz - surface.position);
+    float diff = max(dot(surface.normal, lightDir), 0.0);
+    vec3 diffuse = light.diffuse.rgb * diff * surface.color * (enableDiffuse ? 1.0 : 0.0);
+
+    // 镜面光
+    vec3 viewDir = normalize(viewPos.xyz - surface.position);
+    vec3 reflectDir = reflect(-lightDir, surface.normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), surface.shininess);
+    vec3 specular = light.specular.rgb * spec * surface.color * (enableSpecular ? 1.0 : 0.0);
+
+    return ambient + diffuse + specular + pointLighting(surface, viewDir);
+}
@@ -1,44 +1,19 @@
 #version 330 core
+// 光照见lighting.glsl，构建程序时插入在#version之后
 out vec4 FragColor;
 
 in vec3 FragPos;
 in vec3 Normal;
+in vec3 ObjectColor;        // 来自objectColor uniform或实例颜色
 
-struct Light {
-    vec3 position;
-    
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
+// 面法线模式：由屏幕空间导数求出三角形的几何法线，与顶点共享和面的顺序无关
+flat in int FlatShading;
 
-uniform vec3 viewPos;
-uniform vec3 objectColor;
-uniform Light light;
 uniform float shininess;
 
-// 光照组件开关
-uniform bool enableAmbient;
-uniform bool enableDiffuse;
-uniform bool enableSpecular;
-
 void main()
 {
-    // 环境光
-    vec3 ambient = light.ambient * objectColor * (enableAmbient ? 1.0 : 0.0);
-  	
-    // 漫反射光
-    vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(light.position - FragPos);
-    float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = light.diffuse * diff * objectColor * (enableDiffuse ? 1.0 : 0.0);
-    
-    // 镜面光
-    vec3 viewDir = normalize(viewPos - FragPos);
-    vec3 reflectDir = reflect(-lightDir, norm);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
-    vec3 specular = light.specular * spec * objectColor * (enableSpecular ? 1.0 : 0.0);
-        
-    vec3 result = ambient + diffuse + specular;
+    vec3 norm = FlatShading != 0 ? normalize(cross(dFdx(FragPos), dFdy(FragPos))) : normalize(Normal);
+    vec3 result = shadeSurface(Surface(FragPos, norm, ObjectColor, shininess));
     FragColor = vec4(result, 1.0);
-} 
\ No newline at end of file
+}
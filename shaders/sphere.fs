@@ -3,23 +3,36 @@ out vec4 FragColor;
 
 in vec3 FragPos;
 in vec3 Normal;
+in vec3 SphereColor;
 
-uniform vec3 viewPos;
-uniform vec3 sphereColor;
+// 每帧共享数据，布局与FrameData（frame_uniforms.h）一致
+struct Light {
+    vec4 position;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+};
+
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+    Light light;
+};
 
 void main()
 {
     // 基本环境光
-    vec3 ambient = 0.3 * sphereColor;
+    vec3 ambient = 0.3 * SphereColor;
     
     // 漫反射光
     vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(viewPos - FragPos); // 使用相机位置作为光源
+    vec3 lightDir = normalize(viewPos.xyz - FragPos); // 使用相机位置作为光源
     float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = diff * sphereColor;
+    vec3 diffuse = diff * SphereColor;
     
     // 镜面光
-    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
     vec3 reflectDir = reflect(-lightDir, norm);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32.0);
     vec3 specular = 0.5 * spec * vec3(1.0);
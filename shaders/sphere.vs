@@ -2,17 +2,52 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 
+// 实例化绘制时的每实例属性，布局与SphereInstance（sphere.h）一致
+layout (location = 2) in vec4 aInstancePositionRadius;
+layout (location = 3) in vec4 aInstanceColor;
+
 out vec3 FragPos;
 out vec3 Normal;
+out vec3 SphereColor;
+
+// 每帧共享数据，布局与FrameData（frame_uniforms.h）一致
+struct Light {
+    vec4 position;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+};
+
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec4 viewPos;
+    Light light;
+};
 
+// 非实例化绘制时使用的uniform
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform vec3 sphereColor;
+
+uniform bool instanced;
+
+// 紧凑顶点格式的位置反量化（vertex_format.h），Float格式时为恒等变换
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    vec3 position = aPos * positionScale + positionOffset;
+    if (instanced) {
+        // 单位球只做均匀缩放和平移，法线不需要变换
+        FragPos = aInstancePositionRadius.xyz + aInstancePositionRadius.w * position;
+        Normal = aNormal;
+        SphereColor = aInstanceColor.rgb;
+    } else {
+        FragPos = vec3(model * vec4(position, 1.0));
+        Normal = mat3(transpose(inverse(model))) * aNormal;
+        SphereColor = sphereColor;
+    }
     
     gl_Position = projection * view * vec4(FragPos, 1.0);
 } 
\ No newline at end of file
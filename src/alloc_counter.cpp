@@ -0,0 +1,80 @@
+#include "alloc_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// 每个线程各自计数：测量一段代码时不会算进加载线程、着色器监视线程等其它线程的分配
+// 平凡类型的thread_local不需要动态初始化，在operator new中使用不会递归分配
+thread_local size_t allocations = 0;
+
+void* countedAlloc(std::size_t size)
+{
+    allocations++;
+    return std::malloc(size ? size : 1);
+}
+
+} // namespace
+
+size_t allocationCount()
+{
+    return allocations;
+}
+
+// 替换全局分配函数，只计数，分配本身仍交给malloc
+void* operator new(std::size_t size)
+{
+    void* p = countedAlloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size)
+{
+    void* p = countedAlloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
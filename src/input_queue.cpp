@@ -0,0 +1,85 @@
+#include "input_queue.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+
+InputQueue::InputQueue()
+    : frameStart(0.0), lastFrameStart(0.0), started(false), totalEvents(0)
+{
+    std::fill(keyDown, keyDown + KEY_COUNT, false);
+    std::fill(downSince, downSince + KEY_COUNT, 0.0);
+    std::fill(held, held + KEY_COUNT, 0.0);
+}
+
+void InputQueue::PushKey(int key, int action, double time)
+{
+    if (key < 0 || key >= KEY_COUNT)
+        return;
+    incoming.push_back({ InputEvent::Key, time, key, action, 0.0, 0.0 });
+    if (action != GLFW_REPEAT)
+        totalEvents++;
+}
+
+void InputQueue::PushMouseButton(int button, int action, double time)
+{
+    incoming.push_back({ InputEvent::MouseButton, time, button, action, 0.0, 0.0 });
+    totalEvents++;
+}
+
+void InputQueue::PushCursor(double x, double y, double time)
+{
+    incoming.push_back({ InputEvent::CursorPos, time, 0, 0, x, y });
+    totalEvents++;
+}
+
+void InputQueue::PushScroll(double x, double y, double time)
+{
+    incoming.push_back({ InputEvent::Scroll, time, 0, 0, x, y });
+    totalEvents++;
+}
+
+const std::vector<InputEvent>& InputQueue::BeginFrame(double now)
+{
+    if (!started) {
+        frameStart = now;
+        started = true;
+    }
+
+    frameEvents.swap(incoming);
+    incoming.clear();
+
+    // 按住时长 = 区间内各个按下段的长度之和，按下时间早于区间起点的从起点算起
+    std::fill(held, held + KEY_COUNT, 0.0);
+    for (const InputEvent& event : frameEvents) {
+        if (event.type != InputEvent::Key || event.action == GLFW_REPEAT)
+            continue;
+        int key = event.code;
+        double time = std::min(std::max(event.time, frameStart), now);
+        if (event.action == GLFW_PRESS && !keyDown[key]) {
+            keyDown[key] = true;
+            downSince[key] = time;
+        } else if (event.action == GLFW_RELEASE && keyDown[key]) {
+            held[key] += time - std::max(downSince[key], frameStart);
+            keyDown[key] = false;
+        }
+    }
+    for (int key = 0; key < KEY_COUNT; key++) {
+        if (keyDown[key])
+            held[key] += now - std::max(downSince[key], frameStart);
+    }
+
+    lastFrameStart = frameStart;
+    frameStart = now;
+    return frameEvents;
+}
+
+double InputQueue::HeldSeconds(int key) const
+{
+    return key >= 0 && key < KEY_COUNT ? held[key] : 0.0;
+}
+
+bool InputQueue::IsDown(int key) const
+{
+    return key >= 0 && key < KEY_COUNT && keyDown[key];
+}
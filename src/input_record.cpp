@@ -0,0 +1,143 @@
+#include "input_record.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const char RECORD_MAGIC[4] = { 'I', 'R', 'E', 'C' };
+const uint32_t RECORD_VERSION = 1;
+
+template <typename T>
+void writeValue(std::ofstream& file, T value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool readValue(std::ifstream& file, T& value)
+{
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+} // namespace
+
+bool InputRecorder::Open(const std::string& path, const InputRecordHeader& header)
+{
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cout << "Failed to open input recording: " << path << std::endl;
+        return false;
+    }
+    file.write(RECORD_MAGIC, sizeof(RECORD_MAGIC));
+    writeValue(file, RECORD_VERSION);
+    writeValue(file, header.colorSeed);
+    for (float channel : header.modelColor)
+        writeValue(file, channel);
+    writeValue(file, header.width);
+    writeValue(file, header.height);
+    return true;
+}
+
+void InputRecorder::WriteFrame(float deltaTime, double frameStart, double frameEnd, const std::vector<InputEvent>& frameEvents)
+{
+    if (!file)
+        return;
+
+    // 每帧12字节，每个事件16字节：类型、动作、键码、相对帧起点的时间偏移和两个坐标
+    writeValue(file, deltaTime);
+    writeValue(file, static_cast<float>(frameEnd - frameStart));
+    writeValue(file, static_cast<uint32_t>(frameEvents.size()));
+    for (const InputEvent& event : frameEvents) {
+        writeValue(file, static_cast<uint8_t>(event.type));
+        writeValue(file, static_cast<int8_t>(event.action));
+        writeValue(file, static_cast<uint16_t>(event.code));
+        writeValue(file, static_cast<float>(event.time - frameStart));
+        writeValue(file, static_cast<float>(event.x));
+        writeValue(file, static_cast<float>(event.y));
+    }
+    frames++;
+    events += frameEvents.size();
+}
+
+bool InputReplay::Open(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[4];
+    uint32_t version = 0;
+    if (!file || !file.read(magic, sizeof(magic)) || std::memcmp(magic, RECORD_MAGIC, sizeof(magic)) != 0 ||
+        !readValue(file, version) || version != RECORD_VERSION) {
+        std::cout << "Not an input recording: " << path << std::endl;
+        return false;
+    }
+    bool ok = readValue(file, header.colorSeed);
+    for (float& channel : header.modelColor)
+        ok = ok && readValue(file, channel);
+    ok = ok && readValue(file, header.width) && readValue(file, header.height);
+    if (!ok) {
+        std::cout << "Truncated input recording: " << path << std::endl;
+        return false;
+    }
+
+    // 录制时进程被强行结束的话最后一帧可能不完整，只丢弃这一帧
+    Frame frame;
+    uint32_t count;
+    while (readValue(file, frame.deltaTime) && readValue(file, frame.span) && readValue(file, count)) {
+        frame.firstEvent = events.size();
+        frame.eventCount = count;
+        for (uint32_t i = 0; i < count; i++) {
+            uint8_t type;
+            int8_t action;
+            uint16_t code;
+            float offset, x, y;
+            if (!readValue(file, type) || !readValue(file, action) || !readValue(file, code) ||
+                !readValue(file, offset) || !readValue(file, x) || !readValue(file, y)) {
+                events.resize(frame.firstEvent);
+                return true;
+            }
+            events.push_back({ static_cast<InputEvent::Type>(type), offset, code, action, x, y });
+        }
+        frames.push_back(frame);
+    }
+    return true;
+}
+
+bool InputReplay::NextFrame(InputQueue& queue, double start, double step, float& recordedDelta)
+{
+    if (nextFrame >= frames.size())
+        return false;
+
+    // 帧内的先后顺序和相对位置保持不变，按键按住的比例因而与录制时一致
+    const Frame& frame = frames[nextFrame++];
+    double scale = frame.span > 0.0f ? step / frame.span : 0.0;
+    for (size_t i = 0; i < frame.eventCount; i++) {
+        const InputEvent& event = events[frame.firstEvent + i];
+        double time = start + std::min(std::max(event.time * scale, 0.0), step);
+        switch (event.type) {
+        case InputEvent::Key:
+            queue.PushKey(event.code, event.action, time);
+            break;
+        case InputEvent::MouseButton:
+            queue.PushMouseButton(event.code, event.action, time);
+            break;
+        case InputEvent::CursorPos:
+            queue.PushCursor(event.x, event.y, time);
+            break;
+        case InputEvent::Scroll:
+            queue.PushScroll(event.x, event.y, time);
+            break;
+        }
+    }
+    recordedDelta = frame.deltaTime;
+    return true;
+}
+
+std::vector<float> InputReplay::RecordedFrameMilliseconds() const
+{
+    std::vector<float> milliseconds;
+    milliseconds.reserve(frames.size());
+    for (const Frame& frame : frames)
+        milliseconds.push_back(1000.0f * frame.deltaTime);
+    return milliseconds;
+}
@@ -0,0 +1,129 @@
+#include "light_clusters.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+namespace {
+
+const int RANGE_STRIDE = 7;
+
+inline int depthSlice(const ClusterGrid& grid, float depth)
+{
+    int slice = static_cast<int>(std::floor(std::log(depth) * grid.sliceScale + grid.sliceBias));
+    return std::min(std::max(slice, 0), ClusterGrid::DEPTH_SLICES - 1);
+}
+
+inline int tileIndex(float ndc, int pixels, int tiles)
+{
+    int tile = static_cast<int>((ndc * 0.5f + 0.5f) * pixels) / ClusterGrid::TILE_SIZE;
+    return std::min(std::max(tile, 0), tiles - 1);
+}
+
+} // namespace
+
+void buildLightClusters(const PointLight* lights, size_t count,
+                        const glm::mat4& view, const glm::mat4& projection,
+                        int width, int height, float nearPlane, float farPlane,
+                        LightClusterData& clusters)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    ClusterGrid& grid = clusters.grid;
+    grid.tilesX = std::max(1, (width + ClusterGrid::TILE_SIZE - 1) / ClusterGrid::TILE_SIZE);
+    grid.tilesY = std::max(1, (height + ClusterGrid::TILE_SIZE - 1) / ClusterGrid::TILE_SIZE);
+    grid.nearPlane = nearPlane;
+    grid.farPlane = farPlane;
+    grid.sliceScale = ClusterGrid::DEPTH_SLICES / std::log(farPlane / nearPlane);
+    grid.sliceBias = -std::log(nearPlane) * grid.sliceScale;
+
+    const size_t clusterCount = grid.clusterCount();
+    clusters.offsetCount.assign(clusterCount * 2, 0);
+    clusters.lightRanges.clear();
+
+    // 第一遍：求每个光源覆盖的簇范围并计数
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 center = glm::vec3(view * glm::vec4(glm::vec3(lights[i].positionRadius), 1.0f));
+        float radius = lights[i].positionRadius.w;
+        float depthMin = -center.z - radius;
+        float depthMax = -center.z + radius;
+        if (depthMax < nearPlane || depthMin > farPlane)
+            continue;
+
+        int x0 = 0, x1 = grid.tilesX - 1, y0 = 0, y1 = grid.tilesY - 1;
+        if (depthMin > nearPlane) {
+            // 包围球完全在近平面之前，投影视空间AABB的8个角点
+            glm::vec2 ndcMin(1e30f), ndcMax(-1e30f);
+            for (int c = 0; c < 8; c++) {
+                glm::vec3 corner = center + radius * glm::vec3(c & 1 ? 1.0f : -1.0f, c & 2 ? 1.0f : -1.0f, c & 4 ? 1.0f : -1.0f);
+                glm::vec4 clip = projection * glm::vec4(corner, 1.0f);
+                glm::vec2 ndc = glm::vec2(clip.x, clip.y) / clip.w;
+                ndcMin = glm::min(ndcMin, ndc);
+                ndcMax = glm::max(ndcMax, ndc);
+            }
+            if (ndcMax.x < -1.0f || ndcMin.x > 1.0f || ndcMax.y < -1.0f || ndcMin.y > 1.0f)
+                continue;
+            x0 = tileIndex(ndcMin.x, width, grid.tilesX);
+            x1 = tileIndex(ndcMax.x, width, grid.tilesX);
+            y0 = tileIndex(ndcMin.y, height, grid.tilesY);
+            y1 = tileIndex(ndcMax.y, height, grid.tilesY);
+        }
+        int z0 = depthSlice(grid, std::max(depthMin, nearPlane));
+        int z1 = depthSlice(grid, std::min(depthMax, farPlane));
+
+        const int32_t range[RANGE_STRIDE] = { static_cast<int32_t>(i), x0, x1, y0, y1, z0, z1 };
+        clusters.lightRanges.insert(clusters.lightRanges.end(), range, range + RANGE_STRIDE);
+
+        for (int z = z0; z <= z1; z++)
+            for (int y = y0; y <= y1; y++)
+                for (int x = x0; x <= x1; x++)
+                    clusters.offsetCount[((size_t(z) * grid.tilesY + y) * grid.tilesX + x) * 2 + 1]++;
+    }
+
+    // 前缀和得到每簇的起始位置
+    uint32_t total = 0;
+    for (size_t c = 0; c < clusterCount; c++) {
+        clusters.offsetCount[c * 2] = total;
+        total += clusters.offsetCount[c * 2 + 1];
+        clusters.offsetCount[c * 2 + 1] = 0;
+    }
+    clusters.lightIndices.resize(total);
+
+    // 第二遍：填充光源下标，同一簇内保持光源顺序
+    for (size_t r = 0; r < clusters.lightRanges.size(); r += RANGE_STRIDE) {
+        const int32_t* range = &clusters.lightRanges[r];
+        for (int z = range[5]; z <= range[6]; z++)
+            for (int y = range[3]; y <= range[4]; y++)
+                for (int x = range[1]; x <= range[2]; x++) {
+                    uint32_t* cluster = &clusters.offsetCount[((size_t(z) * grid.tilesY + y) * grid.tilesX + x) * 2];
+                    clusters.lightIndices[cluster[0] + cluster[1]++] = static_cast<uint32_t>(range[0]);
+                }
+    }
+
+    clusters.visibleLights = clusters.lightRanges.size() / RANGE_STRIDE;
+    clusters.cpuMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void generatePointLights(size_t count, const glm::vec3& center, float spread, unsigned int seed,
+                         std::vector<PointLight>& lights)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    lights.resize(count);
+    for (PointLight& light : lights) {
+        // 球内均匀分布
+        glm::vec3 offset;
+        do {
+            offset = glm::vec3(unit(rng), unit(rng), unit(rng)) * 2.0f - glm::vec3(1.0f);
+        } while (glm::dot(offset, offset) > 1.0f);
+
+        float radius = spread * (0.25f + 0.25f * unit(rng));
+        glm::vec3 color(unit(rng), unit(rng), unit(rng));
+        color /= std::max(color.x, std::max(color.y, std::max(color.z, 1e-3f)));
+
+        light.positionRadius = glm::vec4(center + offset * spread, radius);
+        light.color = glm::vec4(color * 0.6f, 0.0f);
+    }
+}
@@ -6,18 +6,50 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <future>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "shader.h"
 #include "camera.h"
 #include "model.h"
 #include "light.h"
 #include "sphere.h"
+#include "renderer.h"
+#include "light_clusters.h"
 #include "text_renderer.h"
+#include "alloc_counter.h"
+#include "profiler.h"
+#include "shader_watcher.h"
+#include "input_queue.h"
+#include "input_record.h"
+#include "frame_snapshot.h"
+#include "triple_buffer.h"
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
-void processInput(GLFWwindow *window);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+void window_refresh_callback(GLFWwindow* window);
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+void processInput(GLFWwindow *window, const std::vector<InputEvent>& events);
+bool handleCursor(float xpos, float ypos);
+void handleScroll(float yoffset);
+bool holdKeysDown();
+void takeSnapshot(FrameSnapshot& snapshot);
+glm::vec3 randomModelColor();
+void printFrameTimes(const char* label, std::vector<float> milliseconds);
 
 // 窗口设置
 const unsigned int SCR_WIDTH = 800;
@@ -29,11 +61,31 @@ float lastX = SCR_WIDTH / 2.0f;
 float lastY = SCR_HEIGHT / 2.0f;
 bool firstMouse = true;
 
+// 输入事件队列：回调写入带时间戳的事件，每帧开始时按顺序处理
+InputQueue inputQueue;
+
+// 鼠标键状态，随事件按时间顺序更新
+bool leftButtonDown = false;
+bool rightButtonDown = false;
+
+// 回放录制的输入（--replay）时忽略窗口的实时输入
+bool replayingInput = false;
+
 // 光照设置
 Light light;
 
-// 模型
+// 模型，只在绘制端使用；输入端修改下面的模型状态，经快照同步过去
 Model* ourModel = nullptr;
+glm::vec3 modelColor(1.0f);
+bool vertexNormals = true;
+VertexFormat vertexFormat = VertexFormat::Compact;
+
+// 模型随机颜色（C键）的随机序列，种子随录制保存，回放时颜色相同
+std::mt19937 colorGenerator{ std::random_device{}() };
+
+// 帧缓冲大小，随窗口大小变化更新
+int framebufferWidth = SCR_WIDTH;
+int framebufferHeight = SCR_HEIGHT;
 
 // 圆柱体（表示光源）
 Sphere* lightSphere = nullptr;
@@ -48,6 +100,7 @@ enum InteractionMode {
     LIGHT
 };
 InteractionMode currentMode = CAMERA; // 默认为相机模式
+bool shiftDown[2] = { false, false };   // 左、右Shift，按事件顺序更新
 
 // 材质属性
 float shininess = 32.0f;
@@ -57,11 +110,91 @@ bool enableAmbient = true;
 bool enableDiffuse = true;
 bool enableSpecular = true;
 
+// 点光源数量档位（L键切换）与着色方式（K键切换分簇/暴力遍历）
+const size_t POINT_LIGHT_STEPS[] = { 0, 16, 128, 1024 };
+const int POINT_LIGHT_STEP_COUNT = sizeof(POINT_LIGHT_STEPS) / sizeof(POINT_LIGHT_STEPS[0]);
+int pointLightStep = 0;
+LightCulling lightCulling = LightCulling::Clustered;
+
+// 前向/延迟着色（G键切换）
+bool deferredShading = false;
+
+// 按距离选择LOD（O键切换）
+bool enableLod = true;
+
+// 网格簇的视锥剔除（M键切换）和背面剔除（B键切换，模型加载后按是否封闭网格设置初值）
+bool meshletCulling = true;
+bool backfaceCulling = false;
+
+// 按需绘制（R键切换）：场景没有变化时不绘制也不交换缓冲，窗口保持显示上一帧，线程阻塞等待事件
+// 相机、光源、开关、窗口大小和着色器重建都会把sceneDirty置为true；false时每次循环都重绘
+bool onDemandRendering = true;
+bool sceneDirty = true;
+
+// 闲置时等待事件的超时，超时后检查着色器目录等非窗口事件
+const double IDLE_WAIT_SECONDS = 0.25;
+
+// 使用渲染线程时，按住移动键期间输入线程更新场景的间隔
+const double SIMULATION_STEP_SECONDS = 1.0 / 240.0;
+
+// 最早一个尚未呈现的输入事件的时间（glfwGetTime），没有时为负
+double pendingInputTime = -1.0;
+
+// 每种绘制模式的统计：循环经过的时间与进程CPU时间、绘制的帧数、输入到交换缓冲完成的延迟
+struct LoopStats {
+    double seconds = 0.0;
+    double cpuSeconds = 0.0;
+    unsigned long long frames = 0;
+    unsigned long long inputs = 0;
+    double latencySum = 0.0;
+    double latencyMax = 0.0;
+};
+
+// 着色器热重载的编译错误显示在HUD上，最多显示的行数
+const int SHADER_ERROR_LINES = 4;
+
 // 文本渲染器
 TextRenderer* textRenderer = nullptr;
 
-int main()
+// 分段计时器及其叠加层；导出请求（F9）计数后由绘制端执行
+Profiler* profiler = nullptr;
+bool showProfiler = false;
+unsigned int profileExports = 0;
+
+int main(int argc, char** argv)
 {
+    auto startupBegin = std::chrono::steady_clock::now();
+    
+    // 命令行：--record <文件> 录制输入，--replay <文件> [--step <秒>] 以固定时间步长回放，
+    // --render-thread 在单独的渲染线程上绘制
+    std::string recordPath;
+    std::string replayPath;
+    double replayStep = 1.0 / 60.0;
+    bool useRenderThread = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--record" && hasValue)
+            recordPath = argv[++i];
+        else if (arg == "--replay" && hasValue)
+            replayPath = argv[++i];
+        else if (arg == "--step" && hasValue)
+            replayStep = std::max(0.0001, std::atof(argv[++i]));
+        else if (arg == "--render-thread")
+            useRenderThread = true;
+        else {
+            std::cout << "Unknown option: " << arg << std::endl;
+            std::cout << "Usage: illumination_effect [--record file] [--replay file [--step seconds]] [--render-thread]" << std::endl;
+            return -1;
+        }
+    }
+    InputReplay replay;
+    if (!replayPath.empty()) {
+        if (!replay.Open(replayPath))
+            return -1;
+        replayingInput = true;
+    }
+    
     // glfw初始化和配置
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -84,6 +217,10 @@ int main()
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetMouseButtonCallback(window, mouse_button_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
 
     // 保持鼠标指针可见
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
@@ -100,205 +237,792 @@ int main()
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    // 初始化文本渲染器
-    textRenderer = new TextRenderer(SCR_WIDTH, SCR_HEIGHT);
-    textRenderer->Load("fonts/MarkerFelt.ttc", 24);
-
-    // 构建并编译着色器程序
-    Shader modelShader("shaders/model.vs", "shaders/model.fs");
-    Shader sphereShader("shaders/sphere.vs", "shaders/sphere.fs");
-
-    // 加载模型
-    ourModel = new Model("models/eight.uniform.obj");
     
-    // 创建圆柱体（表示光源）
-    lightSphere = new Sphere(0.5f);
+    // 着色器改动后在驱动线程中重新编译，不支持时重建在渲染线程上同步完成
+    if (enableParallelShaderCompile())
+        std::cout << "Shader hot reload: parallel compile enabled" << std::endl;
 
-    // 渲染循环
+    // 异步加载：着色器源码读取、字体光栅化和模型解析（含法线、LOD和簇）在工作线程中进行，
+    // 本线程只做GL上传，加载期间照常处理事件并呈现帧
+    std::future<void> shaderSources = std::async(std::launch::async, []() {
+        std::vector<std::string> files = Renderer::ShaderFiles();
+        files.push_back("shaders/text.vs");
+        files.push_back("shaders/text.fs");
+        preloadShaderSources(files);
+    });
+    std::future<FontAtlas> fontAtlas = std::async(std::launch::async, []() {
+        FontAtlas atlas;
+        rasterizeFontAtlas("fonts/MarkerFelt.ttc", 24, atlas);
+        return atlas;
+    });
+    std::future<Model*> modelLoad = std::async(std::launch::async, []() {
+        return new Model("models/eight.uniform.obj", true, MeshOptimize::VertexCache, VertexFormat::Compact, false);
+    });
+    auto isReady = [](const auto& future) {
+        return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    };
+    
+    // 加载期间的帧：资源就绪一项上传一项，字体就绪后显示加载提示
+    Renderer* renderer = nullptr;
+    bool firstFrameShown = false;
     while (!glfwWindowShouldClose(window))
     {
-        // 计算每帧的时间
+        if (!textRenderer && isReady(shaderSources) && isReady(fontAtlas)) {
+            textRenderer = new TextRenderer(SCR_WIDTH, SCR_HEIGHT);
+            textRenderer->SetAtlas(fontAtlas.get());
+        }
+        if (textRenderer && isReady(modelLoad)) {
+            ourModel = modelLoad.get();
+            ourModel->Upload();
+            
+            // 创建圆柱体（表示光源）
+            lightSphere = new Sphere(0.25f);
+            
+            // 场景渲染器，着色器和每帧uniform块都在其中
+            renderer = new Renderer(*ourModel, *lightSphere);
+            break;
+        }
+        
+        glClearColor(0.f, 0.f, 0.f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        if (textRenderer) {
+            textRenderer->RenderText("Loading model...", 25.0f, SCR_HEIGHT - 25.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+            textRenderer->Flush();
+        }
+        glfwSwapBuffers(window);
+        if (!firstFrameShown) {
+            std::cout << "Time to first frame: "
+                      << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegin).count()
+                      << " ms" << std::endl;
+            firstFrameShown = true;
+        }
+        glfwPollEvents();
+        
+        // 等到下一项资源就绪再画下一帧，最多等一帧的时间，期间窗口仍然响应
+        const auto frameBudget = std::chrono::milliseconds(16);
+        if (textRenderer)
+            modelLoad.wait_for(frameBudget);
+        else if (!isReady(shaderSources))
+            shaderSources.wait_for(frameBudget);
+        else
+            fontAtlas.wait_for(frameBudget);
+    }
+    
+    // 加载完成前关闭了窗口：等工作线程结束后清理
+    if (!renderer) {
+        delete modelLoad.get();
+        delete textRenderer;
+        glfwTerminate();
+        return 0;
+    }
+
+    // 录制和回放从同一初始状态开始：模型颜色及其随机序列；其余场景状态都有固定的初始值
+    modelColor = ourModel->modelColor;
+    backfaceCulling = ourModel->closed;
+    InputRecorder recorder;
+    if (!recordPath.empty()) {
+        InputRecordHeader header;
+        header.colorSeed = std::random_device{}();
+        colorGenerator.seed(header.colorSeed);
+        for (int i = 0; i < 3; i++)
+            header.modelColor[i] = modelColor[i];
+        header.width = framebufferWidth;
+        header.height = framebufferHeight;
+        if (!recorder.Open(recordPath, header))
+            recordPath.clear();
+    }
+    double replayTime = 0.0;
+    if (replayingInput) {
+        const InputRecordHeader& header = replay.Header();
+        colorGenerator.seed(header.colorSeed);
+        modelColor = glm::vec3(header.modelColor[0], header.modelColor[1], header.modelColor[2]);
+        if (framebufferWidth != header.width || framebufferHeight != header.height)
+            std::cout << "Warning: input was recorded at " << header.width << "x" << header.height
+                      << ", replaying at " << framebufferWidth << "x" << framebufferHeight << std::endl;
+        inputQueue.BeginFrame(replayTime);
+        std::cout << "Replaying " << replay.Frames() << " frames from " << replayPath << " with a "
+                  << 1000.0 * replayStep << " ms step" << std::endl;
+    }
+    
+    // 录制或回放时每个绘制帧的耗时（毫秒），从处理输入到交换缓冲完成
+    std::vector<float> runFrameMilliseconds;
+    // 持续重绘时相邻两次交换缓冲的间隔（毫秒），反映帧节奏是否均匀
+    std::vector<float> presentIntervals;
+    double lastPresentTime = -1.0;
+    
+    // uniform调用统计
+    unsigned long long frameCount = 0;
+    unsigned long long totalUniformCalls = 0;
+    unsigned int maxUniformCalls = 0;
+    unsigned long long totalTextDrawCalls = 0;
+    double totalTextMilliseconds = 0.0;
+    
+    // HUD状态文本只在内容变化时重新排版
+    TextHandle ambientText = textRenderer->CreateText();
+    TextHandle diffuseText = textRenderer->CreateText();
+    TextHandle specularText = textRenderer->CreateText();
+    TextHandle pointLightText = textRenderer->CreateText();
+    TextHandle renderPathText = textRenderer->CreateText();
+    TextHandle triangleText = textRenderer->CreateText();
+    TextHandle vertexFormatText = textRenderer->CreateText();
+    TextHandle meshletText = textRenderer->CreateText();
+    TextHandle renderModeText = textRenderer->CreateText();
+    TextHandle latencyText = textRenderer->CreateText();
+    char triangleLabel[64] = "";
+    char vertexFormatLabel[64] = "";
+    char meshletLabel[96] = "";
+    char pointLightLabel[64] = "";
+    char latencyLabel[64] = "Input latency: -";
+    TextHandle shaderErrorText[SHADER_ERROR_LINES];
+    char shaderErrorLabel[SHADER_ERROR_LINES][128] = {};
+    for (TextHandle& handle : shaderErrorText)
+        handle = textRenderer->CreateText();
+    
+    // 空闲帧（HUD没有重新排版）的堆分配与顶点上传统计
+    unsigned long long idleHudFrames = 0;
+    unsigned long long idleHudAllocations = 0;
+    unsigned long long idleHudUploadBytes = 0;
+    
+    // 各绘制阶段的CPU/GPU计时
+    profiler = new Profiler();
+
+    // 绘制端已经应用的点光源档位和导出请求，与快照不同时更新
+    std::vector<PointLight> pointLights;
+    int appliedPointLightStep = 0;
+    unsigned int appliedProfileExports = 0;
+    
+    // 监视shaders目录，保存后的着色器在下一帧开始重建
+    ShaderWatcher shaderWatcher("shaders");
+    
+    // 冷启动（编译着色器并写入程序二进制缓存）与热启动（从缓存加载）的对比
+    const ShaderBuildStats& shaderStats = shaderBuildStats();
+    std::cout << "Shaders: " << shaderStats.programs << " programs in " << shaderStats.milliseconds << " ms ("
+              << shaderStats.cacheHits << " from binary cache)" << std::endl;
+    bool fullyLoadedShown = false;
+    
+    // 按需绘制与持续重绘各自的统计
+    LoopStats loopStats[2];
+    // 最近若干次输入的延迟，显示在HUD上，负载下的卡顿可以直接看到
+    const int LATENCY_HISTORY = 64;
+    double latencyHistory[LATENCY_HISTORY] = {};
+    int latencySamples = 0;
+    double lastPresentedInput = -1.0;
+    double loopTime = glfwGetTime();
+    std::clock_t loopClock = std::clock();
+    
+    // 已呈现的最新快照序号，渲染线程写入，输入线程据此判断输入是否已经显示
+    std::atomic<unsigned long long> presentedSequence(0);
+    // 回放时输入线程在此等待渲染线程呈现每一步的快照
+    std::mutex presentMutex;
+    std::condition_variable presented;
+    
+    // 把循环经过的时间和进程CPU时间计入当前模式
+    auto accountTime = [&](LoopStats& stats) {
+        double now = glfwGetTime();
+        std::clock_t clock = std::clock();
+        stats.seconds += now - loopTime;
+        stats.cpuSeconds += double(clock - loopClock) / CLOCKS_PER_SEC;
+        loopTime = now;
+        loopClock = clock;
+    };
+    
+    // 模拟一步：取出本帧的输入（回放时取录制的下一帧，时间轴按固定步长推进）更新相机、光源和开关
+    // 录制时写入文件；回放结束时返回false
+    auto simulate = [&]() {
         float currentFrame = static_cast<float>(glfwGetTime());
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
-
-        // 处理输入
-        processInput(window);
+        
+        double inputTime = glfwGetTime();
+        if (replayingInput) {
+            float recordedDelta;
+            if (!replay.NextFrame(inputQueue, replayTime, replayStep, recordedDelta))
+                return false;
+            replayTime += replayStep;
+            inputTime = replayTime;
+            deltaTime = static_cast<float>(replayStep);
+        }
+        const std::vector<InputEvent>& inputEvents = inputQueue.BeginFrame(inputTime);
+        processInput(window, inputEvents);
+        if (replayingInput) {
+            // 回放的事件时间不在真实时间轴上，不统计延迟；每一步都绘制
+            pendingInputTime = -1.0;
+            sceneDirty = true;
+        }
+        
+        // 会绘制的循环都写入录制，按需绘制时闲置的循环不写
+        if (!recordPath.empty() && (!inputEvents.empty() || sceneDirty || !onDemandRendering))
+            recorder.WriteFrame(deltaTime, inputQueue.FrameStart(), inputTime, inputEvents);
+        return true;
+    };
+    
+    // 着色器热重载：改动的文件开始重建，已完成的换上新程序；失败时保留旧程序，错误显示在HUD上
+    // 返回是否需要重绘
+    auto updateShaders = [&]() {
+        bool redraw = false;
+        std::vector<std::string> changedShaders = shaderWatcher.TakeChanged();
+        if (!changedShaders.empty())
+            renderer->ReloadShaders(changedShaders);
+        if (renderer->UpdateShaderReloads()) {
+            std::istringstream errors(renderer->GetShaderErrors());
+            std::string line;
+            for (int i = 0; i < SHADER_ERROR_LINES; i++) {
+                if (!std::getline(errors, line))
+                    line.clear();
+                std::snprintf(shaderErrorLabel[i], sizeof(shaderErrorLabel[i]), "%s", line.c_str());
+            }
+            redraw = true;
+        }
+        return redraw || renderer->ShaderReloadsPending();
+    };
+    
+    // 绘制一帧快照并交换缓冲，所有GL调用都在这里；frameBegin为本帧开始处理的时间
+    auto renderFrame = [&](const FrameSnapshot& snapshot, LoopStats& modeStats, std::chrono::steady_clock::time_point frameBegin) {
+        profiler->BeginFrame();
+        
+        // 快照中的模型状态同步到绘制端持有的对象，切换顶点格式会重新上传
+        ourModel->modelColor = snapshot.modelColor;
+        ourModel->useVertexNormal = snapshot.vertexNormals;
+        if (ourModel->GetVertexFormat() != snapshot.vertexFormat)
+            ourModel->SetVertexFormat(snapshot.vertexFormat);
+        
+        // 导出计时数据
+        if (snapshot.profileExports != appliedProfileExports) {
+            appliedProfileExports = snapshot.profileExports;
+            if (profiler->ExportCSV("profile.csv") && profiler->ExportChromeTrace("profile.json"))
+                std::cout << "Profile exported to profile.csv and profile.json" << std::endl;
+        }
 
         // 渲染
+        glViewport(0, 0, snapshot.framebufferWidth, snapshot.framebufferHeight);
         glClearColor(0.f, 0.f, 0.f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // 视图/投影变换 - 用于所有着色器
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        glm::mat4 view = camera.GetViewMatrix();
+        Shader::uniformCalls = 0;
+        
+        // 点光源数量变化时重新生成，分布在模型周围
+        if (snapshot.pointLightStep != appliedPointLightStep) {
+            appliedPointLightStep = snapshot.pointLightStep;
+            generatePointLights(POINT_LIGHT_STEPS[appliedPointLightStep], glm::vec3(0.0f), 2.5f, 1, pointLights);
+            renderer->SetPointLights(pointLights.data(), pointLights.size());
+        }
+        
+        // 绘制主模型和光源球体，分簇按帧缓冲的实际像素划分
+        const RenderSettings& settings = snapshot.settings;
+        renderer->Render(snapshot.camera, snapshot.light, settings, snapshot.framebufferWidth, snapshot.framebufferHeight, profiler);
 
-        // 1. 首先渲染主模型
-        modelShader.use();
+        // 更新状态文本，未变化时不分配内存也不上传
+        profiler->Begin("Text");
+        size_t allocationsBefore = allocationCount();
+        
+        textRenderer->SetText(ambientText, settings.enableAmbient ? "Ambient: ON" : "Ambient: OFF", 25.0f, SCR_HEIGHT - 25.0f, 0.5f, 
+                              glm::vec3(settings.enableAmbient ? 0.0f : 1.0f, settings.enableAmbient ? 1.0f : 0.0f, 0.0f));
+        textRenderer->SetText(diffuseText, settings.enableDiffuse ? "Diffuse: ON" : "Diffuse: OFF", 25.0f, SCR_HEIGHT - 50.0f, 0.5f, 
+                              glm::vec3(settings.enableDiffuse ? 0.0f : 1.0f, settings.enableDiffuse ? 1.0f : 0.0f, 0.0f));
+        textRenderer->SetText(specularText, settings.enableSpecular ? "Specular: ON" : "Specular: OFF", 25.0f, SCR_HEIGHT - 75.0f, 0.5f, 
+                              glm::vec3(settings.enableSpecular ? 0.0f : 1.0f, settings.enableSpecular ? 1.0f : 0.0f, 0.0f));
+        
+        if (pointLights.empty())
+            pointLightLabel[0] = '\0';
+        else
+            std::snprintf(pointLightLabel, sizeof(pointLightLabel), "Point lights: %zu (%s)", pointLights.size(),
+                          settings.lightCulling == LightCulling::Clustered ? "clustered" : "brute force");
+        textRenderer->SetText(pointLightText, pointLightLabel, 25.0f, SCR_HEIGHT - 100.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+        textRenderer->SetText(renderPathText, settings.deferred ? "Deferred shading" : "Forward shading", 25.0f, SCR_HEIGHT - 125.0f, 0.5f,
+                              glm::vec3(1.0f, 1.0f, 0.0f));
         
-        // 设置着色器uniform
-        modelShader.setVec3("viewPos", camera.Position);
-        modelShader.setFloat("shininess", shininess);
-        modelShader.setMat4("projection", projection);
-        modelShader.setMat4("view", view);
+        const RenderStats& renderStats = renderer->GetStats();
+        std::snprintf(triangleLabel, sizeof(triangleLabel), "Triangles: %zu (LOD %zu%s)", renderStats.triangles,
+                      renderStats.lodLevel, settings.lod ? "" : ", off");
+        textRenderer->SetText(triangleText, triangleLabel, 25.0f, SCR_HEIGHT - 150.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+        std::snprintf(vertexFormatLabel, sizeof(vertexFormatLabel), "Vertices: %s (%zu KB, %d-bit indices)",
+                      ourModel->GetVertexFormat() == VertexFormat::Compact ? "compact" : "float",
+                      (ourModel->vertexBufferBytes + ourModel->indexBufferBytes) / 1024,
+                      ourModel->GetIndexType() == GL_UNSIGNED_SHORT ? 16 : 32);
+        textRenderer->SetText(vertexFormatText, vertexFormatLabel, 25.0f, SCR_HEIGHT - 175.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+        if (settings.meshletCulling)
+            std::snprintf(meshletLabel, sizeof(meshletLabel), "Meshlets: %zu/%zu visible (%zu ranges, backface %s)",
+                          renderStats.meshlets - renderStats.frustumCulled - renderStats.backfaceCulled,
+                          renderStats.meshlets, renderStats.drawRanges, settings.backfaceCulling ? "on" : "off");
+        else
+            std::snprintf(meshletLabel, sizeof(meshletLabel), "Meshlets: culling off");
+        textRenderer->SetText(meshletText, meshletLabel, 25.0f, SCR_HEIGHT - 200.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+        const char* renderModeLabel = snapshot.onDemand ? (useRenderThread ? "Rendering: on demand, render thread" : "Rendering: on demand")
+                                                        : (useRenderThread ? "Rendering: continuous, render thread" : "Rendering: continuous");
+        textRenderer->SetText(renderModeText, renderModeLabel, 25.0f, SCR_HEIGHT - 225.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+        textRenderer->SetText(latencyText, latencyLabel, 25.0f, SCR_HEIGHT - 250.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+        for (int i = 0; i < SHADER_ERROR_LINES; i++)
+            textRenderer->SetText(shaderErrorText[i], shaderErrorLabel[i], 25.0f, SCR_HEIGHT - 275.0f - 20.0f * i, 0.4f,
+                                  glm::vec3(1.0f, 0.2f, 0.2f));
         
-        // 设置光照组件开关
-        modelShader.setBool("enableAmbient", enableAmbient);
-        modelShader.setBool("enableDiffuse", enableDiffuse);
-        modelShader.setBool("enableSpecular", enableSpecular);
+        // 计时叠加层
+        profiler->DrawOverlay(*textRenderer, 25.0f, 20.0f, snapshot.showProfiler);
+        
+        // 本帧全部文本一次绘制
+        textRenderer->Flush();
+        profiler->End();
+        
+        const TextStats& textStats = textRenderer->GetStats();
+        if (textStats.layouts == 0) {
+            idleHudFrames++;
+            idleHudAllocations += allocationCount() - allocationsBefore;
+            idleHudUploadBytes += textStats.uploadBytes;
+        }
 
-        // 世界变换
-        glm::mat4 model = glm::mat4(1.0f);
-        modelShader.setMat4("model", model);
+        frameCount++;
+        totalUniformCalls += Shader::uniformCalls;
+        maxUniformCalls = std::max(maxUniformCalls, Shader::uniformCalls);
+        totalTextDrawCalls += textRenderer->GetStats().drawCalls;
+        totalTextMilliseconds += textRenderer->GetStats().cpuMilliseconds;
 
-        // 设置光照属性
-        light.setUniforms(modelShader);
+        profiler->EndFrame();
 
-        // 渲染模型
-        ourModel->Draw(modelShader);
+        // 交换缓冲
+        glfwSwapBuffers(window);
+        if (!fullyLoadedShown) {
+            if (!firstFrameShown)
+                std::cout << "Time to first frame: "
+                          << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegin).count()
+                          << " ms" << std::endl;
+            std::cout << "Time to fully loaded: "
+                      << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegin).count()
+                      << " ms" << std::endl;
+            fullyLoadedShown = true;
+        }
         
-        // 2. 然后渲染表示光源的圆柱体
-        sphereShader.use();
-        sphereShader.setMat4("projection", projection);
-        sphereShader.setMat4("view", view);
-        sphereShader.setVec3("viewPos", camera.Position);
+        if (replayingInput || !recordPath.empty())
+            runFrameMilliseconds.push_back(
+                std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameBegin).count());
         
-        // 绘制圆柱体
-        lightSphere->Draw(sphereShader, light.position, light.intensity);
+        double now = glfwGetTime();
+        if (!snapshot.onDemand && lastPresentTime >= 0.0)
+            presentIntervals.push_back(static_cast<float>(1000.0 * (now - lastPresentTime)));
+        lastPresentTime = snapshot.onDemand ? -1.0 : now;
+        
+        // 输入到画面的延迟：从最早一个输入事件到包含它的帧交换完成
+        // 同一快照可能被重复绘制（持续重绘时），每个输入只统计第一次
+        if (snapshot.inputTime >= 0.0 && snapshot.inputTime != lastPresentedInput) {
+            double latency = now - snapshot.inputTime;
+            lastPresentedInput = snapshot.inputTime;
+            modeStats.inputs++;
+            modeStats.latencySum += latency;
+            modeStats.latencyMax = std::max(modeStats.latencyMax, latency);
+            
+            // 延迟在下一帧显示
+            latencyHistory[latencySamples % LATENCY_HISTORY] = latency;
+            latencySamples++;
+            int count = std::min(latencySamples, LATENCY_HISTORY);
+            double sum = 0.0, maxLatency = 0.0;
+            for (int i = 0; i < count; i++) {
+                sum += latencyHistory[i];
+                maxLatency = std::max(maxLatency, latencyHistory[i]);
+            }
+            std::snprintf(latencyLabel, sizeof(latencyLabel), "Input latency: %.1f ms avg, %.1f ms max (last %d)",
+                          1000.0 * sum / count, 1000.0 * maxLatency, count);
+        }
+        {
+            std::lock_guard<std::mutex> lock(presentMutex);
+            presentedSequence.store(snapshot.sequence, std::memory_order_release);
+        }
+        presented.notify_all();
+        modeStats.frames++;
+        accountTime(modeStats);
+    };
 
-        // 渲染状态文本
-        std::string ambientStatus = "Ambient: " + std::string(enableAmbient ? "ON" : "OFF");
-        std::string diffuseStatus = "Diffuse: " + std::string(enableDiffuse ? "ON" : "OFF");
-        std::string specularStatus = "Specular: " + std::string(enableSpecular ? "ON" : "OFF");
+    if (!useRenderThread) {
+        // 单线程：每次循环处理输入、生成快照并立即绘制
+        unsigned long long sequence = 0;
+        while (!glfwWindowShouldClose(window))
+        {
+            auto frameBegin = std::chrono::steady_clock::now();
+            if (!simulate())
+                break;
+            if (updateShaders())
+                sceneDirty = true;
+            
+            LoopStats& modeStats = loopStats[onDemandRendering ? 0 : 1];
+            if (onDemandRendering && !sceneDirty) {
+                // 没有可见的变化：丢弃不产生画面的输入，阻塞到下一个事件或超时
+                pendingInputTime = -1.0;
+                glfwWaitEventsTimeout(IDLE_WAIT_SECONDS);
+                
+                // 闲置的时间不计入下一帧的deltaTime
+                lastFrame = static_cast<float>(glfwGetTime());
+                accountTime(modeStats);
+                continue;
+            }
+            sceneDirty = false;
+            
+            FrameSnapshot snapshot;
+            takeSnapshot(snapshot);
+            snapshot.sequence = ++sequence;
+            pendingInputTime = -1.0;
+            renderFrame(snapshot, modeStats, frameBegin);
+            
+            // 查询IO事件
+            glfwPollEvents();
+        }
+    } else {
+        // 输入线程（主线程，GLFW要求事件在此处理）只更新场景并发布快照；
+        // 渲染线程持有GL上下文，每帧取最新的快照绘制，交换缓冲的阻塞不再推迟输入处理
+        TripleBuffer<FrameSnapshot> snapshots;
+        std::atomic<bool> rendering(true);
+        std::mutex wakeMutex;
+        std::condition_variable wake;
+        bool wakePending = false;
         
-        textRenderer->RenderText(ambientStatus, 25.0f, SCR_HEIGHT - 25.0f, 0.5f, 
-                               glm::vec3(enableAmbient ? 0.0f : 1.0f, enableAmbient ? 1.0f : 0.0f, 0.0f));
-        textRenderer->RenderText(diffuseStatus, 25.0f, SCR_HEIGHT - 50.0f, 0.5f, 
-                               glm::vec3(enableDiffuse ? 0.0f : 1.0f, enableDiffuse ? 1.0f : 0.0f, 0.0f));
-        textRenderer->RenderText(specularStatus, 25.0f, SCR_HEIGHT - 75.0f, 0.5f, 
-                               glm::vec3(enableSpecular ? 0.0f : 1.0f, enableSpecular ? 1.0f : 0.0f, 0.0f));
-
-        // 交换缓冲并查询IO事件
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        glfwMakeContextCurrent(nullptr);
+        std::thread renderThread([&]() {
+            glfwMakeContextCurrent(window);
+            bool haveSnapshot = false;
+            while (rendering.load()) {
+                auto frameBegin = std::chrono::steady_clock::now();
+                bool fresh = snapshots.Acquire();
+                haveSnapshot = haveSnapshot || fresh;
+                bool redraw = updateShaders();
+                
+                // 按需绘制时没有新快照也没有重建的着色器就等待，持续重绘时重复绘制最新的快照
+                // 回放时每个快照只绘制一次，回放帧时间与单线程时一样逐步对应
+                const FrameSnapshot& snapshot = snapshots.ReadBuffer();
+                LoopStats& modeStats = loopStats[snapshot.onDemand ? 0 : 1];
+                bool idle = replayingInput ? !fresh : snapshot.onDemand && !fresh && !redraw;
+                if (!haveSnapshot || idle) {
+                    std::unique_lock<std::mutex> lock(wakeMutex);
+                    wake.wait_for(lock, std::chrono::duration<double>(IDLE_WAIT_SECONDS),
+                                  [&]() { return wakePending || !rendering.load(); });
+                    wakePending = false;
+                    lock.unlock();
+                    accountTime(modeStats);
+                    continue;
+                }
+                renderFrame(snapshot, modeStats, frameBegin);
+            }
+            glfwMakeContextCurrent(nullptr);
+        });
+        
+        unsigned long long sequence = 0;
+        unsigned long long pendingSequence = 0;     // 第一个带有pendingInputTime的快照
+        sceneDirty = true;
+        while (!glfwWindowShouldClose(window))
+        {
+            // 已呈现的输入不再计入之后的快照
+            if (pendingInputTime >= 0.0 && pendingSequence > 0 &&
+                presentedSequence.load(std::memory_order_acquire) >= pendingSequence) {
+                pendingInputTime = -1.0;
+                pendingSequence = 0;
+            }
+            if (!simulate())
+                break;
+            
+            if (sceneDirty) {
+                FrameSnapshot& snapshot = snapshots.WriteBuffer();
+                takeSnapshot(snapshot);
+                snapshot.sequence = ++sequence;
+                if (pendingInputTime >= 0.0 && pendingSequence == 0)
+                    pendingSequence = sequence;
+                snapshots.Publish();
+                {
+                    std::lock_guard<std::mutex> lock(wakeMutex);
+                    wakePending = true;
+                }
+                wake.notify_one();
+                sceneDirty = false;
+            }
+            
+            if (replayingInput) {
+                // 回放时与渲染线程逐步同步：这一步的快照呈现之后才模拟下一步，每一步恰好绘制一次，
+                // 步进不受窗口事件打断；等待期间照常处理窗口事件
+                while (presentedSequence.load(std::memory_order_acquire) < sequence && !glfwWindowShouldClose(window)) {
+                    {
+                        std::unique_lock<std::mutex> lock(presentMutex);
+                        presented.wait_for(lock, std::chrono::duration<double>(IDLE_WAIT_SECONDS), [&]() {
+                            return presentedSequence.load(std::memory_order_acquire) >= sequence;
+                        });
+                    }
+                    glfwPollEvents();
+                }
+                glfwPollEvents();
+            } else {
+                // 等待下一个事件；按住按键时按固定步长继续更新
+                glfwWaitEventsTimeout(holdKeysDown() ? SIMULATION_STEP_SECONDS : IDLE_WAIT_SECONDS);
+            }
+        }
+        
+        rendering.store(false);
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            wakePending = true;
+        }
+        wake.notify_one();
+        renderThread.join();
+        glfwMakeContextCurrent(window);
+    }
+    
+    if (frameCount > 0) {
+        std::cout << "GL uniform calls per frame: avg " << double(totalUniformCalls) / frameCount
+                  << ", max " << maxUniformCalls
+                  << "; frame uniform block uploads per frame: " << double(renderer->frameUniforms.uploads) / frameCount << std::endl;
+        std::cout << "Text draw calls per frame: " << double(totalTextDrawCalls) / frameCount
+                  << ", text CPU time per frame: " << totalTextMilliseconds / frameCount << " ms" << std::endl;
+        std::cout << "Idle HUD frames: " << idleHudFrames << ", heap allocations: " << idleHudAllocations
+                  << ", vertex upload bytes: " << idleHudUploadBytes << std::endl;
+        
+        // 最近若干帧的分段计时
+        profiler->Summarize();
+        const ProfileStats& frameStats = profiler->GetFrameStats();
+        std::cout << "Frame CPU ms min/avg/p99: " << frameStats.min << "/" << frameStats.avg << "/" << frameStats.p99 << std::endl;
+        for (const PassSummary& pass : profiler->GetSummary()) {
+            std::cout << "  " << pass.name << ": CPU " << pass.cpu.min << "/" << pass.cpu.avg << "/" << pass.cpu.p99;
+            if (pass.gpu.samples > 0)
+                std::cout << ", GPU " << pass.gpu.min << "/" << pass.gpu.avg << "/" << pass.gpu.p99;
+            std::cout << std::endl;
+        }
+        if (profiler->GetDroppedFrames() > 0)
+            std::cout << "  GPU results not ready in time for " << profiler->GetDroppedFrames() << " frames" << std::endl;
+        
+        // 两种绘制模式的占用对比；GPU占用按每帧平均GPU时间乘以帧率估算
+        float gpuFrameMilliseconds = 0.0f;
+        for (const PassSummary& pass : profiler->GetSummary())
+            gpuFrameMilliseconds += pass.gpu.avg;
+        const char* modeNames[2] = { "On-demand", "Continuous" };
+        for (int mode = 0; mode < 2; mode++) {
+            const LoopStats& stats = loopStats[mode];
+            if (stats.seconds <= 0.0)
+                continue;
+            double fps = stats.frames / stats.seconds;
+            std::cout << modeNames[mode] << " rendering: " << stats.frames << " frames in " << stats.seconds << " s ("
+                      << fps << " fps), CPU " << 100.0 * stats.cpuSeconds / stats.seconds << "% of a core, GPU ~"
+                      << 100.0 * fps * gpuFrameMilliseconds / 1000.0 << "%";
+            if (stats.inputs > 0)
+                std::cout << ", input-to-present latency avg " << 1000.0 * stats.latencySum / stats.inputs
+                          << " ms, max " << 1000.0 * stats.latencyMax << " ms over " << stats.inputs << " inputs";
+            std::cout << std::endl;
+        }
+    }
+
+    // 同一段录制在不同构建上回放，比较这两行即可
+    if (!recordPath.empty()) {
+        std::cout << "Recorded " << recorder.Frames() << " frames, " << recorder.Events() << " input events to "
+                  << recordPath << std::endl;
+        printFrameTimes("Recording frame time", runFrameMilliseconds);
+    }
+    if (replayingInput) {
+        printFrameTimes("Recorded deltaTime", replay.RecordedFrameMilliseconds());
+        printFrameTimes("Replay frame time", runFrameMilliseconds);
     }
+    printFrameTimes(useRenderThread ? "Present interval (continuous, render thread)" : "Present interval (continuous)",
+                    presentIntervals);
 
     // 清理
+    delete renderer;
     delete ourModel;
     delete lightSphere;
     delete textRenderer;
+    delete profiler;
     
     glfwTerminate();
     return 0;
 }
 
-// 处理输入
-void processInput(GLFWwindow *window)
+// 按一次触发一次的动作，按住时的自动重复不会再次触发
+struct KeyAction {
+    int key;
+    void (*run)(GLFWwindow* window);
+};
+
+const KeyAction KEY_ACTIONS[] = {
+    { GLFW_KEY_ESCAPE, [](GLFWwindow* window) { glfwSetWindowShouldClose(window, true); } },
+    // 切换法线模式
+    { GLFW_KEY_N, [](GLFWwindow*) { vertexNormals = !vertexNormals; } },
+    // 随机改变颜色
+    { GLFW_KEY_C, [](GLFWwindow*) { modelColor = randomModelColor(); } },
+    // 切换点光源数量
+    { GLFW_KEY_L, [](GLFWwindow*) {
+        pointLightStep = (pointLightStep + 1) % POINT_LIGHT_STEP_COUNT;
+    } },
+    // 切换点光源的分簇/暴力遍历
+    { GLFW_KEY_K, [](GLFWwindow*) {
+        lightCulling = lightCulling == LightCulling::Clustered ? LightCulling::BruteForce : LightCulling::Clustered;
+    } },
+    // 切换前向/延迟着色
+    { GLFW_KEY_G, [](GLFWwindow*) { deferredShading = !deferredShading; } },
+    // 开启/关闭LOD
+    { GLFW_KEY_O, [](GLFWwindow*) { enableLod = !enableLod; } },
+    // 开启/关闭网格簇剔除
+    { GLFW_KEY_M, [](GLFWwindow*) { meshletCulling = !meshletCulling; } },
+    // 开启/关闭簇的背面剔除
+    { GLFW_KEY_B, [](GLFWwindow*) { backfaceCulling = !backfaceCulling; } },
+    // 切换紧凑/float顶点格式
+    { GLFW_KEY_V, [](GLFWwindow*) {
+        vertexFormat = vertexFormat == VertexFormat::Compact ? VertexFormat::Float : VertexFormat::Compact;
+    } },
+    // 切换按需绘制/持续重绘
+    { GLFW_KEY_R, [](GLFWwindow*) { onDemandRendering = !onDemandRendering; } },
+    // 显示/隐藏计时叠加层
+    { GLFW_KEY_P, [](GLFWwindow*) { showProfiler = !showProfiler; } },
+    // 导出计时数据
+    { GLFW_KEY_F9, [](GLFWwindow*) { profileExports++; } },
+    // 开关环境光
+    { GLFW_KEY_1, [](GLFWwindow*) {
+        enableAmbient = !enableAmbient;
+        std::cout << "环境光: " << (enableAmbient ? "开启" : "关闭") << std::endl;
+    } },
+    // 开关漫反射
+    { GLFW_KEY_2, [](GLFWwindow*) {
+        enableDiffuse = !enableDiffuse;
+        std::cout << "漫反射: " << (enableDiffuse ? "开启" : "关闭") << std::endl;
+    } },
+    // 开关镜面反射
+    { GLFW_KEY_3, [](GLFWwindow*) {
+        enableSpecular = !enableSpecular;
+        std::cout << "镜面反射: " << (enableSpecular ? "开启" : "关闭") << std::endl;
+    } },
+};
+
+// 按住时持续移动光源的按键及方向，位移 = 速度 x 本帧内按住的时长
+struct LightMoveKey {
+    int key;
+    glm::vec3 direction;
+};
+
+const LightMoveKey LIGHT_MOVE_KEYS[] = {
+    { GLFW_KEY_W, glm::vec3(0.0f, 0.0f, -1.0f) },
+    { GLFW_KEY_S, glm::vec3(0.0f, 0.0f, 1.0f) },
+    { GLFW_KEY_A, glm::vec3(-1.0f, 0.0f, 0.0f) },
+    { GLFW_KEY_D, glm::vec3(1.0f, 0.0f, 0.0f) },
+    { GLFW_KEY_Q, glm::vec3(0.0f, 1.0f, 0.0f) },
+    { GLFW_KEY_E, glm::vec3(0.0f, -1.0f, 0.0f) },
+};
+const float LIGHT_MOVE_SPEED = 2.0f;
+
+// 上/下箭头每秒改变的光泽度（相当于原先60 fps下每帧改变1）
+const float SHININESS_RATE = 60.0f;
+
+// 按下时开始持续动作的按键
+bool isHoldKey(int key)
 {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
-    
-    // 检测Shift键状态，按下时切换到CAMERA模式，松开时切换回LIGHT模式
-    if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS || 
-        glfwGetKey(window, GLFW_KEY_RIGHT_SHIFT) == GLFW_PRESS) {
-        currentMode = LIGHT;
-    } else {
-        currentMode = CAMERA;
+    for (const LightMoveKey& binding : LIGHT_MOVE_KEYS) {
+        if (binding.key == key)
+            return true;
     }
-    
-    // 光源移动
-    float speed = 2.0f * deltaTime;
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-        light.move(glm::vec3(0.0f, 0.0f, -speed));
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-        light.move(glm::vec3(0.0f, 0.0f, speed));
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-        light.move(glm::vec3(-speed, 0.0f, 0.0f));
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-        light.move(glm::vec3(speed, 0.0f, 0.0f));
-    if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
-        light.move(glm::vec3(0.0f, speed, 0.0f));
-    if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
-        light.move(glm::vec3(0.0f, -speed, 0.0f));
+    return key == GLFW_KEY_UP || key == GLFW_KEY_DOWN;
+}
 
-    // 切换法线模式
-    if (glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS) {
-        static float lastNormalToggle = 0.0f;
-        float currentTime = static_cast<float>(glfwGetTime());
-        
-        if (currentTime - lastNormalToggle > 0.2f) {
-            ourModel->toggleNormalMode();
-            lastNormalToggle = currentTime;
+// 处理输入：按时间顺序处理本帧取出的事件，再按事件时间戳积分按住类动作
+void processInput(GLFWwindow *window, const std::vector<InputEvent>& events)
+{
+    for (const InputEvent& event : events) {
+        bool changed = false;
+        switch (event.type) {
+        case InputEvent::Key:
+            // 任一Shift按住时控制光源，两个都松开才回到相机
+            if (event.code == GLFW_KEY_LEFT_SHIFT || event.code == GLFW_KEY_RIGHT_SHIFT) {
+                shiftDown[event.code == GLFW_KEY_RIGHT_SHIFT] = event.action != GLFW_RELEASE;
+                currentMode = shiftDown[0] || shiftDown[1] ? LIGHT : CAMERA;
+            }
+            if (event.action != GLFW_PRESS)
+                break;
+            for (const KeyAction& action : KEY_ACTIONS) {
+                if (action.key == event.code) {
+                    action.run(window);
+                    changed = true;
+                }
+            }
+            changed |= isHoldKey(event.code);
+            break;
+        case InputEvent::MouseButton:
+            if (event.code == GLFW_MOUSE_BUTTON_LEFT)
+                leftButtonDown = event.action == GLFW_PRESS;
+            else if (event.code == GLFW_MOUSE_BUTTON_RIGHT)
+                rightButtonDown = event.action == GLFW_PRESS;
+            break;
+        case InputEvent::CursorPos:
+            changed = handleCursor(static_cast<float>(event.x), static_cast<float>(event.y));
+            break;
+        case InputEvent::Scroll:
+            handleScroll(static_cast<float>(event.y));
+            changed = true;
+            break;
         }
-    }
-    
-    // 随机改变颜色
-    if (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS) {
-        static float lastColorChange = 0.0f;
-        float currentTime = static_cast<float>(glfwGetTime());
         
-        if (currentTime - lastColorChange > 0.2f) {
-            ourModel->randomColor();
-            lastColorChange = currentTime;
+        // 产生变化的事件中最早的一个用于统计输入到画面的延迟
+        if (changed) {
+            sceneDirty = true;
+            if (pendingInputTime < 0.0 || event.time < pendingInputTime)
+                pendingInputTime = event.time;
         }
     }
     
-    // 更改材质光泽度
-    if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
-        shininess = std::min(shininess + 1.0f, 128.0f);
-    if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
-        shininess = std::max(shininess - 1.0f, 1.0f);
-        
-    // 开关环境光（按键1）
-    if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS) {
-        static float lastKeyPress = 0.0f;
-        float currentTime = static_cast<float>(glfwGetTime());
-        
-        if (currentTime - lastKeyPress > 0.2f) {
-            enableAmbient = !enableAmbient;
-            std::cout << "环境光: " << (enableAmbient ? "开启" : "关闭") << std::endl;
-            lastKeyPress = currentTime;
-        }
+    // 光源移动
+    glm::vec3 lightOffset(0.0f);
+    for (const LightMoveKey& binding : LIGHT_MOVE_KEYS)
+        lightOffset += binding.direction * (LIGHT_MOVE_SPEED * static_cast<float>(inputQueue.HeldSeconds(binding.key)));
+    if (lightOffset != glm::vec3(0.0f)) {
+        light.move(lightOffset);
+        sceneDirty = true;
     }
     
-    // 开关漫反射（按键2）
-    if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS) {
-        static float lastKeyPress = 0.0f;
-        float currentTime = static_cast<float>(glfwGetTime());
-        
-        if (currentTime - lastKeyPress > 0.2f) {
-            enableDiffuse = !enableDiffuse;
-            std::cout << "漫反射: " << (enableDiffuse ? "开启" : "关闭") << std::endl;
-            lastKeyPress = currentTime;
-        }
+    // 更改材质光泽度
+    float shininessDelta = SHININESS_RATE * static_cast<float>(inputQueue.HeldSeconds(GLFW_KEY_UP) - inputQueue.HeldSeconds(GLFW_KEY_DOWN));
+    float newShininess = std::min(std::max(shininess + shininessDelta, 1.0f), 128.0f);
+    if (newShininess != shininess) {
+        shininess = newShininess;
+        sceneDirty = true;
     }
     
-    // 开关镜面反射（按键3）
-    if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS) {
-        static float lastKeyPress = 0.0f;
-        float currentTime = static_cast<float>(glfwGetTime());
-        
-        if (currentTime - lastKeyPress > 0.2f) {
-            enableSpecular = !enableSpecular;
-            std::cout << "镜面反射: " << (enableSpecular ? "开启" : "关闭") << std::endl;
-            lastKeyPress = currentTime;
-        }
+    // 仍按住的键在下一帧继续起作用
+    if (holdKeysDown())
+        sceneDirty = true;
+}
+
+// 是否有按住类的按键仍处于按下状态
+bool holdKeysDown()
+{
+    for (const LightMoveKey& binding : LIGHT_MOVE_KEYS) {
+        if (inputQueue.IsDown(binding.key))
+            return true;
     }
+    return inputQueue.IsDown(GLFW_KEY_UP) || inputQueue.IsDown(GLFW_KEY_DOWN);
 }
 
-// 窗口大小改变时的回调函数
-void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+// 把当前的场景状态复制到快照中（序号由发布方填写）
+void takeSnapshot(FrameSnapshot& snapshot)
 {
-    glViewport(0, 0, width, height);
+    snapshot.camera = camera;
+    snapshot.light = light;
+    snapshot.settings.shininess = shininess;
+    snapshot.settings.enableAmbient = enableAmbient;
+    snapshot.settings.enableDiffuse = enableDiffuse;
+    snapshot.settings.enableSpecular = enableSpecular;
+    snapshot.settings.lightCulling = lightCulling;
+    snapshot.settings.deferred = deferredShading;
+    snapshot.settings.lod = enableLod;
+    snapshot.settings.meshletCulling = meshletCulling;
+    snapshot.settings.backfaceCulling = backfaceCulling;
+    snapshot.modelColor = modelColor;
+    snapshot.vertexNormals = vertexNormals;
+    snapshot.vertexFormat = vertexFormat;
+    snapshot.pointLightStep = pointLightStep;
+    snapshot.onDemand = onDemandRendering;
+    snapshot.showProfiler = showProfiler;
+    snapshot.profileExports = profileExports;
+    snapshot.framebufferWidth = std::max(framebufferWidth, 1);
+    snapshot.framebufferHeight = std::max(framebufferHeight, 1);
+    snapshot.inputTime = pendingInputTime;
 }
 
-// 鼠标移动回调
-void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+glm::vec3 randomModelColor()
 {
-    float xpos = static_cast<float>(xposIn);
-    float ypos = static_cast<float>(yposIn);
+    std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+    float r = dis(colorGenerator);
+    float g = dis(colorGenerator);
+    float b = dis(colorGenerator);
+    return glm::vec3(r, g, b);
+}
 
+// 光标移动：按住鼠标键拖动时旋转/平移相机或光源，返回是否有变化
+bool handleCursor(float xpos, float ypos)
+{
     if (firstMouse)
     {
         lastX = xpos;
@@ -313,7 +1037,7 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
     lastY = ypos;
 
     // 处理鼠标左右键不同操作
-    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
+    if (leftButtonDown) {
         if (currentMode == CAMERA) {
             camera.ProcessMouseMovement(xoffset, yoffset);
         } else if (currentMode == LIGHT) {
@@ -321,7 +1045,8 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
             light.rotate(glm::radians(xoffset * 0.02f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f));
             light.rotate(glm::radians(yoffset * 0.02f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f));
         }
-    } else if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS) {
+        return true;
+    } else if (rightButtonDown) {
         if (currentMode == CAMERA) {
             // 相机平移 - 使用新的专用函数
             camera.ProcessMousePan(xoffset, yoffset);
@@ -330,15 +1055,67 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
             float sensitivity = 0.01f;
             light.move(xoffset * sensitivity  * camera.Right + yoffset * sensitivity * camera.Up);
         }
+        return true;
     }
+    return false;
 }
 
-// 滚轮回调
-void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+// 滚轮：缩放相机或调整光源强度
+void handleScroll(float yoffset)
 {
     if (currentMode == CAMERA) {
-        camera.ProcessMouseScroll(static_cast<float>(yoffset));
+        camera.ProcessMouseScroll(yoffset);
     } else if (currentMode == LIGHT) {
-        light.adjustIntensity(static_cast<float>(yoffset * 0.1f));
+        light.adjustIntensity(yoffset * 0.1f);
     }
-} 
\ No newline at end of file
+}
+
+// 打印一次运行的帧时间统计
+void printFrameTimes(const char* label, std::vector<float> milliseconds)
+{
+    ProfileStats stats = computeStats(milliseconds);
+    if (stats.samples == 0)
+        return;
+    std::cout << label << " ms min/avg/p50/p99/max: " << stats.min << "/" << stats.avg << "/" << stats.p50 << "/"
+              << stats.p99 << "/" << stats.max << " over " << stats.samples << " frames (" << 1000.0f / stats.avg
+              << " fps)" << std::endl;
+}
+
+// 窗口大小改变时的回调函数
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    framebufferWidth = width;
+    framebufferHeight = height;
+    sceneDirty = true;
+}
+
+// 窗口内容被覆盖后需要重绘（没有合成器时）
+void window_refresh_callback(GLFWwindow* window)
+{
+    sceneDirty = true;
+}
+
+// 输入回调只把带时间戳的事件放进队列，在下一帧开始时处理；回放时忽略
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    if (!replayingInput)
+        inputQueue.PushKey(key, action, glfwGetTime());
+}
+
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
+{
+    if (!replayingInput)
+        inputQueue.PushMouseButton(button, action, glfwGetTime());
+}
+
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+    if (!replayingInput)
+        inputQueue.PushCursor(xpos, ypos, glfwGetTime());
+}
+
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    if (!replayingInput)
+        inputQueue.PushScroll(xoffset, yoffset, glfwGetTime());
+}
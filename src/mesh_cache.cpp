@@ -0,0 +1,220 @@
+#include "mesh_cache.h"
+#include "hash.h"
+
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <vector>
+
+namespace {
+
+inline uint64_t alignUp(uint64_t value)
+{
+    return (value + 15) & ~uint64_t(15);
+}
+
+// 簇包围段中依次存放的MeshletSet数组
+std::vector<float> MeshletSet::* const MESHLET_BOUNDS[] = {
+    &MeshletSet::centerX, &MeshletSet::centerY, &MeshletSet::centerZ, &MeshletSet::radius,
+    &MeshletSet::axisX, &MeshletSet::axisY, &MeshletSet::axisZ, &MeshletSet::cutoff
+};
+const size_t MESHLET_BOUNDS_ARRAYS = sizeof(MESHLET_BOUNDS) / sizeof(MESHLET_BOUNDS[0]);
+
+} // namespace
+
+bool computeMeshSourceKey(const std::string& path, MeshSourceKey& key)
+{
+    std::error_code ec;
+    auto mtime = std::filesystem::last_write_time(path, ec);
+    if (ec)
+        return false;
+
+    MappedFile file;
+    if (!file.open(path))
+        return false;
+
+    key.size = file.size();
+    key.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    key.hash = hashBytes(file.data(), file.size());
+    return true;
+}
+
+std::string meshCachePath(const std::string& objPath, MeshOptimize optimization)
+{
+    const char* suffix = optimization == MeshOptimize::None ? ".none.meshbin"
+                       : optimization == MeshOptimize::Overdraw ? ".overdraw.meshbin" : ".cache.meshbin";
+    std::filesystem::path path(objPath);
+    path.replace_extension(suffix);
+    return path.string();
+}
+
+bool writeMeshCache(const std::string& path, const MeshSourceKey& key, const MeshCacheData& data)
+{
+    MeshCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic));
+    header.version = MESH_CACHE_VERSION;
+    header.headerSize = sizeof(MeshCacheHeader);
+    header.sourceSize = key.size;
+    header.sourceMtime = key.mtime;
+    header.sourceHash = key.hash;
+    header.optimization = static_cast<uint32_t>(key.optimization);
+    header.flags = data.closed ? MESH_CACHE_CLOSED : 0;
+    header.vertexCount = static_cast<uint32_t>(data.vertexCount);
+    header.indexCount = data.lods[0].indexCount;
+    header.lodIndexCount = static_cast<uint32_t>(data.indexCount);
+    header.lodCount = static_cast<uint32_t>(data.lodCount);
+    for (int i = 0; i < 3; i++) {
+        header.boundsMin[i] = data.boundsMin[i];
+        header.boundsMax[i] = data.boundsMax[i];
+    }
+    header.maxPositionError = data.packingError.maxPosition;
+    header.maxNormalDegrees = data.packingError.maxNormalDegrees;
+    header.shortIndexCount = data.shortIndices ? header.lodIndexCount : 0;
+    header.meshletCount = data.meshlets ? static_cast<uint32_t>(data.meshlets->size()) : 0;
+    header.cacheStats[0] = data.cacheStatsBefore.acmr;
+    header.cacheStats[1] = data.cacheStatsBefore.atvr;
+    header.cacheStats[2] = data.cacheStatsAfter.acmr;
+    header.cacheStats[3] = data.cacheStatsAfter.atvr;
+
+    size_t vertexBytes = data.vertexCount * 6 * sizeof(float);
+    size_t packedVertexBytes = data.vertexCount * sizeof(PackedVertex);
+    size_t indexBytes = data.indexCount * sizeof(unsigned int);
+    size_t shortIndexBytes = header.shortIndexCount * sizeof(uint16_t);
+    size_t lodBytes = data.lodCount * sizeof(MeshLod);
+    size_t meshletBytes = header.meshletCount * sizeof(Meshlet);
+    size_t boundsArrayBytes = header.meshletCount * sizeof(float);
+    size_t lodMeshletBytes = (data.lodCount + 1) * sizeof(uint32_t);
+
+    header.vertexOffset = alignUp(sizeof(MeshCacheHeader));
+    header.packedVertexOffset = alignUp(header.vertexOffset + vertexBytes);
+    header.indexOffset = alignUp(header.packedVertexOffset + packedVertexBytes);
+    header.shortIndexOffset = alignUp(header.indexOffset + indexBytes);
+    header.lodOffset = alignUp(header.shortIndexOffset + shortIndexBytes);
+    header.meshletOffset = alignUp(header.lodOffset + lodBytes);
+    header.meshletBoundsOffset = alignUp(header.meshletOffset + meshletBytes);
+    header.lodMeshletOffset = alignUp(header.meshletBoundsOffset + MESHLET_BOUNDS_ARRAYS * boundsArrayBytes);
+    uint64_t fileSize = header.lodMeshletOffset + lodMeshletBytes;
+    header.payloadSize = fileSize - sizeof(MeshCacheHeader);
+
+    // 组装整个文件，空隙填0
+    std::vector<char> buffer(fileSize, 0);
+    if (vertexBytes) {
+        std::memcpy(buffer.data() + header.vertexOffset, data.vertexData, vertexBytes);
+        std::memcpy(buffer.data() + header.packedVertexOffset, data.packedVertices, packedVertexBytes);
+    }
+    if (indexBytes)
+        std::memcpy(buffer.data() + header.indexOffset, data.indices, indexBytes);
+    if (shortIndexBytes)
+        std::memcpy(buffer.data() + header.shortIndexOffset, data.shortIndices, shortIndexBytes);
+    if (lodBytes)
+        std::memcpy(buffer.data() + header.lodOffset, data.lods, lodBytes);
+    if (meshletBytes) {
+        std::memcpy(buffer.data() + header.meshletOffset, data.meshlets->meshlets.data(), meshletBytes);
+        for (size_t i = 0; i < MESHLET_BOUNDS_ARRAYS; i++)
+            std::memcpy(buffer.data() + header.meshletBoundsOffset + i * boundsArrayBytes,
+                        (data.meshlets->*MESHLET_BOUNDS[i]).data(), boundsArrayBytes);
+    }
+    uint32_t* lodMeshlets = reinterpret_cast<uint32_t*>(buffer.data() + header.lodMeshletOffset);
+    for (size_t i = 0; i <= data.lodCount; i++)
+        lodMeshlets[i] = data.meshlets ? static_cast<uint32_t>(data.lodMeshlets[i]) : 0;
+
+    header.payloadChecksum = hashBytes(buffer.data() + sizeof(MeshCacheHeader), header.payloadSize);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+
+    // 先写临时文件再重命名，避免留下写了一半的缓存
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+            return false;
+        out.write(buffer.data(), buffer.size());
+        if (!out.good())
+            return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool MeshCache::open(const std::string& path, const MeshSourceKey& key)
+{
+    close();
+    if (!file.open(path) || file.size() < sizeof(MeshCacheHeader))
+        return false;
+
+    const MeshCacheHeader* h = reinterpret_cast<const MeshCacheHeader*>(file.data());
+    bool valid = std::memcmp(h->magic, MESH_CACHE_MAGIC, sizeof(h->magic)) == 0
+              && h->version == MESH_CACHE_VERSION
+              && h->headerSize == sizeof(MeshCacheHeader)
+              && h->sourceSize == key.size
+              && h->sourceMtime == key.mtime
+              && h->sourceHash == key.hash
+              && h->optimization == static_cast<uint32_t>(key.optimization)
+              && h->payloadSize == file.size() - sizeof(MeshCacheHeader);
+
+    // 各数据段必须完整位于文件内
+    if (valid) {
+        uint64_t size = file.size();
+        valid = h->vertexOffset + uint64_t(h->vertexCount) * 6 * sizeof(float) <= size
+             && h->packedVertexOffset + uint64_t(h->vertexCount) * sizeof(PackedVertex) <= size
+             && h->indexOffset + uint64_t(h->lodIndexCount) * sizeof(unsigned int) <= size
+             && (h->shortIndexCount == 0 || h->shortIndexCount == h->lodIndexCount)
+             && h->shortIndexOffset + uint64_t(h->shortIndexCount) * sizeof(uint16_t) <= size
+             && h->lodOffset + uint64_t(h->lodCount) * sizeof(MeshLod) <= size
+             && h->meshletOffset + uint64_t(h->meshletCount) * sizeof(Meshlet) <= size
+             && h->meshletBoundsOffset + MESHLET_BOUNDS_ARRAYS * uint64_t(h->meshletCount) * sizeof(float) <= size
+             && h->lodMeshletOffset + (uint64_t(h->lodCount) + 1) * sizeof(uint32_t) <= size
+             && h->lodCount >= 1;
+    }
+
+    // 每个LOD级别的索引范围必须位于索引段内
+    if (valid) {
+        const MeshLod* levels = reinterpret_cast<const MeshLod*>(file.data() + h->lodOffset);
+        for (uint32_t i = 0; i < h->lodCount && valid; i++)
+            valid = uint64_t(levels[i].indexOffset) + levels[i].indexCount <= h->lodIndexCount;
+        valid = valid && levels[0].indexOffset == 0 && levels[0].indexCount == h->indexCount;
+    }
+
+    // 每级的簇依次相接，簇的索引范围位于索引段内
+    if (valid) {
+        const uint32_t* lodMeshlets = reinterpret_cast<const uint32_t*>(file.data() + h->lodMeshletOffset);
+        for (uint32_t i = 0; i < h->lodCount && valid; i++)
+            valid = lodMeshlets[i] <= lodMeshlets[i + 1];
+        valid = valid && lodMeshlets[0] == 0 && lodMeshlets[h->lodCount] == h->meshletCount;
+
+        const Meshlet* meshlets = reinterpret_cast<const Meshlet*>(file.data() + h->meshletOffset);
+        for (uint32_t i = 0; i < h->meshletCount && valid; i++)
+            valid = uint64_t(meshlets[i].indexOffset) + meshlets[i].indexCount <= h->lodIndexCount;
+    }
+
+    if (valid)
+        valid = hashBytes(file.data() + sizeof(MeshCacheHeader), h->payloadSize) == h->payloadChecksum;
+
+    if (!valid) {
+        file.close();
+        return false;
+    }
+
+    header = h;
+    return true;
+}
+
+void MeshCache::copyMeshlets(MeshletSet& set, std::vector<size_t>& lodMeshlets) const
+{
+    size_t count = header->meshletCount;
+    const Meshlet* meshlets = reinterpret_cast<const Meshlet*>(file.data() + header->meshletOffset);
+    set.meshlets.assign(meshlets, meshlets + count);
+
+    const float* bounds = reinterpret_cast<const float*>(file.data() + header->meshletBoundsOffset);
+    for (size_t i = 0; i < MESHLET_BOUNDS_ARRAYS; i++)
+        (set.*MESHLET_BOUNDS[i]).assign(bounds + i * count, bounds + (i + 1) * count);
+
+    const uint32_t* levels = reinterpret_cast<const uint32_t*>(file.data() + header->lodMeshletOffset);
+    lodMeshlets.assign(levels, levels + header->lodCount + 1);
+}
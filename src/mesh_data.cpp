@@ -0,0 +1,232 @@
+#include "mesh_data.h"
+#include "mesh_normals.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+MeshData::MeshData(const char* path, bool useCache, MeshOptimize optimization)
+    : boundsMin(0.0f), boundsMax(0.0f), useVertexNormal(true), closed(false), optimization(optimization), vertexData(nullptr),
+      packedData(nullptr), indexData(nullptr), shortIndexData(nullptr), vertexCount(0), lodIndexCount(0)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    MeshSourceKey key;
+    key.optimization = optimization;
+    bool haveKey = useCache && computeMeshSourceKey(path, key);
+    std::string cachePath = meshCachePath(path, optimization);
+
+    bool fromCache = haveKey && loadFromCache(cachePath, key);
+    if (!fromCache) {
+        std::vector<unsigned int> indices;
+        loadModel(path, indices);
+        buildLods(indices);
+        packMesh();
+        buildMeshletSet();
+
+        if (haveKey && !lods.empty()) {
+            MeshCacheData data;
+            data.vertexData = reinterpret_cast<const float*>(vertices.data());
+            data.packedVertices = packedVertices.data();
+            data.vertexCount = vertices.size();
+            data.packingError = compactError;
+            data.indices = lodIndices.data();
+            data.shortIndices = shortIndexData;
+            data.indexCount = lodIndices.size();
+            data.lods = lods.data();
+            data.lodCount = lods.size();
+            data.meshlets = &meshlets;
+            data.lodMeshlets = lodMeshlets.data();
+            data.cacheStatsBefore = cacheStatsBefore;
+            data.cacheStatsAfter = cacheStatsAfter;
+            data.boundsMin = boundsMin;
+            data.boundsMax = boundsMax;
+            data.closed = closed;
+            if (writeMeshCache(cachePath, key, data))
+                std::cout << "Wrote mesh cache: " << cachePath << std::endl;
+            else
+                std::cout << "Failed to write mesh cache: " << cachePath << std::endl;
+        }
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Mesh ready in " << ms << " ms (" << (fromCache ? "mesh cache" : "OBJ parse") << ")" << std::endl;
+
+    randomColor();
+}
+
+void MeshData::randomColor()
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_real_distribution<float> dis(0.0, 1.0);
+
+    modelColor = glm::vec3(dis(gen), dis(gen), dis(gen));
+}
+
+void MeshData::optimizeMesh(ObjMesh& mesh)
+{
+    cacheStatsBefore = analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.positions.size());
+    cacheStatsAfter = cacheStatsBefore;
+    if (optimization == MeshOptimize::None || mesh.indices.empty())
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+    reorderTriangles(mesh.indices.data(), mesh.indices.size(), mesh.positions.data(), mesh.positions.size());
+
+    std::vector<unsigned int> remap(mesh.positions.size());
+    size_t used = optimizeVertexFetchRemap(remap.data(), mesh.indices.data(), mesh.indices.size(), mesh.positions.size());
+    std::vector<glm::vec3> positions(used);
+    for (size_t v = 0; v < remap.size(); v++) {
+        if (remap[v] != ~0u)
+            positions[remap[v]] = mesh.positions[v];
+    }
+    for (unsigned int& index : mesh.indices)
+        index = remap[index];
+    mesh.positions.swap(positions);
+
+    cacheStatsAfter = analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.positions.size());
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Optimized " << (optimization == MeshOptimize::Overdraw ? "vertex cache and overdraw" : "vertex cache")
+              << " in " << ms << " ms: ACMR " << cacheStatsBefore.acmr << " -> " << cacheStatsAfter.acmr
+              << ", ATVR " << cacheStatsBefore.atvr << " -> " << cacheStatsAfter.atvr << std::endl;
+}
+
+void MeshData::reorderTriangles(unsigned int* triangleIndices, size_t indexCount, const glm::vec3* positions, size_t vertexCount)
+{
+    std::vector<unsigned int> reordered(indexCount);
+    optimizeVertexCache(reordered.data(), triangleIndices, indexCount, vertexCount);
+    if (optimization == MeshOptimize::Overdraw)
+        optimizeOverdraw(triangleIndices, reordered.data(), indexCount, positions, vertexCount);
+    else
+        std::copy(reordered.begin(), reordered.end(), triangleIndices);
+}
+
+void MeshData::buildLods(const std::vector<unsigned int>& indices)
+{
+    if (indices.empty())
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<glm::vec3> positions(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+        positions[i] = vertices[i].Position;
+    buildLodChain(positions.data(), positions.size(), indices.data(), indices.size(), MAX_LOD_LEVELS, lodIndices, lods);
+
+    // 简化后的级别同样按顶点缓存重排，顶点缓冲与第0级共用，不再重排顶点
+    if (optimization != MeshOptimize::None) {
+        for (size_t level = 1; level < lods.size(); level++)
+            reorderTriangles(lodIndices.data() + lods[level].indexOffset, lods[level].indexCount,
+                             positions.data(), positions.size());
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Built " << lods.size() << " LOD levels in " << ms << " ms:";
+    for (const MeshLod& lod : lods)
+        std::cout << " " << lod.indexCount / 3;
+    std::cout << " triangles" << std::endl;
+}
+
+void MeshData::loadModel(const std::string& path, std::vector<unsigned int>& indices)
+{
+    ObjMesh mesh;
+    ObjLoadStats stats;
+    if (!loadObj(path, mesh, 0, &stats))
+        return;
+
+    std::cout << "Loaded " << path << ": " << mesh.positions.size() << " vertices, "
+              << mesh.indices.size() / 3 << " triangles, "
+              << stats.bytes / (1024.0 * 1024.0) << " MB in " << stats.seconds * 1000.0 << " ms ("
+              << stats.megabytesPerSecond() << " MB/s, " << stats.threads << " threads)" << std::endl;
+
+    optimizeMesh(mesh);
+
+    // 法线计算作为独立的一遍：SoA位置 + SIMD面法线 + 多线程累加
+    PositionsSoA soa;
+    splitPositions(mesh.positions.data(), mesh.positions.size(), soa);
+
+    // 只需要顶点法线：面法线模式在片段着色器中由屏幕空间导数求得
+    std::vector<glm::vec3> vertexNormals(mesh.positions.size());
+    computeVertexNormals(soa, mesh.indices.data(), mesh.indices.size(), vertexNormals.data());
+
+    vertices.resize(mesh.positions.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        vertices[i].Position = mesh.positions[i];
+        vertices[i].Normal = vertexNormals[i];
+    }
+
+    indices = std::move(mesh.indices);
+    closed = isClosedMesh(indices.data(), indices.size(), vertices.size());
+
+    // 包围盒
+    if (!vertices.empty()) {
+        boundsMin = boundsMax = vertices[0].Position;
+        for (const auto& vertex : vertices) {
+            boundsMin = glm::min(boundsMin, vertex.Position);
+            boundsMax = glm::max(boundsMax, vertex.Position);
+        }
+    }
+}
+
+void MeshData::packMesh()
+{
+    if (lods.empty())
+        return;
+
+    packVertices(reinterpret_cast<const float*>(vertices.data()), vertices.size(),
+                 positionQuantization(boundsMin, boundsMax), packedVertices, &compactError);
+    if (fitsShortIndices(vertices.size()))
+        packIndices(lodIndices.data(), lodIndices.size(), shortIndices);
+
+    vertexData = vertices.data();
+    packedData = packedVertices.data();
+    indexData = lodIndices.data();
+    shortIndexData = shortIndices.empty() ? nullptr : shortIndices.data();
+    vertexCount = vertices.size();
+    lodIndexCount = lodIndices.size();
+}
+
+bool MeshData::loadFromCache(const std::string& cachePath, const MeshSourceKey& key)
+{
+    if (!cache.open(cachePath, key))
+        return false;
+
+    vertexData = reinterpret_cast<const Vertex*>(cache.vertexData());
+    packedData = cache.packedVertices();
+    indexData = cache.indices();
+    shortIndexData = cache.shortIndices();
+    vertexCount = cache.vertexCount();
+    lodIndexCount = cache.lodIndexCount();
+    compactError = cache.packingError();
+    lods.assign(cache.lods(), cache.lods() + cache.lodCount());
+    cache.copyMeshlets(meshlets, lodMeshlets);
+    cacheStatsBefore = cache.cacheStatsBefore();
+    cacheStatsAfter = cache.cacheStatsAfter();
+    boundsMin = cache.boundsMin();
+    boundsMax = cache.boundsMax();
+    closed = cache.closed();
+
+    std::cout << "Loaded mesh cache " << cachePath << ": " << vertexCount << " vertices, "
+              << IndexCount() / 3 << " triangles, " << lods.size() << " LOD levels, "
+              << meshlets.size() << " meshlets" << std::endl;
+    return true;
+}
+
+void MeshData::buildMeshletSet()
+{
+    std::vector<glm::vec3> positions(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++)
+        positions[i] = vertexData[i].Position;
+
+    meshlets.clear();
+    lodMeshlets.clear();
+    for (const MeshLod& lod : lods) {
+        lodMeshlets.push_back(meshlets.size());
+        buildMeshlets(positions.data(), positions.size(), indexData, lod.indexOffset, lod.indexCount, meshlets);
+    }
+    lodMeshlets.push_back(meshlets.size());
+
+    if (!lods.empty())
+        std::cout << "Built " << meshlets.size() << " meshlets (" << lodMeshlets[1] << " at full detail)" << std::endl;
+}
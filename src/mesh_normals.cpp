@@ -0,0 +1,243 @@
+#include "mesh_normals.h"
+#include "parallel.h"
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MESH_NORMALS_SSE 1
+#endif
+
+namespace {
+
+// 每个线程的部分和占用 顶点数*12 字节，超出预算时减少累加线程数
+const size_t MAX_PARTIAL_BYTES = size_t(512) * 1024 * 1024;
+
+// 每个线程至少处理的三角形数
+const size_t MIN_TRIANGLES_PER_THREAD = 16384;
+
+// 一段三角形的处理结果写到哪里
+struct FaceOutput {
+    glm::vec3* faceNormals;     // 可为空
+    float* accumX;              // 为空时只计算面法线
+    float* accumY;
+    float* accumZ;
+};
+
+inline float cornerAngle(float cosine)
+{
+    return std::acos(std::min(1.0f, std::max(-1.0f, cosine)));
+}
+
+// 单个三角形的标量实现，也用于SIMD块之后剩余的三角形
+inline void processTriangle(const PositionsSoA& p, const unsigned int* tri, size_t face,
+                            NormalWeighting weighting, const FaceOutput& out)
+{
+    const unsigned int i0 = tri[0], i1 = tri[1], i2 = tri[2];
+    glm::vec3 p0(p.x[i0], p.y[i0], p.z[i0]);
+    glm::vec3 p1(p.x[i1], p.y[i1], p.z[i1]);
+    glm::vec3 p2(p.x[i2], p.y[i2], p.z[i2]);
+
+    glm::vec3 e1 = p1 - p0;
+    glm::vec3 e2 = p2 - p0;
+    glm::vec3 n = glm::cross(e1, e2);
+    float len = glm::length(n);
+    glm::vec3 unit = len > 0.0f ? n / len : glm::vec3(0.0f);
+
+    if (out.faceNormals)
+        out.faceNormals[face] = unit;
+    if (!out.accumX)
+        return;
+
+    float w[3] = { 1.0f, 1.0f, 1.0f };
+    if (weighting == NormalWeighting::Area) {
+        w[0] = w[1] = w[2] = 0.5f * len;
+    } else if (weighting == NormalWeighting::Angle) {
+        glm::vec3 e3 = p2 - p1;
+        float l1 = glm::length(e1), l2 = glm::length(e2), l3 = glm::length(e3);
+        if (l1 > 0.0f && l2 > 0.0f && l3 > 0.0f) {
+            w[0] = cornerAngle(glm::dot(e1, e2) / (l1 * l2));
+            w[1] = cornerAngle(-glm::dot(e1, e3) / (l1 * l3));
+            w[2] = cornerAngle(glm::dot(e2, e3) / (l2 * l3));
+        }
+    }
+
+    for (int c = 0; c < 3; c++) {
+        out.accumX[tri[c]] += unit.x * w[c];
+        out.accumY[tri[c]] += unit.y * w[c];
+        out.accumZ[tri[c]] += unit.z * w[c];
+    }
+}
+
+#ifdef MESH_NORMALS_SSE
+inline __m128 gather(const float* base, const unsigned int* idx, size_t stride)
+{
+    return _mm_setr_ps(base[idx[0]], base[idx[stride]], base[idx[2 * stride]], base[idx[3 * stride]]);
+}
+
+inline __m128 length3(__m128 x, __m128 y, __m128 z)
+{
+    return _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+}
+
+// 长度为0的通道结果为0
+inline __m128 safeDiv(__m128 a, __m128 b)
+{
+    __m128 mask = _mm_cmpgt_ps(b, _mm_setzero_ps());
+    return _mm_and_ps(_mm_div_ps(a, b), mask);
+}
+
+// 一次处理4个三角形：收集顶点后以SoA方式计算叉积、长度与角度
+inline void processTriangles4(const PositionsSoA& p, const unsigned int* tri, size_t face,
+                              NormalWeighting weighting, const FaceOutput& out)
+{
+    __m128 x0 = gather(p.x.data(), tri, 3), y0 = gather(p.y.data(), tri, 3), z0 = gather(p.z.data(), tri, 3);
+    __m128 x1 = gather(p.x.data(), tri + 1, 3), y1 = gather(p.y.data(), tri + 1, 3), z1 = gather(p.z.data(), tri + 1, 3);
+    __m128 x2 = gather(p.x.data(), tri + 2, 3), y2 = gather(p.y.data(), tri + 2, 3), z2 = gather(p.z.data(), tri + 2, 3);
+
+    __m128 e1x = _mm_sub_ps(x1, x0), e1y = _mm_sub_ps(y1, y0), e1z = _mm_sub_ps(z1, z0);
+    __m128 e2x = _mm_sub_ps(x2, x0), e2y = _mm_sub_ps(y2, y0), e2z = _mm_sub_ps(z2, z0);
+
+    __m128 nx = _mm_sub_ps(_mm_mul_ps(e1y, e2z), _mm_mul_ps(e1z, e2y));
+    __m128 ny = _mm_sub_ps(_mm_mul_ps(e1z, e2x), _mm_mul_ps(e1x, e2z));
+    __m128 nz = _mm_sub_ps(_mm_mul_ps(e1x, e2y), _mm_mul_ps(e1y, e2x));
+    __m128 len = length3(nx, ny, nz);
+
+    alignas(16) float ux[4], uy[4], uz[4];
+    _mm_store_ps(ux, safeDiv(nx, len));
+    _mm_store_ps(uy, safeDiv(ny, len));
+    _mm_store_ps(uz, safeDiv(nz, len));
+
+    if (out.faceNormals) {
+        for (int k = 0; k < 4; k++)
+            out.faceNormals[face + k] = glm::vec3(ux[k], uy[k], uz[k]);
+    }
+    if (!out.accumX)
+        return;
+
+    alignas(16) float w0[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    alignas(16) float w1[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    alignas(16) float w2[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    if (weighting == NormalWeighting::Area) {
+        __m128 area = _mm_mul_ps(len, _mm_set1_ps(0.5f));
+        _mm_store_ps(w0, area);
+        _mm_store_ps(w1, area);
+        _mm_store_ps(w2, area);
+    } else if (weighting == NormalWeighting::Angle) {
+        __m128 e3x = _mm_sub_ps(x2, x1), e3y = _mm_sub_ps(y2, y1), e3z = _mm_sub_ps(z2, z1);
+        __m128 l1 = length3(e1x, e1y, e1z);
+        __m128 l2 = length3(e2x, e2y, e2z);
+        __m128 l3 = length3(e3x, e3y, e3z);
+        __m128 d12 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, e2x), _mm_mul_ps(e1y, e2y)), _mm_mul_ps(e1z, e2z));
+        __m128 d13 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, e3x), _mm_mul_ps(e1y, e3y)), _mm_mul_ps(e1z, e3z));
+        __m128 d23 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, e3x), _mm_mul_ps(e2y, e3y)), _mm_mul_ps(e2z, e3z));
+        _mm_store_ps(w0, safeDiv(d12, _mm_mul_ps(l1, l2)));
+        _mm_store_ps(w1, safeDiv(_mm_sub_ps(_mm_setzero_ps(), d13), _mm_mul_ps(l1, l3)));
+        _mm_store_ps(w2, safeDiv(d23, _mm_mul_ps(l2, l3)));
+        // SSE没有acos，余弦算完后逐通道求角度
+        for (int k = 0; k < 4; k++) {
+            w0[k] = cornerAngle(w0[k]);
+            w1[k] = cornerAngle(w1[k]);
+            w2[k] = cornerAngle(w2[k]);
+        }
+    }
+
+    for (int k = 0; k < 4; k++) {
+        const unsigned int* t = tri + 3 * k;
+        out.accumX[t[0]] += ux[k] * w0[k];
+        out.accumY[t[0]] += uy[k] * w0[k];
+        out.accumZ[t[0]] += uz[k] * w0[k];
+        out.accumX[t[1]] += ux[k] * w1[k];
+        out.accumY[t[1]] += uy[k] * w1[k];
+        out.accumZ[t[1]] += uz[k] * w1[k];
+        out.accumX[t[2]] += ux[k] * w2[k];
+        out.accumY[t[2]] += uy[k] * w2[k];
+        out.accumZ[t[2]] += uz[k] * w2[k];
+    }
+}
+#endif
+
+void processRange(const PositionsSoA& p, const unsigned int* indices, size_t begin, size_t end,
+                  NormalWeighting weighting, const FaceOutput& out)
+{
+    size_t f = begin;
+#ifdef MESH_NORMALS_SSE
+    for (; f + 4 <= end; f += 4)
+        processTriangles4(p, indices + 3 * f, f, weighting, out);
+#endif
+    for (; f < end; f++)
+        processTriangle(p, indices + 3 * f, f, weighting, out);
+}
+
+unsigned int resolveThreads(unsigned int threadCount, size_t triangleCount)
+{
+    if (threadCount == 0)
+        threadCount = hardwareThreads();
+    size_t useful = triangleCount / MIN_TRIANGLES_PER_THREAD + 1;
+    return static_cast<unsigned int>(std::min<size_t>(threadCount, useful));
+}
+
+} // namespace
+
+void splitPositions(const glm::vec3* positions, size_t count, PositionsSoA& soa, unsigned int threadCount)
+{
+    soa.x.resize(count);
+    soa.y.resize(count);
+    soa.z.resize(count);
+    parallelFor(count, resolveThreads(threadCount, count), [&](size_t begin, size_t end, unsigned int) {
+        for (size_t i = begin; i < end; i++) {
+            soa.x[i] = positions[i].x;
+            soa.y[i] = positions[i].y;
+            soa.z[i] = positions[i].z;
+        }
+    });
+}
+
+void computeFaceNormals(const PositionsSoA& positions, const unsigned int* indices, size_t indexCount,
+                        glm::vec3* faceNormals, unsigned int threadCount)
+{
+    size_t triangleCount = indexCount / 3;
+    FaceOutput out = { faceNormals, nullptr, nullptr, nullptr };
+    parallelFor(triangleCount, resolveThreads(threadCount, triangleCount), [&](size_t begin, size_t end, unsigned int) {
+        processRange(positions, indices, begin, end, NormalWeighting::Uniform, out);
+    });
+}
+
+void computeVertexNormals(const PositionsSoA& positions, const unsigned int* indices, size_t indexCount,
+                          glm::vec3* vertexNormals, NormalWeighting weighting,
+                          glm::vec3* faceNormals, unsigned int threadCount)
+{
+    size_t vertexCount = positions.size();
+    size_t triangleCount = indexCount / 3;
+    unsigned int threads = resolveThreads(threadCount, triangleCount);
+
+    // 部分和内存受限时减少累加线程
+    size_t partialBytes = std::max<size_t>(vertexCount * 3 * sizeof(float), 1);
+    threads = static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(threads, MAX_PARTIAL_BYTES / partialBytes)));
+
+    // 每个线程一组SoA部分和
+    std::vector<std::vector<float>> partials(threads);
+    parallelFor(triangleCount, threads, [&](size_t begin, size_t end, unsigned int t) {
+        std::vector<float>& acc = partials[t];
+        acc.assign(vertexCount * 3, 0.0f);
+        FaceOutput out = { faceNormals, acc.data(), acc.data() + vertexCount, acc.data() + 2 * vertexCount };
+        processRange(positions, indices, begin, end, weighting, out);
+    });
+
+    // 按顶点区间归约并归一化
+    parallelFor(vertexCount, threads, [&](size_t begin, size_t end, unsigned int) {
+        for (size_t v = begin; v < end; v++) {
+            float x = 0.0f, y = 0.0f, z = 0.0f;
+            for (const auto& acc : partials) {
+                if (acc.empty())
+                    continue;
+                x += acc[v];
+                y += acc[vertexCount + v];
+                z += acc[2 * vertexCount + v];
+            }
+            float len = std::sqrt(x * x + y * y + z * z);
+            vertexNormals[v] = len > 0.0f ? glm::vec3(x / len, y / len, z / len) : glm::vec3(0.0f);
+        }
+    });
+}
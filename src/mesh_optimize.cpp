@@ -0,0 +1,232 @@
+#include "mesh_optimize.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// 顶点到相邻三角形的邻接表（CSR）
+struct TriangleAdjacency {
+    std::vector<unsigned int> offsets;
+    std::vector<unsigned int> triangles;
+
+    void build(const unsigned int* indices, size_t indexCount, size_t vertexCount)
+    {
+        offsets.assign(vertexCount + 1, 0);
+        for (size_t i = 0; i < indexCount; i++)
+            offsets[indices[i] + 1]++;
+        for (size_t v = 0; v < vertexCount; v++)
+            offsets[v + 1] += offsets[v];
+
+        triangles.resize(indexCount);
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indexCount; i++)
+            triangles[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+    }
+};
+
+// 用时间戳模拟FIFO缓存：顶点在最近cacheSize次未命中之内被变换过即为命中
+class FifoCache
+{
+public:
+    FifoCache(size_t vertexCount, size_t cacheSize)
+        : timestamps(vertexCount, 0), cacheSize(cacheSize), time(cacheSize + 1) {}
+
+    bool contains(unsigned int v) const { return time - timestamps[v] <= cacheSize; }
+
+    // 访问一个顶点，未命中时返回true
+    bool access(unsigned int v)
+    {
+        if (contains(v))
+            return false;
+        timestamps[v] = time++;
+        return true;
+    }
+
+private:
+    std::vector<size_t> timestamps;
+    size_t cacheSize;
+    size_t time;
+};
+
+} // namespace
+
+VertexCacheStats analyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount,
+                                    size_t cacheSize)
+{
+    VertexCacheStats stats;
+    if (indexCount == 0 || vertexCount == 0)
+        return stats;
+
+    FifoCache cache(vertexCount, cacheSize);
+    size_t misses = 0;
+    for (size_t i = 0; i < indexCount; i++)
+        misses += cache.access(indices[i]);
+
+    stats.acmr = float(misses) / float(indexCount / 3);
+    stats.atvr = float(misses) / float(vertexCount);
+    return stats;
+}
+
+void optimizeVertexCache(unsigned int* destination, const unsigned int* indices, size_t indexCount,
+                         size_t vertexCount, size_t cacheSize)
+{
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+
+    TriangleAdjacency adjacency;
+    adjacency.build(indices, indexCount, vertexCount);
+
+    // 每个顶点尚未输出的三角形数
+    std::vector<unsigned int> live(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+        live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+
+    std::vector<unsigned char> emitted(triangleCount, 0);
+    std::vector<size_t> timestamps(vertexCount, 0);
+    std::vector<unsigned int> deadEnd;          // 最近输出的顶点，找不到候选时从这里回溯
+    std::vector<unsigned int> candidates;
+    deadEnd.reserve(indexCount);
+    candidates.reserve(64);
+
+    size_t time = cacheSize + 1;
+    size_t cursor = 0;                          // 按顶点顺序扫描的位置，回溯也失败时使用
+    size_t written = 0;
+    long long fan = indices[0];
+
+    while (fan >= 0) {
+        unsigned int center = static_cast<unsigned int>(fan);
+
+        // 输出扇心的全部剩余三角形
+        candidates.clear();
+        for (unsigned int k = adjacency.offsets[center]; k < adjacency.offsets[center + 1]; k++) {
+            unsigned int t = adjacency.triangles[k];
+            if (emitted[t])
+                continue;
+            emitted[t] = 1;
+            for (int e = 0; e < 3; e++) {
+                unsigned int v = indices[t * 3 + e];
+                destination[written++] = v;
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (time - timestamps[v] > cacheSize)
+                    timestamps[v] = time++;
+            }
+        }
+
+        // 下一个扇心：输出它的三角形后仍留在缓存中、且在缓存里停留最久的候选
+        fan = -1;
+        size_t bestPriority = 0;
+        for (unsigned int v : candidates) {
+            if (live[v] == 0)
+                continue;
+            size_t priority = 0;
+            if (time - timestamps[v] + 2 * live[v] <= cacheSize)
+                priority = time - timestamps[v];
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                fan = v;
+            }
+        }
+
+        // 没有候选（死路）：先回溯最近输出的顶点，再按顺序找仍有三角形的顶点
+        if (fan < 0) {
+            while (!deadEnd.empty() && fan < 0) {
+                unsigned int v = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[v] > 0)
+                    fan = v;
+            }
+            while (fan < 0 && cursor < vertexCount) {
+                if (live[cursor] > 0)
+                    fan = static_cast<long long>(cursor);
+                cursor++;
+            }
+        }
+    }
+}
+
+void optimizeOverdraw(unsigned int* destination, const unsigned int* indices, size_t indexCount,
+                      const glm::vec3* positions, size_t vertexCount, size_t cacheSize)
+{
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+
+    // 三个顶点都未命中缓存处是硬边界，在这里切分不会增加缓存未命中
+    std::vector<size_t> clusterStarts;
+    FifoCache cache(vertexCount, cacheSize);
+    for (size_t t = 0; t < triangleCount; t++) {
+        int misses = 0;
+        for (int e = 0; e < 3; e++)
+            misses += cache.access(indices[t * 3 + e]);
+        if (misses == 3 || t == 0)
+            clusterStarts.push_back(t);
+    }
+    clusterStarts.push_back(triangleCount);
+
+    // 网格中心（按面积加权）
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+    std::vector<glm::vec3> centroids(triangleCount);
+    std::vector<glm::vec3> areaNormals(triangleCount);
+    for (size_t t = 0; t < triangleCount; t++) {
+        const glm::vec3& a = positions[indices[t * 3]];
+        const glm::vec3& b = positions[indices[t * 3 + 1]];
+        const glm::vec3& c = positions[indices[t * 3 + 2]];
+        areaNormals[t] = 0.5f * glm::cross(b - a, c - a);
+        centroids[t] = (a + b + c) / 3.0f;
+        float area = glm::length(areaNormals[t]);
+        meshCenter += centroids[t] * area;
+        meshArea += area;
+    }
+    if (meshArea > 0.0f)
+        meshCenter /= meshArea;
+
+    struct Cluster {
+        size_t begin;
+        size_t end;
+        float sortKey;
+    };
+    std::vector<Cluster> clusters(clusterStarts.size() - 1);
+    for (size_t i = 0; i + 1 < clusterStarts.size(); i++) {
+        glm::vec3 center(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (size_t t = clusterStarts[i]; t < clusterStarts[i + 1]; t++) {
+            float triangleArea = glm::length(areaNormals[t]);
+            center += centroids[t] * triangleArea;
+            normal += areaNormals[t];
+            area += triangleArea;
+        }
+        if (area > 0.0f)
+            center /= area;
+        float normalLength = glm::length(normal);
+        float key = normalLength > 0.0f ? glm::dot(center - meshCenter, normal / normalLength) : 0.0f;
+        clusters[i] = { clusterStarts[i], clusterStarts[i + 1], key };
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(),
+                     [](const Cluster& x, const Cluster& y) { return x.sortKey > y.sortKey; });
+
+    size_t written = 0;
+    for (const Cluster& cluster : clusters) {
+        for (size_t i = cluster.begin * 3; i < cluster.end * 3; i++)
+            destination[written++] = indices[i];
+    }
+}
+
+size_t optimizeVertexFetchRemap(unsigned int* remap, const unsigned int* indices, size_t indexCount,
+                                size_t vertexCount)
+{
+    std::fill(remap, remap + vertexCount, ~0u);
+
+    unsigned int next = 0;
+    for (size_t i = 0; i < indexCount; i++) {
+        unsigned int v = indices[i];
+        if (remap[v] == ~0u)
+            remap[v] = next++;
+    }
+    return next;
+}
@@ -0,0 +1,369 @@
+#include "mesh_simplify.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+// 三角形数少于该值时单线程执行，创建线程的开销大于收益
+const size_t PARALLEL_MIN_TRIANGLES = 65536;
+
+// 边界约束平面的权重，使边界顶点离开原边界的代价远大于内部
+const double BORDER_WEIGHT = 10.0;
+
+// 折叠后三角形法线与原法线夹角的余弦下限，低于它视为翻转
+const float FLIP_COS_LIMIT = 0.25f;
+
+// LOD链每级至少减少的比例，达不到时认为无法继续简化
+const double MIN_LEVEL_REDUCTION = 0.9;
+const size_t MIN_LOD_TRIANGLES = 32;
+
+// 对称4x4误差矩阵的上三角（a00 a01 a02 a03 a11 a12 a13 a22 a23 a33），weight为累加的三角形面积
+struct Quadric {
+    double a[10] = {};
+    double weight = 0.0;
+
+    // 平面 n·p + d = 0，n为单位向量
+    void addPlane(double x, double y, double z, double d, double w)
+    {
+        a[0] += w * x * x; a[1] += w * x * y; a[2] += w * x * z; a[3] += w * x * d;
+        a[4] += w * y * y; a[5] += w * y * z; a[6] += w * y * d;
+        a[7] += w * z * z; a[8] += w * z * d;
+        a[9] += w * d * d;
+    }
+
+    void add(const Quadric& q)
+    {
+        for (int i = 0; i < 10; i++)
+            a[i] += q.a[i];
+        weight += q.weight;
+    }
+
+    // 点到所有平面距离平方的加权和
+    double evaluate(const glm::vec3& p) const
+    {
+        double x = p.x, y = p.y, z = p.z;
+        return a[0] * x * x + 2.0 * a[1] * x * y + 2.0 * a[2] * x * z + 2.0 * a[3] * x
+             + a[4] * y * y + 2.0 * a[5] * y * z + 2.0 * a[6] * y
+             + a[7] * z * z + 2.0 * a[8] * z
+             + a[9];
+    }
+};
+
+// 候选折叠：from并入to
+struct Collapse {
+    unsigned int from;
+    unsigned int to;
+    float error;
+};
+
+// 一条边的两个折叠方向，评估后保留代价较小且允许的一个
+struct EdgeCandidate {
+    unsigned int a;
+    unsigned int b;
+    bool border;
+};
+
+inline glm::vec3 triangleNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+{
+    return glm::cross(b - a, c - a);
+}
+
+// 连续的半边折叠简化器：二次误差和顶点重映射在多次reduce之间保留，用于逐级生成LOD
+class Simplifier
+{
+public:
+    Simplifier(const glm::vec3* positions, size_t vertexCount,
+               const unsigned int* indices, size_t indexCount, unsigned int threadCount)
+        : positions(positions), vertexCount(vertexCount), current(indices, indices + indexCount),
+          quadrics(vertexCount), border(vertexCount, 0), locked(vertexCount, 0), remap(vertexCount)
+    {
+        threads = indexCount / 3 >= PARALLEL_MIN_TRIANGLES ? threadCount : 1;
+        buildAdjacency();
+        computeQuadrics();
+    }
+
+    // 继续简化到targetIndexCount个索引或误差达到maxError，返回累计误差
+    float reduce(size_t targetIndexCount, float maxError)
+    {
+        while (current.size() > targetIndexCount) {
+            if (!pass(targetIndexCount, maxError))
+                break;
+        }
+        return error;
+    }
+
+    const std::vector<unsigned int>& indices() const { return current; }
+
+private:
+    const glm::vec3* positions;
+    size_t vertexCount;
+    unsigned int threads;
+    float error = 0.0f;
+
+    std::vector<unsigned int> current;
+    std::vector<Quadric> quadrics;
+    std::vector<unsigned char> border;
+    std::vector<unsigned char> locked;
+    std::vector<unsigned int> remap;
+
+    // 顶点到相邻三角形的邻接表（CSR），每一轮按当前索引重建
+    std::vector<unsigned int> adjacencyOffset;
+    std::vector<unsigned int> adjacency;
+
+    std::vector<EdgeCandidate> edges;
+    std::vector<Collapse> collapses;
+
+    void buildAdjacency()
+    {
+        adjacencyOffset.assign(vertexCount + 1, 0);
+        for (unsigned int v : current)
+            adjacencyOffset[v + 1]++;
+        for (size_t v = 0; v < vertexCount; v++)
+            adjacencyOffset[v + 1] += adjacencyOffset[v];
+
+        adjacency.resize(current.size());
+        std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for (size_t i = 0; i < current.size(); i++)
+            adjacency[fill[current[i]]++] = static_cast<unsigned int>(i / 3);
+    }
+
+    // from的相邻三角形中是否有有向边from->to
+    bool hasEdge(unsigned int from, unsigned int to) const
+    {
+        for (unsigned int k = adjacencyOffset[from]; k < adjacencyOffset[from + 1]; k++) {
+            const unsigned int* tri = &current[adjacency[k] * 3];
+            for (int e = 0; e < 3; e++)
+                if (tri[e] == from && tri[(e + 1) % 3] == to)
+                    return true;
+        }
+        return false;
+    }
+
+    // 三角形平面按面积加权；边界边额外加一个过该边、垂直于三角形的约束平面
+    // 按顶点并行累加，每个顶点只写自己的二次误差
+    void computeQuadrics()
+    {
+        parallelFor(vertexCount, threads, [&](size_t begin, size_t end, unsigned int) {
+            for (size_t v = begin; v < end; v++) {
+                Quadric& q = quadrics[v];
+                for (unsigned int k = adjacencyOffset[v]; k < adjacencyOffset[v + 1]; k++) {
+                    const unsigned int* tri = &current[adjacency[k] * 3];
+                    glm::vec3 n = triangleNormal(positions[tri[0]], positions[tri[1]], positions[tri[2]]);
+                    float length = glm::length(n);
+                    if (length <= 0.0f)
+                        continue;
+                    n /= length;
+                    double area = 0.5 * length;
+                    q.addPlane(n.x, n.y, n.z, -glm::dot(n, positions[tri[0]]), area);
+                    q.weight += area;
+
+                    for (int e = 0; e < 3; e++) {
+                        unsigned int a = tri[e], b = tri[(e + 1) % 3];
+                        if ((a != v && b != v) || hasEdge(b, a))
+                            continue;
+                        border[v] = 1;
+                        glm::vec3 edge = positions[b] - positions[a];
+                        glm::vec3 side = glm::cross(edge, n);
+                        float sideLength = glm::length(side);
+                        if (sideLength <= 0.0f)
+                            continue;
+                        side /= sideLength;
+                        q.addPlane(side.x, side.y, side.z, -glm::dot(side, positions[a]),
+                                   BORDER_WEIGHT * glm::dot(edge, edge));
+                    }
+                }
+            }
+        });
+    }
+
+    // 边界顶点只能沿边界边并入另一个边界顶点，保持网格轮廓
+    bool allowed(unsigned int from, unsigned int to, bool borderEdge) const
+    {
+        return !border[from] || (borderEdge && border[to]);
+    }
+
+    float collapseError(unsigned int from, unsigned int to) const
+    {
+        Quadric q = quadrics[from];
+        q.add(quadrics[to]);
+        double cost = q.evaluate(positions[to]);
+        return q.weight > 0.0 ? static_cast<float>(std::sqrt(std::max(cost, 0.0) / q.weight)) : 0.0f;
+    }
+
+    // from移到to的位置后，不含to的相邻三角形不能翻转或退化
+    bool flips(unsigned int from, unsigned int to) const
+    {
+        for (unsigned int k = adjacencyOffset[from]; k < adjacencyOffset[from + 1]; k++) {
+            const unsigned int* tri = &current[adjacency[k] * 3];
+            if (tri[0] == to || tri[1] == to || tri[2] == to)
+                continue;
+            glm::vec3 p[3], moved[3];
+            for (int e = 0; e < 3; e++) {
+                p[e] = positions[tri[e]];
+                moved[e] = positions[tri[e] == from ? to : tri[e]];
+            }
+            glm::vec3 before = triangleNormal(p[0], p[1], p[2]);
+            glm::vec3 after = triangleNormal(moved[0], moved[1], moved[2]);
+            float limit = FLIP_COS_LIMIT * glm::length(before) * glm::length(after);
+            if (glm::dot(before, after) <= limit)
+                return true;
+        }
+        return false;
+    }
+
+    // 一轮：评估所有边，按误差从小到大折叠互不相邻的边，最后统一重写索引
+    bool pass(size_t targetIndexCount, float maxError)
+    {
+        buildAdjacency();
+
+        // 每条内部边在两个三角形中各出现一次，只取a<b的方向；边界边只出现一次，全部保留
+        edges.clear();
+        for (size_t i = 0; i < current.size(); i += 3) {
+            for (int e = 0; e < 3; e++) {
+                unsigned int a = current[i + e], b = current[i + (e + 1) % 3];
+                bool borderEdge = !hasEdge(b, a);
+                if (a < b || borderEdge)
+                    edges.push_back({ a, b, borderEdge });
+            }
+        }
+
+        collapses.resize(edges.size());
+        parallelFor(edges.size(), threads, [&](size_t begin, size_t end, unsigned int) {
+            for (size_t i = begin; i < end; i++) {
+                const EdgeCandidate& edge = edges[i];
+                Collapse best = { edge.a, edge.b, FLT_MAX };
+                if (allowed(edge.a, edge.b, edge.border))
+                    best.error = collapseError(edge.a, edge.b);
+                if (allowed(edge.b, edge.a, edge.border)) {
+                    float reverse = collapseError(edge.b, edge.a);
+                    if (reverse < best.error)
+                        best = { edge.b, edge.a, reverse };
+                }
+                collapses[i] = best;
+            }
+        });
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse& x, const Collapse& y) { return x.error < y.error; });
+
+        for (size_t v = 0; v < vertexCount; v++)
+            remap[v] = static_cast<unsigned int>(v);
+        std::fill(locked.begin(), locked.end(), 0);
+
+        size_t trianglesToRemove = (current.size() - targetIndexCount) / 3;
+        size_t removed = 0;
+        size_t performed = 0;
+        for (const Collapse& collapse : collapses) {
+            // 两个方向都不允许的边误差为FLT_MAX，排在最后；到这里说明允许的折叠已经用完
+            if (collapse.error == FLT_MAX || collapse.error > maxError || removed >= trianglesToRemove)
+                break;
+            if (locked[collapse.from] || locked[collapse.to] || flips(collapse.from, collapse.to))
+                continue;
+
+            // 锁住from的一环邻域，本轮其它折叠不会改动这些三角形，翻转检查始终基于最新的网格
+            for (unsigned int k = adjacencyOffset[collapse.from]; k < adjacencyOffset[collapse.from + 1]; k++) {
+                const unsigned int* tri = &current[adjacency[k] * 3];
+                locked[tri[0]] = locked[tri[1]] = locked[tri[2]] = 1;
+                if (tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to)
+                    removed++;
+            }
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            error = std::max(error, collapse.error);
+            performed++;
+        }
+
+        if (performed == 0)
+            return false;
+
+        // 重写索引，丢弃退化的三角形
+        size_t write = 0;
+        for (size_t i = 0; i < current.size(); i += 3) {
+            unsigned int a = remap[current[i]], b = remap[current[i + 1]], c = remap[current[i + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+            current[write++] = a;
+            current[write++] = b;
+            current[write++] = c;
+        }
+        current.resize(write);
+        return true;
+    }
+};
+
+} // namespace
+
+float simplifyMesh(const glm::vec3* positions, size_t vertexCount,
+                   const unsigned int* indices, size_t indexCount,
+                   size_t targetIndexCount, float maxError,
+                   std::vector<unsigned int>& result, unsigned int threadCount)
+{
+    Simplifier simplifier(positions, vertexCount, indices, indexCount, threadCount);
+    float error = simplifier.reduce(targetIndexCount, maxError);
+    result = simplifier.indices();
+    return error;
+}
+
+void buildLodChain(const glm::vec3* positions, size_t vertexCount,
+                   const unsigned int* indices, size_t indexCount, size_t maxLevels,
+                   std::vector<unsigned int>& lodIndices, std::vector<MeshLod>& lods,
+                   unsigned int threadCount)
+{
+    lodIndices.assign(indices, indices + indexCount);
+    lods.assign(1, { 0u, static_cast<uint32_t>(indexCount), 0.0f });
+
+    Simplifier simplifier(positions, vertexCount, indices, indexCount, threadCount);
+    while (lods.size() < maxLevels) {
+        size_t previous = lods.back().indexCount;
+        size_t target = previous / 6 * 3;
+        if (target / 3 < MIN_LOD_TRIANGLES)
+            break;
+
+        float error = simplifier.reduce(target, FLT_MAX);
+        const std::vector<unsigned int>& level = simplifier.indices();
+        if (level.size() > previous * MIN_LEVEL_REDUCTION)
+            break;
+
+        lods.push_back({ static_cast<uint32_t>(lodIndices.size()), static_cast<uint32_t>(level.size()), error });
+        lodIndices.insert(lodIndices.end(), level.begin(), level.end());
+    }
+}
+
+size_t selectLod(const MeshLod* lods, size_t count, float pixelsPerUnit, float maxErrorPixels)
+{
+    for (size_t level = count; level > 1; level--) {
+        if (lods[level - 1].error * pixelsPerUnit <= maxErrorPixels)
+            return level - 1;
+    }
+    return 0;
+}
+
+bool isClosedMesh(const unsigned int* indices, size_t indexCount, size_t vertexCount)
+{
+    if (indexCount == 0)
+        return false;
+
+    // 每个顶点出发的有向边终点（CSR）
+    std::vector<unsigned int> offset(vertexCount + 1, 0);
+    for (size_t i = 0; i < indexCount; i++)
+        offset[indices[i] + 1]++;
+    for (size_t v = 0; v < vertexCount; v++)
+        offset[v + 1] += offset[v];
+    std::vector<unsigned int> targets(indexCount);
+    std::vector<unsigned int> fill(offset.begin(), offset.end() - 1);
+    for (size_t i = 0; i < indexCount; i += 3)
+        for (int e = 0; e < 3; e++)
+            targets[fill[indices[i + e]]++] = indices[i + (e + 1) % 3];
+
+    for (size_t i = 0; i < indexCount; i += 3) {
+        for (int e = 0; e < 3; e++) {
+            unsigned int a = indices[i + e], b = indices[i + (e + 1) % 3];
+            if (std::find(targets.begin() + offset[b], targets.begin() + offset[b + 1], a) == targets.begin() + offset[b + 1])
+                return false;
+        }
+    }
+    return true;
+}
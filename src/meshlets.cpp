@@ -0,0 +1,255 @@
+#include "meshlets.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MESHLETS_SSE 1
+#endif
+
+namespace {
+
+// 法线锥的张角超过约84度（最小夹角余弦不大于0.1）时不做背面剔除
+const float MIN_CONE_DOT = 0.1f;
+
+// 模型空间的视锥平面（xyz为单位法线，指向视锥内侧）
+struct FrustumPlanes {
+    glm::vec4 planes[6];
+};
+
+// 从裁剪变换的行组合出6个平面（Gribb/Hartmann）
+FrustumPlanes extractPlanes(const glm::mat4& m)
+{
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++)
+        rows[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+
+    FrustumPlanes frustum;
+    for (int i = 0; i < 3; i++) {
+        frustum.planes[i * 2] = rows[3] + rows[i];
+        frustum.planes[i * 2 + 1] = rows[3] - rows[i];
+    }
+    for (glm::vec4& plane : frustum.planes) {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f)
+            plane /= length;
+    }
+    return frustum;
+}
+
+enum CullResult {
+    Visible = 0,
+    FrustumCulled = 1,
+    BackfaceCulled = 2
+};
+
+// 单个簇的标量测试，用于SIMD块之后剩余的簇
+inline int testMeshlet(const MeshletSet& set, size_t i, const FrustumPlanes& frustum, const glm::vec3& eye, bool backface)
+{
+    glm::vec3 center(set.centerX[i], set.centerY[i], set.centerZ[i]);
+    float radius = set.radius[i];
+    for (const glm::vec4& plane : frustum.planes) {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+            return FrustumCulled;
+    }
+    if (backface) {
+        glm::vec3 toCenter = center - eye;
+        glm::vec3 axis(set.axisX[i], set.axisY[i], set.axisZ[i]);
+        if (glm::dot(toCenter, axis) >= set.cutoff[i] * glm::length(toCenter) + radius)
+            return BackfaceCulled;
+    }
+    return Visible;
+}
+
+// 追加一个簇的索引范围，与上一个范围相接时合并
+inline void appendRange(const Meshlet& meshlet, std::vector<uint32_t>& ranges)
+{
+    size_t n = ranges.size();
+    if (n >= 2 && ranges[n - 2] + ranges[n - 1] == meshlet.indexOffset) {
+        ranges[n - 1] += meshlet.indexCount;
+    } else {
+        ranges.push_back(meshlet.indexOffset);
+        ranges.push_back(meshlet.indexCount);
+    }
+}
+
+// 计算[begin, end)这段索引组成的簇的包围球和法线锥
+void finishMeshlet(const glm::vec3* positions, const unsigned int* indices, size_t begin, size_t end, MeshletSet& set)
+{
+    glm::vec3 boundsMin(1e30f), boundsMax(-1e30f);
+    glm::vec3 normalSum(0.0f);
+    for (size_t i = begin; i < end; i += 3) {
+        const glm::vec3& a = positions[indices[i]];
+        const glm::vec3& b = positions[indices[i + 1]];
+        const glm::vec3& c = positions[indices[i + 2]];
+        boundsMin = glm::min(boundsMin, glm::min(a, glm::min(b, c)));
+        boundsMax = glm::max(boundsMax, glm::max(a, glm::max(b, c)));
+        glm::vec3 n = glm::cross(b - a, c - a);
+        float length = glm::length(n);
+        if (length > 0.0f)
+            normalSum += n / length;
+    }
+
+    // 包围球：以AABB中心为球心，半径取最远的顶点
+    glm::vec3 center = 0.5f * (boundsMin + boundsMax);
+    float radiusSquared = 0.0f;
+    for (size_t i = begin; i < end; i++) {
+        glm::vec3 d = positions[indices[i]] - center;
+        radiusSquared = std::max(radiusSquared, glm::dot(d, d));
+    }
+
+    // 法线锥：轴为单位面法线的平均方向，背面测试的cutoff = sin(锥的半角) = sqrt(1 - minDot^2)
+    glm::vec3 axis(0.0f);
+    float cutoff = 1.0f;
+    float axisLength = glm::length(normalSum);
+    if (axisLength > 0.0f) {
+        axis = normalSum / axisLength;
+        float minDot = 1.0f;
+        for (size_t i = begin; i < end; i += 3) {
+            const glm::vec3& a = positions[indices[i]];
+            glm::vec3 n = glm::cross(positions[indices[i + 1]] - a, positions[indices[i + 2]] - a);
+            float length = glm::length(n);
+            if (length > 0.0f)
+                minDot = std::min(minDot, glm::dot(n / length, axis));
+        }
+        if (minDot > MIN_CONE_DOT)
+            cutoff = std::sqrt(1.0f - minDot * minDot);
+        else
+            axis = glm::vec3(0.0f);
+    }
+
+    set.meshlets.push_back({ static_cast<uint32_t>(begin), static_cast<uint32_t>(end - begin) });
+    set.centerX.push_back(center.x);
+    set.centerY.push_back(center.y);
+    set.centerZ.push_back(center.z);
+    set.radius.push_back(std::sqrt(radiusSquared));
+    set.axisX.push_back(axis.x);
+    set.axisY.push_back(axis.y);
+    set.axisZ.push_back(axis.z);
+    set.cutoff.push_back(cutoff);
+}
+
+} // namespace
+
+void MeshletSet::clear()
+{
+    meshlets.clear();
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    radius.clear();
+    axisX.clear();
+    axisY.clear();
+    axisZ.clear();
+    cutoff.clear();
+}
+
+void buildMeshlets(const glm::vec3* positions, size_t vertexCount,
+                   const unsigned int* indices, size_t indexOffset, size_t indexCount, MeshletSet& set)
+{
+    // marker[v] == serial 表示顶点v已在当前簇中
+    std::vector<uint32_t> marker(vertexCount, 0);
+    uint32_t serial = 1;
+    size_t begin = indexOffset;
+    size_t end = indexOffset + indexCount;
+    size_t meshletVertices = 0;
+    size_t meshletTriangles = 0;
+
+    for (size_t i = indexOffset; i + 2 < end; i += 3) {
+        unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        size_t added = (marker[a] != serial) + (marker[b] != serial && b != a) + (marker[c] != serial && c != a && c != b);
+        if (meshletTriangles == MESHLET_MAX_TRIANGLES || meshletVertices + added > MESHLET_MAX_VERTICES) {
+            finishMeshlet(positions, indices, begin, i, set);
+            begin = i;
+            serial++;
+            meshletVertices = 0;
+            meshletTriangles = 0;
+            added = 1 + (b != a) + (c != a && c != b);
+        }
+        marker[a] = marker[b] = marker[c] = serial;
+        meshletVertices += added;
+        meshletTriangles++;
+    }
+    if (meshletTriangles > 0)
+        finishMeshlet(positions, indices, begin, end, set);
+}
+
+void cullMeshlets(const MeshletSet& set, size_t first, size_t count,
+                  const glm::mat4& modelViewProjection, const glm::vec3& eye, bool backface,
+                  std::vector<uint32_t>& ranges, MeshletCullStats& stats)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    FrustumPlanes frustum = extractPlanes(modelViewProjection);
+    ranges.clear();
+    stats = MeshletCullStats();
+    stats.tested = count;
+
+    size_t i = first;
+    const size_t end = first + count;
+
+    auto accept = [&](size_t index, int result) {
+        if (result == FrustumCulled) {
+            stats.frustumCulled++;
+        } else if (result == BackfaceCulled) {
+            stats.backfaceCulled++;
+        } else {
+            appendRange(set.meshlets[index], ranges);
+            stats.visibleTriangles += set.meshlets[index].indexCount / 3;
+        }
+    };
+
+#ifdef MESHLETS_SSE
+    // 每次测试4个簇：6个平面的距离与半径比较，再做法线锥测试，最后用掩码逐个输出
+    __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for (int p = 0; p < 6; p++) {
+        planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+        planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+        planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+        planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+    }
+    const __m128 eyeX = _mm_set1_ps(eye.x);
+    const __m128 eyeY = _mm_set1_ps(eye.y);
+    const __m128 eyeZ = _mm_set1_ps(eye.z);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+
+    for (; i + 4 <= end; i += 4) {
+        __m128 cx = _mm_loadu_ps(&set.centerX[i]);
+        __m128 cy = _mm_loadu_ps(&set.centerY[i]);
+        __m128 cz = _mm_loadu_ps(&set.centerZ[i]);
+        __m128 r = _mm_loadu_ps(&set.radius[i]);
+        __m128 negR = _mm_xor_ps(r, signMask);
+
+        __m128 outside = _mm_setzero_ps();
+        for (int p = 0; p < 6; p++) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], cx), _mm_mul_ps(planeY[p], cy)),
+                                         _mm_add_ps(_mm_mul_ps(planeZ[p], cz), planeW[p]));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negR));
+        }
+        int frustumMask = _mm_movemask_ps(outside);
+
+        int backMask = 0;
+        if (backface) {
+            __m128 vx = _mm_sub_ps(cx, eyeX);
+            __m128 vy = _mm_sub_ps(cy, eyeY);
+            __m128 vz = _mm_sub_ps(cz, eyeZ);
+            __m128 along = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, _mm_loadu_ps(&set.axisX[i])),
+                                                 _mm_mul_ps(vy, _mm_loadu_ps(&set.axisY[i]))),
+                                      _mm_mul_ps(vz, _mm_loadu_ps(&set.axisZ[i])));
+            __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz)));
+            __m128 limit = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&set.cutoff[i]), distance), r);
+            backMask = _mm_movemask_ps(_mm_cmpge_ps(along, limit));
+        }
+
+        for (int k = 0; k < 4; k++)
+            accept(i + k, (frustumMask >> k) & 1 ? FrustumCulled : (backMask >> k) & 1 ? BackfaceCulled : Visible);
+    }
+#endif
+
+    for (; i < end; i++)
+        accept(i, testMeshlet(set, i, frustum, eye, backface));
+
+    stats.cpuMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,337 @@
+#include "obj_loader.h"
+#include "mapped_file.h"
+#include "parallel.h"
+
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+namespace {
+
+// 每个线程至少处理的字节数，小文件不值得开线程
+const size_t MIN_CHUNK_BYTES = 256 * 1024;
+
+// 单个分块的局部解析结果
+// 面的一个角：解析后的索引及其是否为块内相对索引
+struct Corner {
+    unsigned int index;
+    bool relative;
+};
+
+struct ObjChunk {
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+    // 由负索引得到的相对索引位置，合并时需要加上本块之前的顶点数
+    std::vector<size_t> relative;
+    // 当前面的各个角，整行解析成功后才三角化写入indices；每行重复使用，避免分配
+    std::vector<Corner> corners;
+    size_t skippedLines = 0;
+};
+
+const double POW10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline const char* skipBlanks(const char* p, const char* end)
+{
+    while (p < end && isBlank(*p))
+        ++p;
+    return p;
+}
+
+inline const char* nextLine(const char* p, const char* end)
+{
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return nl ? nl + 1 : end;
+}
+
+// 浮点解析，语义与std::from_chars一致：不分配内存，不依赖locale，失败返回nullptr
+// （并非所有标准库都实现了浮点版本的from_chars，因此手写）
+const char* parseFloat(const char* p, const char* end, float& out)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    bool anyDigit = false;
+
+    // 整数部分，超过19位有效数字后只累计指数
+    while (p < end && static_cast<unsigned>(*p - '0') < 10) {
+        if (mantissa < 1000000000000000000ull)
+            mantissa = mantissa * 10 + (*p - '0');
+        else
+            exponent++;
+        anyDigit = true;
+        ++p;
+    }
+
+    // 小数部分
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && static_cast<unsigned>(*p - '0') < 10) {
+            if (mantissa < 1000000000000000000ull) {
+                mantissa = mantissa * 10 + (*p - '0');
+                exponent--;
+            }
+            anyDigit = true;
+            ++p;
+        }
+    }
+
+    if (!anyDigit)
+        return nullptr;
+
+    // 指数部分
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        bool expNegative = false;
+        if (q < end && (*q == '-' || *q == '+')) {
+            expNegative = *q == '-';
+            ++q;
+        }
+        if (q < end && static_cast<unsigned>(*q - '0') < 10) {
+            int e = 0;
+            while (q < end && static_cast<unsigned>(*q - '0') < 10) {
+                if (e < 10000)
+                    e = e * 10 + (*q - '0');
+                ++q;
+            }
+            exponent += expNegative ? -e : e;
+            p = q;
+        }
+    }
+
+    double value = static_cast<double>(mantissa);
+    if (exponent < 0)
+        value = exponent >= -22 ? value / POW10[-exponent] : value * std::pow(10.0, exponent);
+    else if (exponent > 0)
+        value = exponent <= 22 ? value * POW10[exponent] : value * std::pow(10.0, exponent);
+
+    out = static_cast<float>(negative ? -value : value);
+    return p;
+}
+
+// 解析 v x y z [w]
+bool parseVertex(const char* p, const char* end, ObjChunk& chunk)
+{
+    glm::vec3 v;
+    for (int i = 0; i < 3; i++) {
+        p = skipBlanks(p, end);
+        p = parseFloat(p, end, v[i]);
+        if (!p)
+            return false;
+    }
+    chunk.positions.push_back(v);
+    return true;
+}
+
+// 解析 f a b c ...，每个角可以是 v、v/vt、v//vn、v/vt/vn，多边形按扇形三角化
+// 任一角无法解析时整行丢弃，不输出任何三角形
+bool parseFace(const char* p, const char* end, ObjChunk& chunk)
+{
+    // 正索引不超过32位无符号范围；负索引在块内记为有符号的32位偏移
+    const long long MAX_INDEX = std::numeric_limits<unsigned int>::max();
+    const long long MIN_INDEX = std::numeric_limits<int32_t>::min();
+    std::vector<Corner>& corners = chunk.corners;
+    corners.clear();
+    size_t localVertices = chunk.positions.size();
+
+    while (true) {
+        p = skipBlanks(p, end);
+        if (p >= end || *p == '\n' || *p == '#')
+            break;
+
+        long long value = 0;
+        std::from_chars_result result = std::from_chars(p, end, value);
+        if (result.ec != std::errc() || value == 0 || value > MAX_INDEX || value < MIN_INDEX)
+            return false;
+        p = result.ptr;
+
+        // 跳过纹理坐标和法线索引
+        while (p < end && !isBlank(*p) && *p != '\n')
+            ++p;
+
+        Corner corner;
+        if (value > 0) {
+            corner.index = static_cast<unsigned int>(value - 1);
+            corner.relative = false;
+        } else {
+            // 负索引相对于当前已定义的顶点，先记为块内偏移，合并时再加上之前块的顶点数
+            // 可能指向之前的块，偏移按有符号数保存
+            corner.index = static_cast<unsigned int>(static_cast<int32_t>(static_cast<long long>(localVertices) + value));
+            corner.relative = true;
+        }
+        corners.push_back(corner);
+    }
+
+    if (corners.size() < 3)
+        return false;
+    for (size_t i = 2; i < corners.size(); i++) {
+        const Corner tri[3] = {corners[0], corners[i - 1], corners[i]};
+        for (const Corner& c : tri) {
+            if (c.relative)
+                chunk.relative.push_back(chunk.indices.size());
+            chunk.indices.push_back(c.index);
+        }
+    }
+    return true;
+}
+
+void parseChunk(const char* p, const char* end, ObjChunk& chunk)
+{
+    // 粗略预估容量，减少push_back扩容
+    size_t estimate = (end - p) / 40;
+    chunk.positions.reserve(estimate / 3);
+    chunk.indices.reserve(estimate);
+
+    while (p < end) {
+        p = skipBlanks(p, end);
+        if (p >= end)
+            break;
+
+        const char* lineEnd = nextLine(p, end);
+        if (p + 1 < end && isBlank(p[1])) {
+            if (p[0] == 'v') {
+                if (!parseVertex(p + 1, lineEnd, chunk))
+                    chunk.skippedLines++;
+            } else if (p[0] == 'f') {
+                if (!parseFace(p + 1, lineEnd, chunk))
+                    chunk.skippedLines++;
+            }
+        }
+        // vn、vt、o、g、s、usemtl、注释等行直接跳过
+        p = lineEnd;
+    }
+}
+
+} // namespace
+
+bool parseObj(const char* data, size_t size, ObjMesh& mesh, unsigned int threadCount)
+{
+    mesh.positions.clear();
+    mesh.indices.clear();
+
+    if (threadCount == 0)
+        threadCount = hardwareThreads();
+    size_t maxChunks = size / MIN_CHUNK_BYTES + 1;
+    if (threadCount > maxChunks)
+        threadCount = static_cast<unsigned int>(maxChunks);
+
+    // 按换行对齐切分文件，每块从行首开始
+    std::vector<const char*> bounds(threadCount + 1);
+    const char* end = data + size;
+    bounds[0] = data;
+    bounds[threadCount] = end;
+    for (unsigned int t = 1; t < threadCount; t++) {
+        const char* p = data + size * t / threadCount;
+        if (p < bounds[t - 1])
+            p = bounds[t - 1];
+        bounds[t] = p > data && p[-1] == '\n' ? p : nextLine(p, end);
+    }
+
+    std::vector<ObjChunk> chunks(threadCount);
+    parallelFor(threadCount, threadCount, [&](size_t begin, size_t last, unsigned int) {
+        for (size_t c = begin; c < last; c++)
+            parseChunk(bounds[c], bounds[c + 1], chunks[c]);
+    });
+
+    // 前缀和得到每块在最终数组中的偏移
+    std::vector<size_t> vertexOffsets(threadCount + 1, 0);
+    std::vector<size_t> indexOffsets(threadCount + 1, 0);
+    size_t skipped = 0;
+    for (unsigned int c = 0; c < threadCount; c++) {
+        vertexOffsets[c + 1] = vertexOffsets[c] + chunks[c].positions.size();
+        indexOffsets[c + 1] = indexOffsets[c] + chunks[c].indices.size();
+        skipped += chunks[c].skippedLines;
+    }
+
+    size_t vertexCount = vertexOffsets[threadCount];
+    mesh.positions.resize(vertexCount);
+    mesh.indices.resize(indexOffsets[threadCount]);
+
+    // 并行合并，同时修正负索引并检查越界
+    std::vector<char> valid(threadCount, 1);
+    parallelFor(threadCount, threadCount, [&](size_t begin, size_t last, unsigned int) {
+        for (size_t c = begin; c < last; c++) {
+            ObjChunk& chunk = chunks[c];
+            if (!chunk.positions.empty())
+                std::memcpy(&mesh.positions[vertexOffsets[c]], chunk.positions.data(), chunk.positions.size() * sizeof(glm::vec3));
+
+            unsigned int* dst = mesh.indices.data() + indexOffsets[c];
+            if (!chunk.indices.empty())
+                std::memcpy(dst, chunk.indices.data(), chunk.indices.size() * sizeof(unsigned int));
+
+            long long offset = static_cast<long long>(vertexOffsets[c]);
+            for (size_t r : chunk.relative) {
+                long long absolute = offset + static_cast<int32_t>(dst[r]);
+                if (absolute < 0)
+                    valid[c] = 0;
+                dst[r] = static_cast<unsigned int>(absolute);
+            }
+
+            for (size_t i = 0; i < chunk.indices.size(); i++) {
+                if (dst[i] >= vertexCount) {
+                    valid[c] = 0;
+                    break;
+                }
+            }
+
+            // 尽早释放块内存
+            std::vector<glm::vec3>().swap(chunk.positions);
+            std::vector<unsigned int>().swap(chunk.indices);
+        }
+    });
+
+    if (skipped > 0)
+        std::cout << "WARNING::OBJ: skipped " << skipped << " malformed lines" << std::endl;
+
+    for (char ok : valid) {
+        if (!ok) {
+            std::cout << "ERROR::OBJ: face index out of range" << std::endl;
+            mesh.positions.clear();
+            mesh.indices.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool loadObj(const std::string& path, ObjMesh& mesh, unsigned int threadCount, ObjLoadStats* stats)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cout << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+
+    if (threadCount == 0)
+        threadCount = hardwareThreads();
+    unsigned int used = static_cast<unsigned int>(std::min<size_t>(threadCount, file.size() / MIN_CHUNK_BYTES + 1));
+
+    bool ok = parseObj(file.data(), file.size(), mesh, threadCount);
+
+    if (stats) {
+        stats->bytes = file.size();
+        stats->threads = used;
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return ok;
+}
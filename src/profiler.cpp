@@ -0,0 +1,354 @@
+#include "profiler.h"
+#include "text_renderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+// 叠加层每隔多少帧刷新一次，其余帧文本不变，不会触发重新排版
+const unsigned long long OVERLAY_REFRESH_FRAMES = 30;
+const float OVERLAY_SCALE = 0.4f;
+const float OVERLAY_LINE_HEIGHT = 16.0f;
+
+// 转义JSON字符串中的引号和反斜杠
+void writeJsonString(std::ofstream& out, const char* text)
+{
+    out << '"';
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\')
+            out << '\\';
+        out << *c;
+    }
+    out << '"';
+}
+
+} // namespace
+
+ProfileStats computeStats(std::vector<float>& samples)
+{
+    ProfileStats stats;
+    if (samples.empty())
+        return stats;
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (float s : samples)
+        sum += s;
+
+    size_t n = samples.size();
+    size_t p99 = static_cast<size_t>(std::ceil(0.99 * n)) - 1;
+    stats.min = samples.front();
+    stats.avg = static_cast<float>(sum / n);
+    stats.p50 = samples[(n - 1) / 2];
+    stats.p99 = samples[std::min(p99, n - 1)];
+    stats.max = samples.back();
+    stats.samples = static_cast<unsigned int>(n);
+    return stats;
+}
+
+Profiler::Profiler()
+    : epoch(std::chrono::steady_clock::now()), slots(QUERY_RING), current(nullptr),
+      frameIndex(0), droppedFrames(0), depth(0), gpuActive(false),
+      history(HISTORY_FRAMES), historyHead(0), historyCount(0),
+      lastOverlayFrame(0), overlayVisible(false)
+{
+    for (FrameSlot& slot : slots) {
+        glGenQueries(MAX_SCOPES, slot.queries);
+        slot.queryCount = 0;
+        slot.pending = false;
+        slot.record.eventCount = 0;
+    }
+    passNames.reserve(MAX_PASSES);
+    summary.reserve(MAX_PASSES);
+    scratch.reserve(HISTORY_FRAMES);
+}
+
+Profiler::~Profiler()
+{
+    for (FrameSlot& slot : slots)
+        glDeleteQueries(MAX_SCOPES, slot.queries);
+}
+
+double Profiler::now() const
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+unsigned int Profiler::passIndex(const char* name)
+{
+    for (size_t i = 0; i < passNames.size(); i++) {
+        if (passNames[i] == name || std::strcmp(passNames[i], name) == 0)
+            return static_cast<unsigned int>(i);
+    }
+    if (passNames.size() >= MAX_PASSES) {
+        std::cout << "WARNING::PROFILER: Too many passes, '" << name << "' is merged into '" << passNames.back() << "'" << std::endl;
+        return static_cast<unsigned int>(passNames.size() - 1);
+    }
+    passNames.push_back(name);
+    return static_cast<unsigned int>(passNames.size() - 1);
+}
+
+void Profiler::resolve(FrameSlot& slot)
+{
+    // 结果按提交顺序可用，逐个检查，任意一个还没好就丢弃整帧的GPU数据而不是等待
+    bool available = true;
+    for (unsigned int q = 0; q < slot.queryCount && available; q++) {
+        GLint ready = 0;
+        glGetQueryObjectiv(slot.queries[q], GL_QUERY_RESULT_AVAILABLE, &ready);
+        available = ready != 0;
+    }
+
+    FrameRecord& record = slot.record;
+    for (unsigned int e = 0; e < record.eventCount; e++) {
+        ScopeEvent& event = record.events[e];
+        if (event.query < 0 || !available)
+            continue;
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(slot.queries[event.query], GL_QUERY_RESULT, &nanoseconds);
+        event.gpuMilliseconds = static_cast<float>(nanoseconds * 1e-6);
+    }
+    if (!available)
+        droppedFrames++;
+
+    history[historyHead] = record;
+    historyHead = (historyHead + 1) % history.size();
+    historyCount = std::min(historyCount + 1, history.size());
+    slot.pending = false;
+}
+
+void Profiler::BeginFrame()
+{
+    FrameSlot& slot = slots[frameIndex % QUERY_RING];
+    if (slot.pending)
+        resolve(slot);
+
+    slot.queryCount = 0;
+    slot.record.frame = frameIndex;
+    slot.record.eventCount = 0;
+    slot.record.cpuStart = now();
+    slot.record.cpuEnd = slot.record.cpuStart;
+    current = &slot;
+    depth = 0;
+    gpuActive = false;
+}
+
+void Profiler::EndFrame()
+{
+    if (!current)
+        return;
+
+    // 未配对的区段在帧末关闭
+    while (depth > 0)
+        End();
+
+    current->record.cpuEnd = now();
+    current->pending = true;
+    current = nullptr;
+    frameIndex++;
+}
+
+void Profiler::Begin(const char* name, bool gpu)
+{
+    if (!current)
+        return;
+
+    FrameRecord& record = current->record;
+    if (record.eventCount >= MAX_SCOPES || depth >= MAX_DEPTH) {
+        // 超出容量的区段不记录，但仍要占位以便End配对
+        if (depth < MAX_DEPTH)
+            stack[depth] = -1;
+        depth++;
+        return;
+    }
+
+    ScopeEvent& event = record.events[record.eventCount];
+    event.pass = passIndex(name);
+    event.depth = depth;
+    event.gpuMilliseconds = -1.0f;
+    event.query = -1;
+
+    if (gpu && !gpuActive) {
+        event.query = static_cast<int>(current->queryCount++);
+        glBeginQuery(GL_TIME_ELAPSED, current->queries[event.query]);
+        gpuActive = true;
+    }
+
+    stack[depth++] = static_cast<int>(record.eventCount++);
+    event.cpuStart = now();
+    event.cpuEnd = event.cpuStart;
+}
+
+void Profiler::End()
+{
+    if (!current || depth == 0)
+        return;
+
+    depth--;
+    if (depth >= MAX_DEPTH || stack[depth] < 0)
+        return;
+
+    ScopeEvent& event = current->record.events[stack[depth]];
+    event.cpuEnd = now();
+    if (event.query >= 0) {
+        glEndQuery(GL_TIME_ELAPSED);
+        gpuActive = false;
+    }
+}
+
+void Profiler::Summarize()
+{
+    if (summary.size() != passNames.size()) {
+        summary.resize(passNames.size());
+        for (size_t p = 0; p < passNames.size(); p++)
+            summary[p].name = passNames[p];
+    }
+
+    // 帧的CPU总时间
+    scratch.clear();
+    for (size_t i = 0; i < historyCount; i++)
+        scratch.push_back(static_cast<float>(history[i].cpuEnd - history[i].cpuStart));
+    frameStats = computeStats(scratch);
+
+    for (size_t p = 0; p < passNames.size(); p++) {
+        for (int gpu = 0; gpu < 2; gpu++) {
+            scratch.clear();
+            for (size_t i = 0; i < historyCount; i++) {
+                const FrameRecord& record = history[i];
+                float total = 0.0f;
+                bool found = false;
+                for (unsigned int e = 0; e < record.eventCount; e++) {
+                    const ScopeEvent& event = record.events[e];
+                    if (event.pass != p)
+                        continue;
+                    if (gpu) {
+                        if (event.gpuMilliseconds < 0.0f)
+                            continue;
+                        total += event.gpuMilliseconds;
+                    } else {
+                        total += static_cast<float>(event.cpuEnd - event.cpuStart);
+                    }
+                    found = true;
+                }
+                if (found)
+                    scratch.push_back(total);
+            }
+            (gpu ? summary[p].gpu : summary[p].cpu) = computeStats(scratch);
+        }
+    }
+}
+
+void Profiler::formatStats(char* buffer, size_t size, const char* label, const ProfileStats& cpu, const ProfileStats* gpu) const
+{
+    int n = std::snprintf(buffer, size, "%-8s cpu %.2f/%.2f/%.2f", label, cpu.min, cpu.avg, cpu.p99);
+    if (gpu && gpu->samples > 0 && n > 0 && static_cast<size_t>(n) < size)
+        std::snprintf(buffer + n, size - n, "  gpu %.2f/%.2f/%.2f", gpu->min, gpu->avg, gpu->p99);
+}
+
+void Profiler::DrawOverlay(TextRenderer& text, float x, float y, bool visible)
+{
+    size_t lines = passNames.size() + 2;
+    while (overlayText.size() < lines)
+        overlayText.push_back(text.CreateText());
+
+    if (!visible) {
+        if (overlayVisible) {
+            for (unsigned int handle : overlayText)
+                text.SetText(handle, "", x, y, OVERLAY_SCALE);
+            overlayVisible = false;
+        }
+        return;
+    }
+
+    // 只有刚打开或到了刷新间隔才重新计算，其余帧保留上次的文本
+    if (overlayVisible && frameIndex - lastOverlayFrame < OVERLAY_REFRESH_FRAMES)
+        return;
+    overlayVisible = true;
+    lastOverlayFrame = frameIndex;
+    Summarize();
+
+    const glm::vec3 headerColor(1.0f, 1.0f, 0.0f);
+    const glm::vec3 rowColor(0.9f, 0.9f, 0.9f);
+    char buffer[128];
+
+    // 自下而上排列，第一行为表头
+    float lineY = y + OVERLAY_LINE_HEIGHT * (lines - 1);
+    std::snprintf(buffer, sizeof(buffer), "ms min/avg/p99 (%u frames)", frameStats.samples);
+    text.SetText(overlayText[0], buffer, x, lineY, OVERLAY_SCALE, headerColor);
+    lineY -= OVERLAY_LINE_HEIGHT;
+
+    formatStats(buffer, sizeof(buffer), "Frame", frameStats, nullptr);
+    text.SetText(overlayText[1], buffer, x, lineY, OVERLAY_SCALE, headerColor);
+    lineY -= OVERLAY_LINE_HEIGHT;
+
+    for (size_t p = 0; p < summary.size(); p++) {
+        formatStats(buffer, sizeof(buffer), passNames[p], summary[p].cpu, &summary[p].gpu);
+        text.SetText(overlayText[p + 2], buffer, x, lineY, OVERLAY_SCALE, rowColor);
+        lineY -= OVERLAY_LINE_HEIGHT;
+    }
+}
+
+bool Profiler::ExportCSV(const std::string& path) const
+{
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cout << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+
+    out << "frame,pass,depth,cpu_start_ms,cpu_ms,gpu_ms\n";
+    size_t first = (historyHead + history.size() - historyCount) % history.size();
+    for (size_t i = 0; i < historyCount; i++) {
+        const FrameRecord& record = history[(first + i) % history.size()];
+        out << record.frame << ",Frame,0," << record.cpuStart << "," << record.cpuEnd - record.cpuStart << ",\n";
+        for (unsigned int e = 0; e < record.eventCount; e++) {
+            const ScopeEvent& event = record.events[e];
+            out << record.frame << "," << passNames[event.pass] << "," << event.depth + 1 << ","
+                << event.cpuStart << "," << event.cpuEnd - event.cpuStart << ",";
+            if (event.gpuMilliseconds >= 0.0f)
+                out << event.gpuMilliseconds;
+            out << "\n";
+        }
+    }
+    return out.good();
+}
+
+bool Profiler::ExportChromeTrace(const std::string& path) const
+{
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cout << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+
+    // 时间单位为微秒，tid 1为CPU，tid 2为GPU
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+    size_t first = (historyHead + history.size() - historyCount) % history.size();
+    for (size_t i = 0; i < historyCount; i++) {
+        const FrameRecord& record = history[(first + i) % history.size()];
+        out << ",\n{\"name\":\"Frame\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << record.cpuStart * 1000.0
+            << ",\"dur\":" << (record.cpuEnd - record.cpuStart) * 1000.0 << ",\"args\":{\"frame\":" << record.frame << "}}";
+        for (unsigned int e = 0; e < record.eventCount; e++) {
+            const ScopeEvent& event = record.events[e];
+            out << ",\n{\"name\":";
+            writeJsonString(out, passNames[event.pass]);
+            out << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << event.cpuStart * 1000.0
+                << ",\"dur\":" << (event.cpuEnd - event.cpuStart) * 1000.0 << "}";
+            if (event.gpuMilliseconds >= 0.0f) {
+                out << ",\n{\"name\":";
+                writeJsonString(out, passNames[event.pass]);
+                out << ",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":" << event.cpuStart * 1000.0
+                    << ",\"dur\":" << event.gpuMilliseconds * 1000.0 << "}";
+            }
+        }
+    }
+    out << "\n]}\n";
+    return out.good();
+}
@@ -0,0 +1,317 @@
+#include "renderer.h"
+#include "profiler.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 前向和延迟光照共用的片段着色器源码
+const char* const LIGHTING_PRELUDE = "shaders/lighting.glsl";
+
+// 各程序的顶点/片段着色器及插入片段着色器的公共源码，顺序与Renderer::shaders一致
+const char* const SHADER_FILES[][3] = {
+    { "shaders/model.vs", "shaders/model.fs", LIGHTING_PRELUDE },
+    { "shaders/sphere.vs", "shaders/sphere.fs", nullptr },
+    { "shaders/model.vs", "shaders/gbuffer.fs", nullptr },
+    { "shaders/deferred.vs", "shaders/deferred.fs", LIGHTING_PRELUDE },
+};
+
+} // namespace
+
+Renderer::Renderer(Model& model, Sphere& lightSphere)
+    : modelShader(SHADER_FILES[0][0], SHADER_FILES[0][1], SHADER_FILES[0][2]),
+      sphereShader(SHADER_FILES[1][0], SHADER_FILES[1][1], SHADER_FILES[1][2]),
+      gbufferShader(SHADER_FILES[2][0], SHADER_FILES[2][1], SHADER_FILES[2][2]),
+      deferredShader(SHADER_FILES[3][0], SHADER_FILES[3][1], SHADER_FILES[3][2]),
+      model(model), lightSphere(lightSphere),
+      pointLightGizmo(POINT_LIGHT_GIZMO_RADIUS, POINT_LIGHT_GIZMO_SECTORS, POINT_LIGHT_GIZMO_STACKS)
+{
+    shaders[0] = &modelShader;
+    shaders[1] = &sphereShader;
+    shaders[2] = &gbufferShader;
+    shaders[3] = &deferredShader;
+    configureShaders();
+}
+
+std::vector<std::string> Renderer::ShaderFiles()
+{
+    std::vector<std::string> files;
+    for (const auto& program : SHADER_FILES) {
+        files.push_back(program[0]);
+        files.push_back(program[1]);
+        if (program[2])
+            files.push_back(program[2]);
+    }
+    return files;
+}
+
+void Renderer::configureShaders()
+{
+    // 每帧共享的uniform块：视图、投影、相机位置和光源只上传一次
+    for (Shader* shader : shaders)
+        shader->bindUniformBlock(FRAME_DATA_BLOCK, FRAME_DATA_BINDING);
+    
+    modelShader.use();
+    LightPool::bindSamplers(modelShader);
+    deferredShader.use();
+    LightPool::bindSamplers(deferredShader);
+    GBuffer::bindSamplers(deferredShader);
+}
+
+void Renderer::ReloadShaders(const std::vector<std::string>& files)
+{
+    for (Shader* shader : shaders) {
+        for (const std::string& file : files) {
+            if (shader->UsesFile(file)) {
+                shader->BeginReload();
+                break;
+            }
+        }
+    }
+}
+
+bool Renderer::ShaderReloadsPending() const
+{
+    for (const Shader* shader : shaders) {
+        if (shader->IsReloading())
+            return true;
+    }
+    return false;
+}
+
+bool Renderer::UpdateShaderReloads()
+{
+    bool finished = false;
+    bool linked = false;
+    for (int i = 0; i < SHADER_COUNT; i++) {
+        std::string errors;
+        if (!shaders[i]->UpdateReload(errors))
+            continue;
+        finished = true;
+        linked |= errors.empty();
+        reloadErrors[i] = errors.empty() ? std::string()
+                                         : shaders[i]->vertexPath + " + " + shaders[i]->fragmentPath + "\n" + errors;
+    }
+    if (!finished)
+        return false;
+    
+    if (linked)
+        configureShaders();
+    shaderErrors.clear();
+    for (const std::string& errors : reloadErrors)
+        shaderErrors += errors;
+    return true;
+}
+
+void Renderer::SetInstances(const InstanceData* data, size_t count)
+{
+    instances.assign(data, data + count);
+    instanceBuffer.upload(data, count);
+}
+
+void Renderer::SetPointLights(const PointLight* lights, size_t count)
+{
+    pointLights.assign(lights, lights + count);
+    
+    // 球体颜色取光源颜色归一化到最大分量为1，不随强度变暗
+    gizmoInstances.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 color(lights[i].color);
+        color /= std::max(color.x, std::max(color.y, std::max(color.z, 1e-3f)));
+        gizmoInstances[i].positionRadius = glm::vec4(glm::vec3(lights[i].positionRadius), POINT_LIGHT_GIZMO_RADIUS);
+        gizmoInstances[i].color = glm::vec4(color, 0.0f);
+    }
+}
+
+void Renderer::Render(const Camera& camera, const Light& light, const RenderSettings& settings, int width, int height, Profiler* profiler)
+{
+    stats = RenderStats();
+
+    // 视图/投影变换 - 用于所有着色器
+    FrameData frame;
+    frame.view = camera.GetViewMatrix();
+    frame.projection = glm::perspective(glm::radians(camera.Zoom), float(width) / float(height), NEAR_PLANE, FAR_PLANE);
+    frame.viewPos = glm::vec4(camera.Position, 1.0f);
+    light.setUniforms(frame);
+    frameUniforms.update(frame);
+    lodEye = camera.Position;
+    lodPixelScale = 0.5f * float(height) / std::tan(0.5f * glm::radians(camera.Zoom));
+    viewProjection = frame.projection * frame.view;
+
+    // 点光源：分簇后与光源池一起每帧上传一次
+    bool clustered = settings.lightCulling == LightCulling::Clustered;
+    if (!pointLights.empty()) {
+        if (profiler)
+            profiler->Begin("Lights", false);
+        if (clustered) {
+            buildLightClusters(pointLights.data(), pointLights.size(), frame.view, frame.projection,
+                               width, height, NEAR_PLANE, FAR_PLANE, clusters);
+            stats.visibleLights = clusters.visibleLights;
+            stats.clusterLightRefs = clusters.lightIndices.size();
+            stats.cullMilliseconds = clusters.cpuMilliseconds;
+        }
+        lightPool.upload(pointLights.data(), pointLights.size(), clustered ? &clusters : nullptr);
+        stats.pointLights = pointLights.size();
+        if (profiler)
+            profiler->End();
+    }
+
+    // 1. 首先渲染主模型
+    if (settings.deferred) {
+        renderDeferred(settings, frame, width, height, profiler);
+    } else {
+        if (profiler)
+            profiler->Begin("Model");
+        modelShader.use();
+        setLighting(modelShader, settings);
+        modelShader.setFloat("shininess", settings.shininess);
+        drawModel(modelShader, settings);
+        if (profiler)
+            profiler->End();
+    }
+
+    // 2. 然后渲染表示光源的球体
+    if (profiler)
+        profiler->Begin("Sphere");
+    sphereShader.use();
+    lightSphere.Draw(sphereShader, light.position, light.intensity);
+    stats.drawCalls++;
+    stats.triangles += lightSphere.TriangleCount();
+    if (settings.lightGizmos && !gizmoInstances.empty())
+        drawLightGizmos(settings);
+    if (profiler)
+        profiler->End();
+}
+
+void Renderer::drawLightGizmos(const RenderSettings& settings)
+{
+    if (settings.instancing) {
+        pointLightGizmo.DrawInstanced(sphereShader, gizmoInstances.data(), gizmoInstances.size());
+        stats.drawCalls++;
+    } else {
+        for (const SphereInstance& instance : gizmoInstances)
+            pointLightGizmo.Draw(sphereShader, instance);
+        stats.drawCalls += static_cast<unsigned int>(gizmoInstances.size());
+    }
+    stats.triangles += pointLightGizmo.TriangleCount() * gizmoInstances.size();
+}
+
+void Renderer::setLighting(Shader& shader, const RenderSettings& settings)
+{
+    lightPool.bind(shader, settings.lightCulling, pointLights.size(), clusters.grid);
+
+    // 光照组件开关
+    shader.setBool("enableAmbient", settings.enableAmbient);
+    shader.setBool("enableDiffuse", settings.enableDiffuse);
+    shader.setBool("enableSpecular", settings.enableSpecular);
+}
+
+void Renderer::drawModel(Shader& shader, const RenderSettings& settings)
+{
+    if (instances.empty()) {
+        // 世界变换
+        shader.setMat4("model", glm::mat4(1.0f));
+
+        chooseLod(settings, pixelsPerUnit(glm::mat4(1.0f)));
+        if (settings.meshletCulling) {
+            // 模型变换为单位矩阵，视图投影即模型空间到裁剪空间的变换，相机位置也无需变换
+            const MeshletCullStats& cull = model.CullMeshlets(viewProjection, lodEye, settings.backfaceCulling);
+            // 与法线锥一致，按逆时针为正面剔除背面三角形，否则保留下来的簇中仍会画出背面
+            if (settings.backfaceCulling)
+                glEnable(GL_CULL_FACE);
+            model.DrawVisible(shader);
+            if (settings.backfaceCulling)
+                glDisable(GL_CULL_FACE);
+            stats.triangles += cull.visibleTriangles;
+            stats.meshlets = cull.tested;
+            stats.frustumCulled = cull.frustumCulled;
+            stats.backfaceCulled = cull.backfaceCulled;
+            stats.drawRanges = model.VisibleRanges();
+            stats.meshletMilliseconds = cull.cpuMilliseconds;
+        } else {
+            model.Draw(shader);
+            stats.triangles += model.DrawnTriangles();
+        }
+        stats.drawCalls++;
+    } else if (settings.instancing) {
+        // 所有实例共用一个级别，按屏幕上最大（通常是最近）的实例选择
+        float pixels = 0.0f;
+        for (const InstanceData& instance : instances)
+            pixels = std::max(pixels, pixelsPerUnit(instance.model));
+        chooseLod(settings, pixels);
+        model.DrawInstanced(shader, instanceBuffer);
+        stats.drawCalls++;
+        stats.triangles += model.DrawnTriangles() * instances.size();
+    } else {
+        for (const InstanceData& instance : instances) {
+            chooseLod(settings, pixelsPerUnit(instance.model));
+            model.Draw(shader, instance);
+            stats.triangles += model.DrawnTriangles();
+        }
+        stats.drawCalls += static_cast<unsigned int>(instances.size());
+    }
+    stats.lodLevel = model.GetLod();
+}
+
+float Renderer::pixelsPerUnit(const glm::mat4& transform) const
+{
+    float scale = std::max(glm::length(glm::vec3(transform[0])),
+                           std::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+    glm::vec3 center = glm::vec3(transform * glm::vec4(0.5f * (model.boundsMin + model.boundsMax), 1.0f));
+    float radius = 0.5f * glm::length(model.boundsMax - model.boundsMin) * scale;
+    float distance = std::max(glm::length(center - lodEye) - radius, NEAR_PLANE);
+    return lodPixelScale * scale / distance;
+}
+
+void Renderer::chooseLod(const RenderSettings& settings, float pixels)
+{
+    if (settings.lod)
+        model.SelectLod(pixels, settings.lodErrorPixels);
+    else
+        model.SetLod(0);
+}
+
+void Renderer::renderDeferred(const RenderSettings& settings, const FrameData& frame, int width, int height, Profiler* profiler)
+{
+    // 光照阶段画回调用方绑定的帧缓冲（窗口或离屏FBO）
+    GLint target = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+    if (!gbuffer.resize(width, height))
+        return;
+
+    // 几何阶段：G-buffer的w分量存的是shininess，不能参与混合
+    if (profiler)
+        profiler->Begin("GBuffer");
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_BLEND);
+    glBindFramebuffer(GL_FRAMEBUFFER, gbuffer.framebuffer());
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    gbufferShader.use();
+    gbufferShader.setFloat("shininess", settings.shininess);
+    drawModel(gbufferShader, settings);
+    glBindFramebuffer(GL_FRAMEBUFFER, target);
+    if (blend)
+        glEnable(GL_BLEND);
+    if (profiler)
+        profiler->End();
+
+    // 光照阶段：每个像素只算一次光照，与模型的三角形数和重叠层数无关
+    // 深度测试设为总是通过，着色器写回的深度供之后的光源球体使用
+    if (profiler)
+        profiler->Begin("Lighting");
+    deferredShader.use();
+    setLighting(deferredShader, settings);
+    deferredShader.setMat4("invViewProj", glm::inverse(frame.projection * frame.view));
+    gbuffer.bindTextures();
+    glDepthFunc(GL_ALWAYS);
+    gbuffer.drawFullscreenTriangle();
+    glDepthFunc(GL_LESS);
+    stats.drawCalls++;
+    stats.triangles++;
+    if (profiler)
+        profiler->End();
+}
@@ -1,14 +1,161 @@
-#include <GL/glew.h>
-#include <iostream>
+#include "shader_utils.h"
+#include "hash.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
 #include <sstream>
-#include <string>
+#include <vector>
 
-// 从文件加载着色器源代码
-std::string loadShaderSource(const char* filePath) {
+namespace {
+
+const uint32_t PROGRAM_BINARY_MAGIC = 0x47525053;    // "SPRG"
+const uint32_t PROGRAM_BINARY_VERSION = 1;
+
+// 缓存文件头部，之后紧跟驱动返回的程序二进制
+struct ProgramBinaryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;
+    uint32_t size;
+};
+
+std::string cacheDirectory = "shader_cache";
+ShaderBuildStats buildStats;
+
+// 预读的源码，键为文件路径
+std::mutex preloadMutex;
+std::multimap<std::string, std::string> preloadedSources;
+
+// 源码和驱动标识（厂商、渲染器、版本）共同决定缓存键，换驱动或改着色器都会失效
+uint64_t programKey(const std::string& vertexCode, const std::string& fragmentCode)
+{
+    uint64_t key = hashBytes(vertexCode.data(), vertexCode.size(), PROGRAM_BINARY_VERSION);
+    key = hashBytes(fragmentCode.data(), fragmentCode.size(), key);
+    const GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION };
+    for (GLenum name : names) {
+        const char* value = reinterpret_cast<const char*>(glGetString(name));
+        if (value)
+            key = hashBytes(value, std::strlen(value), key);
+    }
+    return key;
+}
+
+std::string cachePath(uint64_t key)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(cacheDirectory) / name).string();
+}
+
+// 驱动至少支持一种程序二进制格式时才使用缓存
+bool binaryCacheAvailable()
+{
+    if (cacheDirectory.empty() || !GLEW_ARB_get_program_binary)
+        return false;
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+// 从缓存加载程序，文件缺失返回false；文件存在但驱动拒绝时rejected为true
+bool loadProgramBinary(GLuint program, uint64_t key, bool& rejected)
+{
+    rejected = false;
+    std::ifstream in(cachePath(key), std::ios::binary);
+    if (!in.is_open())
+        return false;
+
+    ProgramBinaryHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || header.magic != PROGRAM_BINARY_MAGIC || header.version != PROGRAM_BINARY_VERSION || header.key != key) {
+        rejected = true;
+        return false;
+    }
+    std::vector<char> binary(header.size);
+    if (!in.read(binary.data(), binary.size())) {
+        rejected = true;
+        return false;
+    }
+
+    glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    rejected = !success;
+    return success;
+}
+
+// 写入缓存（先写临时文件再重命名），失败只打印提示
+void saveProgramBinary(GLuint program, uint64_t key)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    ProgramBinaryHeader header = { PROGRAM_BINARY_MAGIC, PROGRAM_BINARY_VERSION, key, format, static_cast<uint32_t>(length) };
+    std::string path = cachePath(key);
+    std::string tempPath = path + ".tmp";
+    std::error_code ec;
+    std::filesystem::create_directories(cacheDirectory, ec);
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (out.is_open()) {
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(binary.data(), length);
+        }
+        if (!out.good()) {
+            std::cout << "Failed to write shader cache: " << path << std::endl;
+            return;
+        }
+    }
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        std::cout << "Failed to write shader cache: " << path << std::endl;
+    }
+}
+
+// 提交单个着色器的编译，不查询结果（并行编译时查询会等待编译完成）
+GLuint compileShader(GLenum type, const std::string& code)
+{
+    const char* source = code.c_str();
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    return shader;
+}
+
+// 着色器编译失败时追加它的日志
+void appendShaderLog(GLuint shader, const char* stage, std::string& errors)
+{
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        GLchar infoLog[512];
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        errors += std::string("ERROR::SHADER::") + stage + "::COMPILATION_FAILED\n" + infoLog + "\n";
+    }
+}
+
+bool parallelCompile = false;
+
+// 从文件读取源代码
+std::string readShaderFile(const char* filePath) {
     std::string shaderCode;
     std::ifstream shaderFile;
-    
+
     // 确保ifstream对象可以抛出异常
     shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
     try {
@@ -25,63 +172,159 @@ std::string loadShaderSource(const char* filePath) {
     catch (std::ifstream::failure& e) {
         std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << filePath << std::endl;
     }
-    
+
     return shaderCode;
 }
 
-// 创建着色器程序
-GLuint createShaderProgram(const char* vertexPath, const char* fragmentPath) {
+// 把prelude插入在source的#version行之后；两段各用#line从第1行计，prelude的源串号为1
+std::string insertPrelude(const std::string& source, const std::string& prelude)
+{
+    size_t lineEnd = source.find('\n');
+    if (lineEnd == std::string::npos)
+        lineEnd = source.size();
+    return source.substr(0, lineEnd) + "\n#line 1 1\n" + prelude + "\n#line 2 0\n"
+         + (lineEnd < source.size() ? source.substr(lineEnd + 1) : std::string());
+}
+
+} // namespace
+
+// 从文件加载着色器源代码
+std::string loadShaderSource(const char* filePath) {
+    {
+        std::lock_guard<std::mutex> lock(preloadMutex);
+        auto it = preloadedSources.find(filePath);
+        if (it != preloadedSources.end()) {
+            std::string shaderCode = std::move(it->second);
+            preloadedSources.erase(it);
+            return shaderCode;
+        }
+    }
+    return readShaderFile(filePath);
+}
+
+void preloadShaderSources(const std::vector<std::string>& paths) {
+    for (const std::string& path : paths) {
+        std::string shaderCode = readShaderFile(path.c_str());
+        std::lock_guard<std::mutex> lock(preloadMutex);
+        preloadedSources.emplace(path, std::move(shaderCode));
+    }
+}
+
+// 开始构建着色器程序
+void beginShaderProgram(const char* vertexPath, const char* fragmentPath, PendingShaderProgram& pending,
+                        const char* fragmentPrelude) {
+    pending = PendingShaderProgram();
+    pending.start = std::chrono::steady_clock::now();
+
     // 读取着色器源码
     std::string vertexCode = loadShaderSource(vertexPath);
     std::string fragmentCode = loadShaderSource(fragmentPath);
-    const char* vShaderCode = vertexCode.c_str();
-    const char* fShaderCode = fragmentCode.c_str();
-    
-    // 编译着色器
-    GLuint vertex, fragment;
-    GLint success;
-    GLchar infoLog[512];
-    
-    // 顶点着色器
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    
-    // 检查顶点着色器编译错误
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertex, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+    // 插入后再计算缓存键，公共片段的改动同样使缓存失效
+    if (fragmentPrelude)
+        fragmentCode = insertPrelude(fragmentCode, loadShaderSource(fragmentPrelude));
+
+    pending.program = glCreateProgram();
+    pending.useCache = binaryCacheAvailable();
+    pending.key = pending.useCache ? programKey(vertexCode, fragmentCode) : 0;
+
+    bool rejected = false;
+    if (pending.useCache && loadProgramBinary(pending.program, pending.key, rejected)) {
+        pending.fromCache = true;
+        return;
     }
-    
-    // 片段着色器
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    
-    // 检查片段着色器编译错误
-    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragment, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+    if (rejected) {
+        // 被拒绝的二进制可能让程序处于失败状态，换一个新的程序对象重新编译
+        std::cout << "Shader cache rejected, recompiling: " << vertexPath << " + " << fragmentPath << std::endl;
+        buildStats.cacheRejected++;
+        glDeleteProgram(pending.program);
+        pending.program = glCreateProgram();
     }
-    
-    // 着色器程序
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vertex);
-    glAttachShader(program, fragment);
-    glLinkProgram(program);
-    
-    // 检查着色器程序链接错误
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(program, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+
+    // 编译和链接一起提交，中间不查询状态，驱动可以在后台线程完成
+    pending.vertex = compileShader(GL_VERTEX_SHADER, vertexCode);
+    pending.fragment = compileShader(GL_FRAGMENT_SHADER, fragmentCode);
+    glAttachShader(pending.program, pending.vertex);
+    glAttachShader(pending.program, pending.fragment);
+    if (pending.useCache)
+        glProgramParameteri(pending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(pending.program);
+}
+
+ShaderBuildStatus finishShaderProgram(PendingShaderProgram& pending, bool block, std::string& errors) {
+    errors.clear();
+    if (!pending.fromCache) {
+        if (!block && parallelCompile) {
+            GLint completed = GL_FALSE;
+            glGetProgramiv(pending.program, GL_COMPLETION_STATUS_KHR, &completed);
+            if (!completed)
+                return ShaderBuildStatus::Pending;
+        }
+
+        appendShaderLog(pending.vertex, "VERTEX", errors);
+        appendShaderLog(pending.fragment, "FRAGMENT", errors);
+    }
+
+    GLint success;
+    glGetProgramiv(pending.program, GL_LINK_STATUS, &success);
+    if (!pending.fromCache) {
+        if (!success) {
+            GLchar infoLog[512];
+            glGetProgramInfoLog(pending.program, 512, NULL, infoLog);
+            errors += std::string("ERROR::SHADER::PROGRAM::LINKING_FAILED\n") + infoLog + "\n";
+        } else if (pending.useCache) {
+            saveProgramBinary(pending.program, pending.key);
+        }
+
+        // 删除着色器，它们已链接到程序中，不再需要
+        glDetachShader(pending.program, pending.vertex);
+        glDetachShader(pending.program, pending.fragment);
+        glDeleteShader(pending.vertex);
+        glDeleteShader(pending.fragment);
+        pending.vertex = pending.fragment = 0;
+    } else {
+        buildStats.cacheHits++;
     }
-    
-    // 删除着色器，它们已链接到程序中，不再需要
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
-    
-    return program;
-} 
\ No newline at end of file
+
+    buildStats.programs++;
+    buildStats.milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pending.start).count();
+    return success ? ShaderBuildStatus::Linked : ShaderBuildStatus::Failed;
+}
+
+// 创建着色器程序
+GLuint createShaderProgram(const char* vertexPath, const char* fragmentPath, const char* fragmentPrelude) {
+    PendingShaderProgram pending;
+    beginShaderProgram(vertexPath, fragmentPath, pending, fragmentPrelude);
+
+    std::string errors;
+    finishShaderProgram(pending, true, errors);
+    if (!errors.empty())
+        std::cout << errors << std::flush;
+    return pending.program;
+}
+
+void cancelShaderProgram(PendingShaderProgram& pending) {
+    glDeleteShader(pending.vertex);
+    glDeleteShader(pending.fragment);
+    glDeleteProgram(pending.program);
+    pending = PendingShaderProgram();
+}
+
+bool enableParallelShaderCompile()
+{
+    if (!GLEW_KHR_parallel_shader_compile)
+        return false;
+    // 0xFFFFFFFF表示由驱动决定线程数
+    glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    parallelCompile = true;
+    return true;
+}
+
+void setShaderCacheDirectory(const std::string& directory)
+{
+    cacheDirectory = directory;
+}
+
+const ShaderBuildStats& shaderBuildStats()
+{
+    return buildStats;
+}
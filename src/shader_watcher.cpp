@@ -0,0 +1,80 @@
+#include "shader_watcher.h"
+
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 等待事件的超时，决定析构时最多等多久线程退出
+const int POLL_TIMEOUT_MS = 100;
+
+} // namespace
+
+ShaderWatcher::ShaderWatcher(const std::string& directory)
+    : directory(directory)
+{
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        std::cout << "Shader watcher: inotify unavailable" << std::endl;
+        return;
+    }
+    if (inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        std::cout << "Shader watcher: cannot watch " << directory << std::endl;
+        close(inotifyFd);
+        inotifyFd = -1;
+        return;
+    }
+    watching = true;
+    thread = std::thread(&ShaderWatcher::run, this);
+#endif
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+    stopping = true;
+    if (thread.joinable())
+        thread.join();
+#ifdef __linux__
+    if (inotifyFd >= 0)
+        close(inotifyFd);
+#endif
+}
+
+std::vector<std::string> ShaderWatcher::TakeChanged()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> files(changed.begin(), changed.end());
+    changed.clear();
+    return files;
+}
+
+void ShaderWatcher::run()
+{
+#ifdef __linux__
+    // 一次read可能返回多个变长事件
+    alignas(inotify_event) char buffer[4096];
+    pollfd fd = { inotifyFd, POLLIN, 0 };
+
+    while (!stopping) {
+        if (poll(&fd, 1, POLL_TIMEOUT_MS) <= 0)
+            continue;
+
+        ssize_t length;
+        while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (char* p = buffer; p < buffer + length; ) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                if (event->len > 0 && event->name[0] != '.')
+                    changed.insert(directory + "/" + event->name);
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+#endif
+}
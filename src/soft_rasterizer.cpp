@@ -0,0 +1,628 @@
+#include "soft_rasterizer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SOFT_RASTER_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SOFT_RASTER_SSE2 1
+#endif
+
+namespace {
+
+// 一组像素的浮点向量与掩码；三种实现提供相同的操作，光栅化和着色代码只写一份
+#if defined(SOFT_RASTER_AVX2)
+
+const int LANES = 8;
+
+struct VF { __m256 v; };
+struct VM { __m256 v; };
+
+inline VF splat(float f) { return { _mm256_set1_ps(f) }; }
+inline VF load(const float* p) { return { _mm256_loadu_ps(p) }; }
+inline void store(float* p, VF a) { _mm256_storeu_ps(p, a.v); }
+inline VF laneOffsets() { return { _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f) }; }
+inline VF operator+(VF a, VF b) { return { _mm256_add_ps(a.v, b.v) }; }
+inline VF operator-(VF a, VF b) { return { _mm256_sub_ps(a.v, b.v) }; }
+inline VF operator*(VF a, VF b) { return { _mm256_mul_ps(a.v, b.v) }; }
+inline VF operator/(VF a, VF b) { return { _mm256_div_ps(a.v, b.v) }; }
+inline VF vmin(VF a, VF b) { return { _mm256_min_ps(a.v, b.v) }; }
+inline VF vmax(VF a, VF b) { return { _mm256_max_ps(a.v, b.v) }; }
+inline VF vsqrt(VF a) { return { _mm256_sqrt_ps(a.v) }; }
+inline VF vfloor(VF a) { return { _mm256_floor_ps(a.v) }; }
+inline VM operator>(VF a, VF b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+inline VM operator<(VF a, VF b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+inline VM operator>=(VF a, VF b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) }; }
+inline VM operator<=(VF a, VF b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+inline VM operator&(VM a, VM b) { return { _mm256_and_ps(a.v, b.v) }; }
+inline VF select(VM m, VF a, VF b) { return { _mm256_blendv_ps(b.v, a.v, m.v) }; }
+inline unsigned int bits(VM m) { return static_cast<unsigned int>(_mm256_movemask_ps(m.v)); }
+
+// x = m * 2^e，m在[1, 2)
+inline VF splitExponent(VF x, VF& e)
+{
+    __m256i i = _mm256_castps_si256(x.v);
+    e.v = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(i, 23), _mm256_set1_epi32(127)));
+    return { _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(i, _mm256_set1_epi32(0x007FFFFF)),
+                                                 _mm256_set1_epi32(0x3F800000))) };
+}
+
+// 2^n，n为[-126, 127]内的整数
+inline VF exponentScale(VF n)
+{
+    __m256i e = _mm256_add_epi32(_mm256_cvttps_epi32(n.v), _mm256_set1_epi32(127));
+    return { _mm256_castsi256_ps(_mm256_slli_epi32(e, 23)) };
+}
+
+#elif defined(SOFT_RASTER_SSE2)
+
+const int LANES = 4;
+
+struct VF { __m128 v; };
+struct VM { __m128 v; };
+
+inline VF splat(float f) { return { _mm_set1_ps(f) }; }
+inline VF load(const float* p) { return { _mm_loadu_ps(p) }; }
+inline void store(float* p, VF a) { _mm_storeu_ps(p, a.v); }
+inline VF laneOffsets() { return { _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f) }; }
+inline VF operator+(VF a, VF b) { return { _mm_add_ps(a.v, b.v) }; }
+inline VF operator-(VF a, VF b) { return { _mm_sub_ps(a.v, b.v) }; }
+inline VF operator*(VF a, VF b) { return { _mm_mul_ps(a.v, b.v) }; }
+inline VF operator/(VF a, VF b) { return { _mm_div_ps(a.v, b.v) }; }
+inline VF vmin(VF a, VF b) { return { _mm_min_ps(a.v, b.v) }; }
+inline VF vmax(VF a, VF b) { return { _mm_max_ps(a.v, b.v) }; }
+inline VF vsqrt(VF a) { return { _mm_sqrt_ps(a.v) }; }
+inline VM operator>(VF a, VF b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+inline VM operator<(VF a, VF b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+inline VM operator>=(VF a, VF b) { return { _mm_cmpge_ps(a.v, b.v) }; }
+inline VM operator<=(VF a, VF b) { return { _mm_cmple_ps(a.v, b.v) }; }
+inline VM operator&(VM a, VM b) { return { _mm_and_ps(a.v, b.v) }; }
+inline VF select(VM m, VF a, VF b) { return { _mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v)) }; }
+inline unsigned int bits(VM m) { return static_cast<unsigned int>(_mm_movemask_ps(m.v)); }
+
+// SSE2没有舍入指令：截断后对负的非整数再减1
+inline VF vfloor(VF a)
+{
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+    return { _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a.v), _mm_set1_ps(1.0f))) };
+}
+
+inline VF splitExponent(VF x, VF& e)
+{
+    __m128i i = _mm_castps_si128(x.v);
+    e.v = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(i, 23), _mm_set1_epi32(127)));
+    return { _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(i, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000))) };
+}
+
+inline VF exponentScale(VF n)
+{
+    __m128i e = _mm_add_epi32(_mm_cvttps_epi32(n.v), _mm_set1_epi32(127));
+    return { _mm_castsi128_ps(_mm_slli_epi32(e, 23)) };
+}
+
+#else
+
+const int LANES = 1;
+
+struct VF { float v; };
+struct VM { bool v; };
+
+inline VF splat(float f) { return { f }; }
+inline VF load(const float* p) { return { *p }; }
+inline void store(float* p, VF a) { *p = a.v; }
+inline VF laneOffsets() { return { 0.0f }; }
+inline VF operator+(VF a, VF b) { return { a.v + b.v }; }
+inline VF operator-(VF a, VF b) { return { a.v - b.v }; }
+inline VF operator*(VF a, VF b) { return { a.v * b.v }; }
+inline VF operator/(VF a, VF b) { return { a.v / b.v }; }
+inline VF vmin(VF a, VF b) { return { std::min(a.v, b.v) }; }
+inline VF vmax(VF a, VF b) { return { std::max(a.v, b.v) }; }
+inline VF vsqrt(VF a) { return { std::sqrt(a.v) }; }
+inline VF vfloor(VF a) { return { std::floor(a.v) }; }
+inline VM operator>(VF a, VF b) { return { a.v > b.v }; }
+inline VM operator<(VF a, VF b) { return { a.v < b.v }; }
+inline VM operator>=(VF a, VF b) { return { a.v >= b.v }; }
+inline VM operator<=(VF a, VF b) { return { a.v <= b.v }; }
+inline VM operator&(VM a, VM b) { return { a.v && b.v }; }
+inline VF select(VM m, VF a, VF b) { return m.v ? a : b; }
+inline unsigned int bits(VM m) { return m.v ? 1u : 0u; }
+
+inline VF splitExponent(VF x, VF& e)
+{
+    int exponent;
+    float m = std::frexp(x.v, &exponent);
+    e.v = float(exponent - 1);
+    return { 2.0f * m };
+}
+
+inline VF exponentScale(VF n) { return { std::ldexp(1.0f, int(n.v)) }; }
+
+#endif
+
+// log2(x)，x > 0；尾数m在[1, 2)，t = (m-1)/(m+1)，log2(m) = 2/ln2 * (t + t^3/3 + t^5/5 + t^7/7)，误差约2e-5
+inline VF vlog2(VF x)
+{
+    VF e;
+    VF m = splitExponent(x, e);
+    VF t = (m - splat(1.0f)) / (m + splat(1.0f));
+    VF t2 = t * t;
+    VF series = t * (splat(1.0f) + t2 * (splat(1.0f / 3.0f) + t2 * (splat(1.0f / 5.0f) + t2 * splat(1.0f / 7.0f))));
+    return e + series * splat(2.8853900817779268f);
+}
+
+// 2^y，y <= 0；整数部分直接拼进指数，小数部分用6阶泰勒展开，误差约2e-5
+inline VF vexp2(VF y)
+{
+    y = vmax(y, splat(-126.0f));
+    VF n = vfloor(y);
+    VF f = y - n;
+    VF p = splat(1.5403530393381606e-4f);
+    p = p * f + splat(1.3333558146428443e-3f);
+    p = p * f + splat(9.6181291076284772e-3f);
+    p = p * f + splat(5.5504108664821580e-2f);
+    p = p * f + splat(2.4022650695910071e-1f);
+    p = p * f + splat(6.9314718055994531e-1f);
+    p = p * f + splat(1.0f);
+    return p * exponentScale(n);
+}
+
+// pow(x, s)，x在[0, 1]；x为0时结果为0（与GLSL的pow(0, s)一致）
+inline VF vpow(VF x, float s)
+{
+    VM positive = x > splat(0.0f);
+    VF result = vexp2(vlog2(vmax(x, splat(1e-30f))) * splat(s));
+    return select(positive, result, splat(0.0f));
+}
+
+struct Vec3Lanes {
+    VF x, y, z;
+};
+
+inline VF dot(const Vec3Lanes& a, const Vec3Lanes& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+inline Vec3Lanes normalize(const Vec3Lanes& a)
+{
+    VF inv = splat(1.0f) / vsqrt(vmax(dot(a, a), splat(1e-30f)));
+    return { a.x * inv, a.y * inv, a.z * inv };
+}
+
+// 每次取的顶点块大小
+const size_t VERTEX_CHUNK = 4096;
+
+// 像素坐标吸附的精度（1/16像素），公共边两侧的三角形得到完全相同的端点
+const float SUBPIXEL = 16.0f;
+
+// 顶点按固定顺序比较，用于决定边函数从哪个端点求值
+inline bool vertexBefore(float ax, float ay, float bx, float by)
+{
+    return ax < bx || (ax == bx && ay < by);
+}
+
+// 一条边的边函数 E(p) = (p.x - x0) * gx + (p.y - y0) * gy，梯度(gx, gy)指向三角形内部
+// 从固定顺序的端点求值，公共边两侧的三角形只差梯度的符号，得到的E恰为相反数
+struct Edge {
+    float x0, y0, gx, gy;
+    bool owner;         // E恰为0的像素是否归属本三角形
+};
+
+// a→b为逆时针三角形的一条边
+inline Edge makeEdge(float ax, float ay, float bx, float by)
+{
+    Edge edge;
+    float sign = 1.0f;
+    if (!vertexBefore(ax, ay, bx, by)) {
+        std::swap(ax, bx);
+        std::swap(ay, by);
+        sign = -1.0f;
+    }
+    edge.x0 = ax;
+    edge.y0 = ay;
+    edge.gx = sign * (by - ay);
+    edge.gy = -sign * (bx - ax);
+
+    // 平局规则：公共边两侧梯度相反，只有一侧拥有E为0的像素
+    edge.owner = edge.gx > 0.0f || (edge.gx == 0.0f && edge.gy > 0.0f);
+    return edge;
+}
+
+// 一组像素是否在边的内侧
+inline VM insideEdge(const Edge& edge, VF px, float py, VF& value)
+{
+    value = (px - splat(edge.x0)) * splat(edge.gx) + splat((py - edge.y0) * edge.gy);
+    return edge.owner ? value >= splat(0.0f) : value > splat(0.0f);
+}
+
+} // namespace
+
+void SoftFramebuffer::Resize(int w, int h)
+{
+    width = w;
+    height = h;
+    color.assign(size_t(w) * h * 3, 0);
+}
+
+bool SoftFramebuffer::WritePPM(const std::string& path) const
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open())
+        return false;
+    out << "P6\n" << width << " " << height << "\n255\n";
+    out.write(reinterpret_cast<const char*>(color.data()), color.size());
+    return out.good();
+}
+
+SoftRasterizer::SoftRasterizer(unsigned int threadCount)
+    : pool(threadCount)
+{
+    triangles.resize(pool.Size());
+    bins.resize(pool.Size());
+    threadPixels.resize(pool.Size());
+    scratch.resize(pool.Size());
+    for (TileScratch& tile : scratch) {
+        tile.depth.resize(TILE_SIZE * TILE_SIZE);
+        tile.chunk.resize(TILE_SIZE * TILE_SIZE);
+        tile.triangle.resize(TILE_SIZE * TILE_SIZE);
+        tile.b1.resize(TILE_SIZE * TILE_SIZE);
+        tile.b2.resize(TILE_SIZE * TILE_SIZE);
+    }
+}
+
+int SoftRasterizer::Lanes()
+{
+    return LANES;
+}
+
+const char* SoftRasterizer::InstructionSet()
+{
+#if defined(SOFT_RASTER_AVX2)
+    return "AVX2";
+#elif defined(SOFT_RASTER_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+void SoftRasterizer::Render(const MeshData& mesh, const Camera& camera, const Light& light, const RenderSettings& settings,
+                            SoftFramebuffer& target)
+{
+    typedef std::chrono::steady_clock Clock;
+    auto milliseconds = [](Clock::time_point begin, Clock::time_point end) {
+        return std::chrono::duration<double, std::milli>(end - begin).count();
+    };
+    Clock::time_point frameBegin = Clock::now();
+
+    stats = SoftRenderStats();
+    stats.triangles = mesh.IndexCount() / 3;
+    std::fill(target.color.begin(), target.color.end(), uint8_t(0));
+    int width = target.width;
+    int height = target.height;
+    if (width <= 0 || height <= 0)
+        return;
+
+    // 顶点变换：按块取顶点，线程间用原子计数器分配
+    glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), float(width) / float(height), NEAR_PLANE, FAR_PLANE);
+    glm::mat4 viewProjection = projection * camera.GetViewMatrix();
+    const Vertex* vertices = mesh.Vertices();
+    size_t vertexCount = mesh.VertexCount();
+    clipPositions.resize(vertexCount);
+    std::atomic<size_t> nextVertex(0);
+    pool.Run([&](unsigned int) {
+        for (;;) {
+            size_t begin = nextVertex.fetch_add(VERTEX_CHUNK);
+            if (begin >= vertexCount)
+                break;
+            size_t end = std::min(begin + VERTEX_CHUNK, vertexCount);
+            for (size_t i = begin; i < end; i++)
+                clipPositions[i] = viewProjection * glm::vec4(vertices[i].Position, 1.0f);
+        }
+    });
+    Clock::time_point vertexEnd = Clock::now();
+
+    // 三角形建立：每个线程处理连续的一段索引，结果按分段保存，光栅化时按分段顺序合并
+    tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    glm::vec3 eye = camera.Position;
+    pool.Run([&](unsigned int thread) { setupTriangles(thread, mesh, eye, width, height); });
+    Clock::time_point setupEnd = Clock::now();
+
+    // 光栅化与着色：每次取一个分块，分块之间没有共享写入
+    int tileCount = tilesX * tilesY;
+    std::atomic<int> nextTile(0);
+    std::fill(threadPixels.begin(), threadPixels.end(), size_t(0));
+    pool.Run([&](unsigned int thread) {
+        for (;;) {
+            int tile = nextTile.fetch_add(1);
+            if (tile >= tileCount)
+                break;
+            rasterTile(thread, tile, settings, mesh, light, eye, target);
+        }
+    });
+    Clock::time_point frameEnd = Clock::now();
+
+    for (unsigned int t = 0; t < pool.Size(); t++) {
+        stats.rasterized += triangles[t].size();
+        stats.pixelsShaded += threadPixels[t];
+    }
+    stats.vertexMilliseconds = milliseconds(frameBegin, vertexEnd);
+    stats.setupMilliseconds = milliseconds(vertexEnd, setupEnd);
+    stats.rasterMilliseconds = milliseconds(setupEnd, frameEnd);
+    stats.totalMilliseconds = milliseconds(frameBegin, frameEnd);
+}
+
+void SoftRasterizer::setupTriangles(unsigned int chunk, const MeshData& mesh, const glm::vec3& eye, int width, int height)
+{
+    triangles[chunk].clear();
+    std::vector<std::vector<uint32_t>>& chunkBins = bins[chunk];
+    chunkBins.resize(size_t(tilesX) * tilesY);
+    for (std::vector<uint32_t>& bin : chunkBins)
+        bin.clear();
+
+    const Vertex* vertices = mesh.Vertices();
+    const unsigned int* indices = mesh.Indices();
+    size_t count = mesh.IndexCount() / 3;
+    size_t begin = count * chunk / pool.Size();
+    size_t end = count * (chunk + 1) / pool.Size();
+
+    // 裁剪空间的外侧标记：-x, +x, -y, +y, 近平面, 远平面
+    auto outcode = [](const glm::vec4& c) {
+        return (c.x < -c.w ? 1 : 0) | (c.x > c.w ? 2 : 0) | (c.y < -c.w ? 4 : 0) | (c.y > c.w ? 8 : 0) |
+               (c.z < -c.w ? 16 : 0) | (c.z > c.w ? 32 : 0);
+    };
+    const int NEAR_OUTSIDE = 16;
+
+    for (size_t t = begin; t < end; t++) {
+        ClipVertex v[3];
+        int codes[3];
+        for (int k = 0; k < 3; k++) {
+            unsigned int index = indices[3 * t + k];
+            v[k].clip = clipPositions[index];
+            v[k].position = vertices[index].Position;
+            v[k].normal = vertices[index].Normal;
+            codes[k] = outcode(v[k].clip);
+        }
+
+        // 三个顶点都在同一裁剪面外侧：整个三角形不可见
+        if (codes[0] & codes[1] & codes[2])
+            continue;
+        if (!((codes[0] | codes[1] | codes[2]) & NEAR_OUTSIDE)) {
+            emitTriangle(chunk, v, eye, width, height);
+            continue;
+        }
+
+        // 跨过近平面：只对近平面裁剪（z >= -w），其余平面由包围盒限制在屏幕内，最多得到四边形
+        ClipVertex polygon[4];
+        int n = 0;
+        for (int k = 0; k < 3; k++) {
+            const ClipVertex& a = v[k];
+            const ClipVertex& b = v[(k + 1) % 3];
+            float da = a.clip.z + a.clip.w;
+            float db = b.clip.z + b.clip.w;
+            if (da >= 0.0f)
+                polygon[n++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f)) {
+                float s = da / (da - db);
+                polygon[n].clip = a.clip + s * (b.clip - a.clip);
+                polygon[n].position = a.position + s * (b.position - a.position);
+                polygon[n].normal = a.normal + s * (b.normal - a.normal);
+                n++;
+            }
+        }
+        for (int k = 1; k + 1 < n; k++) {
+            ClipVertex fan[3] = { polygon[0], polygon[k], polygon[k + 1] };
+            emitTriangle(chunk, fan, eye, width, height);
+        }
+    }
+}
+
+void SoftRasterizer::emitTriangle(unsigned int chunk, const ClipVertex* v, const glm::vec3& eye, int width, int height)
+{
+    Triangle tri;
+    for (int k = 0; k < 3; k++) {
+        float invW = 1.0f / v[k].clip.w;
+        glm::vec3 ndc = glm::vec3(v[k].clip) * invW;
+        tri.x[k] = std::round((ndc.x * 0.5f + 0.5f) * width * SUBPIXEL) / SUBPIXEL;
+        tri.y[k] = std::round((0.5f - ndc.y * 0.5f) * height * SUBPIXEL) / SUBPIXEL;
+        tri.z[k] = ndc.z;
+        tri.invW[k] = invW;
+        tri.position[k] = v[k].position;
+        tri.normal[k] = v[k].normal;
+    }
+
+    // 统一为面积为正的顶点顺序，不做背面剔除（与model.fs的绘制一致）
+    float area = (tri.x[2] - tri.x[0]) * (tri.y[1] - tri.y[0]) - (tri.y[2] - tri.y[0]) * (tri.x[1] - tri.x[0]);
+    if (area == 0.0f)
+        return;
+    if (area < 0.0f) {
+        std::swap(tri.x[1], tri.x[2]);
+        std::swap(tri.y[1], tri.y[2]);
+        std::swap(tri.z[1], tri.z[2]);
+        std::swap(tri.invW[1], tri.invW[2]);
+        std::swap(tri.position[1], tri.position[2]);
+        std::swap(tri.normal[1], tri.normal[2]);
+    }
+
+    // 覆盖的像素中心(x + 0.5, y + 0.5)的范围
+    tri.minX = std::max(0, int(std::ceil(std::min({ tri.x[0], tri.x[1], tri.x[2] }) - 0.5f)));
+    tri.minY = std::max(0, int(std::ceil(std::min({ tri.y[0], tri.y[1], tri.y[2] }) - 0.5f)));
+    tri.maxX = std::min(width - 1, int(std::floor(std::max({ tri.x[0], tri.x[1], tri.x[2] }) - 0.5f)));
+    tri.maxY = std::min(height - 1, int(std::floor(std::max({ tri.y[0], tri.y[1], tri.y[2] }) - 0.5f)));
+    if (tri.minX > tri.maxX || tri.minY > tri.maxY)
+        return;
+
+    // 面法线朝向相机，与model.fs中由屏幕空间导数求出的法线方向相同
+    glm::vec3 face = glm::cross(tri.position[1] - tri.position[0], tri.position[2] - tri.position[0]);
+    float length = glm::length(face);
+    tri.faceNormal = length > 0.0f ? face / length : glm::vec3(0.0f);
+    if (glm::dot(tri.faceNormal, eye - tri.position[0]) < 0.0f)
+        tri.faceNormal = -tri.faceNormal;
+
+    std::vector<Triangle>& list = triangles[chunk];
+    uint32_t index = static_cast<uint32_t>(list.size());
+    list.push_back(tri);
+    for (int ty = tri.minY / TILE_SIZE; ty <= tri.maxY / TILE_SIZE; ty++)
+        for (int tx = tri.minX / TILE_SIZE; tx <= tri.maxX / TILE_SIZE; tx++)
+            bins[chunk][ty * tilesX + tx].push_back(index);
+}
+
+void SoftRasterizer::rasterTile(unsigned int thread, int tile, const RenderSettings& settings, const MeshData& mesh,
+                                const Light& light, const glm::vec3& eye, SoftFramebuffer& target)
+{
+    int tileX = (tile % tilesX) * TILE_SIZE;
+    int tileY = (tile / tilesX) * TILE_SIZE;
+    int tileEndX = std::min(tileX + TILE_SIZE, target.width) - 1;
+    int tileEndY = std::min(tileY + TILE_SIZE, target.height) - 1;
+
+    bool empty = true;
+    for (unsigned int c = 0; c < pool.Size() && empty; c++)
+        empty = bins[c][tile].empty();
+    if (empty)
+        return;
+
+    TileScratch& s = scratch[thread];
+    std::fill(s.depth.begin(), s.depth.end(), 1.0f);
+    std::fill(s.chunk.begin(), s.chunk.end(), -1);
+
+    // 第一遍：按提交顺序光栅化分块内的三角形，只做深度测试并记下可见的三角形和重心坐标
+    for (unsigned int c = 0; c < pool.Size(); c++) {
+        const std::vector<Triangle>& list = triangles[c];
+        for (uint32_t index : bins[c][tile]) {
+            const Triangle& tri = list[index];
+            int minX = std::max(tri.minX, tileX);
+            int maxX = std::min(tri.maxX, tileEndX);
+            int minY = std::max(tri.minY, tileY);
+            int maxY = std::min(tri.maxY, tileEndY);
+
+            Edge e0 = makeEdge(tri.x[0], tri.y[0], tri.x[1], tri.y[1]);
+            Edge e1 = makeEdge(tri.x[1], tri.y[1], tri.x[2], tri.y[2]);
+            Edge e2 = makeEdge(tri.x[2], tri.y[2], tri.x[0], tri.y[0]);
+            float area = (tri.x[2] - tri.x[0]) * (tri.y[1] - tri.y[0]) - (tri.y[2] - tri.y[0]) * (tri.x[1] - tri.x[0]);
+            VF invArea = splat(1.0f / area);
+
+            // 像素组在分块内按LANES对齐，分块宽度是LANES的整数倍，组不会越过分块
+            int groupBegin = tileX + (minX - tileX) / LANES * LANES;
+            for (int y = minY; y <= maxY; y++) {
+                float py = float(y) + 0.5f;
+                size_t row = size_t(y - tileY) * TILE_SIZE;
+                for (int x = groupBegin; x <= maxX; x += LANES) {
+                    VF lane = splat(float(x)) + laneOffsets();
+                    VF px = lane + splat(0.5f);
+                    VM mask = (lane >= splat(float(minX))) & (lane <= splat(float(maxX)));
+
+                    VF w0, w1, w2;
+                    mask = mask & insideEdge(e0, px, py, w2) & insideEdge(e1, px, py, w0) & insideEdge(e2, px, py, w1);
+                    if (!bits(mask))
+                        continue;
+
+                    // 屏幕空间重心坐标：深度线性插值，属性透视校正
+                    VF l0 = w0 * invArea;
+                    VF l1 = w1 * invArea;
+                    VF l2 = w2 * invArea;
+                    VF z = l0 * splat(tri.z[0]) + l1 * splat(tri.z[1]) + l2 * splat(tri.z[2]);
+                    size_t offset = row + size_t(x - tileX);
+                    VF depth = load(&s.depth[offset]);
+                    mask = mask & (z < depth);
+                    unsigned int visible = bits(mask);
+                    if (!visible)
+                        continue;
+
+                    VF p0 = l0 * splat(tri.invW[0]);
+                    VF p1 = l1 * splat(tri.invW[1]);
+                    VF p2 = l2 * splat(tri.invW[2]);
+                    VF invSum = splat(1.0f) / (p0 + p1 + p2);
+                    store(&s.depth[offset], select(mask, z, depth));
+                    store(&s.b1[offset], select(mask, p1 * invSum, load(&s.b1[offset])));
+                    store(&s.b2[offset], select(mask, p2 * invSum, load(&s.b2[offset])));
+                    for (int k = 0; k < LANES; k++) {
+                        if (visible & (1u << k)) {
+                            s.chunk[offset + k] = int32_t(c);
+                            s.triangle[offset + k] = index;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // 第二遍：每个可见像素着色一次，与lighting.glsl的主光源部分一致
+    glm::vec3 color = mesh.modelColor;
+    glm::vec3 ambient = settings.enableAmbient ? light.ambient * light.intensity * color : glm::vec3(0.0f);
+    glm::vec3 diffuse = settings.enableDiffuse ? light.diffuse * light.intensity * color : glm::vec3(0.0f);
+    glm::vec3 specular = settings.enableSpecular ? light.specular * light.intensity * color : glm::vec3(0.0f);
+    bool flat = !mesh.useVertexNormal;
+    size_t pixels = 0;
+
+    float attribute[6][LANES];
+    float result[3][LANES];
+    for (int y = tileY; y <= tileEndY; y++) {
+        size_t row = size_t(y - tileY) * TILE_SIZE;
+        for (int x = tileX; x <= tileEndX; x += LANES) {
+            size_t offset = row + size_t(x - tileX);
+            unsigned int covered = 0;
+            for (int k = 0; k < LANES; k++) {
+                int32_t c = s.chunk[offset + k];
+                if (c < 0 || x + k > tileEndX) {
+                    for (int a = 0; a < 6; a++)
+                        attribute[a][k] = 1.0f;
+                    continue;
+                }
+                covered |= 1u << k;
+                const Triangle& tri = triangles[c][s.triangle[offset + k]];
+                float b1 = s.b1[offset + k];
+                float b2 = s.b2[offset + k];
+                glm::vec3 position = tri.position[0] + b1 * (tri.position[1] - tri.position[0]) +
+                                     b2 * (tri.position[2] - tri.position[0]);
+                glm::vec3 normal = flat ? tri.faceNormal
+                                        : tri.normal[0] + b1 * (tri.normal[1] - tri.normal[0]) +
+                                              b2 * (tri.normal[2] - tri.normal[0]);
+                for (int a = 0; a < 3; a++) {
+                    attribute[a][k] = position[a];
+                    attribute[3 + a][k] = normal[a];
+                }
+            }
+            if (!covered)
+                continue;
+
+            Vec3Lanes position = { load(attribute[0]), load(attribute[1]), load(attribute[2]) };
+            Vec3Lanes norm = normalize({ load(attribute[3]), load(attribute[4]), load(attribute[5]) });
+            Vec3Lanes lightDir = normalize({ splat(light.position.x) - position.x, splat(light.position.y) - position.y,
+                                             splat(light.position.z) - position.z });
+            VF nDotL = dot(norm, lightDir);
+            VF diff = vmax(nDotL, splat(0.0f));
+
+            // reflect(-L, N) = 2 * dot(N, L) * N - L；镜面项与lighting.glsl一样不依赖漫反射是否为0
+            VF spec = splat(0.0f);
+            if (settings.enableSpecular) {
+                Vec3Lanes viewDir = normalize({ splat(eye.x) - position.x, splat(eye.y) - position.y, splat(eye.z) - position.z });
+                VF twoNDotL = nDotL + nDotL;
+                Vec3Lanes reflectDir = { twoNDotL * norm.x - lightDir.x, twoNDotL * norm.y - lightDir.y,
+                                         twoNDotL * norm.z - lightDir.z };
+                spec = vpow(vmax(dot(viewDir, reflectDir), splat(0.0f)), settings.shininess);
+            }
+
+            for (int a = 0; a < 3; a++) {
+                VF channel = splat(ambient[a]) + diff * splat(diffuse[a]) + spec * splat(specular[a]);
+                channel = vmin(vmax(channel, splat(0.0f)), splat(1.0f)) * splat(255.0f) + splat(0.5f);
+                store(result[a], channel);
+            }
+            for (int k = 0; k < LANES; k++) {
+                if (!(covered & (1u << k)))
+                    continue;
+                uint8_t* out = &target.color[(size_t(y) * target.width + x + k) * 3];
+                out[0] = uint8_t(result[0][k]);
+                out[1] = uint8_t(result[1][k]);
+                out[2] = uint8_t(result[2][k]);
+                pixels++;
+            }
+        }
+    }
+    threadPixels[thread] += pixels;
+}
@@ -1,18 +1,31 @@
 #include "text_renderer.h"
+#include "shader_utils.h"
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
-// 加载着色器函数
-std::string loadShaderSource(const char* filePath);
+namespace {
 
-// 创建着色器程序
-GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource);
+// 图集宽度，高度按需取2的幂
+const int ATLAS_WIDTH = 512;
+// 字形之间留1像素空隙，避免线性过滤时串色
+const int ATLAS_PADDING = 1;
+
+double elapsedMilliseconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
 
 TextRenderer::TextRenderer(unsigned int width, unsigned int height)
+    : atlasTexture(0), bufferCapacity(0), retainedVertices(0)
 {
     // 加载并创建着色器程序
     this->shader = createShaderProgram("shaders/text.vs", "shaders/text.fs");
@@ -23,37 +36,46 @@ TextRenderer::TextRenderer(unsigned int width, unsigned int height)
     // 设置着色器变量
     glUseProgram(this->shader);
     glUniformMatrix4fv(glGetUniformLocation(this->shader, "projection"), 1, GL_FALSE, glm::value_ptr(this->projection));
+    glUniform1i(glGetUniformLocation(this->shader, "text"), 0);
     
-    // 配置VAO/VBO用于文本四边形
+    // 配置VAO/VBO：一组用于每帧排队的文本，一组用于保留文本，顶点缓冲在Flush时按需增长
     glGenVertexArrays(1, &this->VAO);
     glGenBuffers(1, &this->VBO);
-    glBindVertexArray(this->VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+    glGenVertexArrays(1, &this->retainedVAO);
+    glGenBuffers(1, &this->retainedVBO);
+    
+    const GLuint vaos[2] = { this->VAO, this->retainedVAO };
+    const GLuint vbos[2] = { this->VBO, this->retainedVBO };
+    for (int i = 0; i < 2; i++)
+    {
+        glBindVertexArray(vaos[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, vbos[i]);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), 0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)(4 * sizeof(float)));
+    }
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
+    
+    for (Character& ch : this->Characters)
+        ch = Character{ glm::vec4(0.0f), glm::ivec2(0), glm::ivec2(0), 0 };
 }
 
 TextRenderer::~TextRenderer()
 {
     // 清理资源
-    for (auto& ch : Characters)
-    {
-        glDeleteTextures(1, &ch.second.TextureID);
-    }
+    glDeleteTextures(1, &this->atlasTexture);
     glDeleteVertexArrays(1, &this->VAO);
     glDeleteBuffers(1, &this->VBO);
+    glDeleteVertexArrays(1, &this->retainedVAO);
+    glDeleteBuffers(1, &this->retainedVBO);
     glDeleteProgram(this->shader);
 }
 
-bool TextRenderer::Load(std::string font, unsigned int fontSize)
+bool rasterizeFontAtlas(const std::string& font, unsigned int fontSize, FontAtlas& atlas)
 {
-    // 清除之前加载的字符
-    this->Characters.clear();
-    
-    // 初始化FreeType库
+    // 初始化FreeType库（每次调用各自一个实例，可以与其他线程并行）
     FT_Library ft;
     if (FT_Init_FreeType(&ft))
     {
@@ -66,18 +88,22 @@ bool TextRenderer::Load(std::string font, unsigned int fontSize)
     if (FT_New_Face(ft, font.c_str(), 0, &face))
     {
         std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+        FT_Done_FreeType(ft);
         return false;
     }
     
     // 设置字体大小
     FT_Set_Pixel_Sizes(face, 0, fontSize);
     
-    // 禁用字节对齐限制
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    // 先光栅化全部字形，再按行(shelf)排布到图集中
+    std::vector<unsigned char> bitmaps[128];
+    int shelfX = ATLAS_PADDING, shelfY = ATLAS_PADDING, shelfHeight = 0;
+    std::vector<glm::ivec2> offsets(128, glm::ivec2(0));
     
-    // 加载前128个ASCII字符
-    for (GLubyte c = 0; c < 128; c++)
+    for (int c = 0; c < 128; c++)
     {
+        atlas.characters[c] = Character{ glm::vec4(0.0f), glm::ivec2(0), glm::ivec2(0), 0 };
+        
         // 加载字符的字形
         if (FT_Load_Char(face, c, FT_LOAD_RENDER))
         {
@@ -85,36 +111,50 @@ bool TextRenderer::Load(std::string font, unsigned int fontSize)
             continue;
         }
         
-        // 生成纹理
-        GLuint texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-        );
-        
-        // 设置纹理选项
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        
-        // 存储字符
-        Character character = {
-            texture,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            static_cast<GLuint>(face->glyph->advance.x)
+        FT_GlyphSlot glyph = face->glyph;
+        int w = glyph->bitmap.width;
+        int h = glyph->bitmap.rows;
+        
+        // 位图按pitch逐行复制为紧密排列
+        bitmaps[c].resize(size_t(w) * h);
+        for (int row = 0; row < h; row++)
+            std::memcpy(&bitmaps[c][size_t(row) * w], glyph->bitmap.buffer + row * glyph->bitmap.pitch, w);
+        
+        if (shelfX + w + ATLAS_PADDING > ATLAS_WIDTH) {
+            shelfX = ATLAS_PADDING;
+            shelfY += shelfHeight + ATLAS_PADDING;
+            shelfHeight = 0;
+        }
+        offsets[c] = glm::ivec2(shelfX, shelfY);
+        shelfX += w + ATLAS_PADDING;
+        shelfHeight = std::max(shelfHeight, h);
+        
+        atlas.characters[c] = Character{
+            glm::vec4(0.0f),
+            glm::ivec2(w, h),
+            glm::ivec2(glyph->bitmap_left, glyph->bitmap_top),
+            static_cast<GLuint>(glyph->advance.x)
         };
-        Characters.insert(std::pair<char, Character>(c, character));
+    }
+    
+    int atlasHeight = 1;
+    while (atlasHeight < shelfY + shelfHeight + ATLAS_PADDING)
+        atlasHeight *= 2;
+    
+    atlas.width = ATLAS_WIDTH;
+    atlas.height = atlasHeight;
+    atlas.pixels.assign(size_t(ATLAS_WIDTH) * atlasHeight, 0);
+    for (int c = 0; c < 128; c++)
+    {
+        Character& ch = atlas.characters[c];
+        for (int row = 0; row < ch.Size.y; row++)
+            std::memcpy(&atlas.pixels[size_t(offsets[c].y + row) * ATLAS_WIDTH + offsets[c].x], &bitmaps[c][size_t(row) * ch.Size.x], ch.Size.x);
+        
+        ch.UV = glm::vec4(
+            float(offsets[c].x) / ATLAS_WIDTH,
+            float(offsets[c].y) / atlasHeight,
+            float(offsets[c].x + ch.Size.x) / ATLAS_WIDTH,
+            float(offsets[c].y + ch.Size.y) / atlasHeight);
     }
     
     // 清理资源
@@ -124,19 +164,48 @@ bool TextRenderer::Load(std::string font, unsigned int fontSize)
     return true;
 }
 
-void TextRenderer::RenderText(std::string text, float x, float y, float scale, glm::vec3 color)
+bool TextRenderer::Load(std::string font, unsigned int fontSize)
+{
+    FontAtlas atlas;
+    if (!rasterizeFontAtlas(font, fontSize, atlas))
+        return false;
+    SetAtlas(atlas);
+    return true;
+}
+
+void TextRenderer::SetAtlas(const FontAtlas& atlas)
 {
-    // 激活对应的渲染状态
-    glUseProgram(this->shader);
-    glUniform3f(glGetUniformLocation(this->shader, "textColor"), color.x, color.y, color.z);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(this->VAO);
+    std::copy(atlas.characters, atlas.characters + 128, this->Characters);
+    
+    // 禁用字节对齐限制
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    
+    // 整张图集只生成一个纹理
+    if (this->atlasTexture == 0)
+        glGenTextures(1, &this->atlasTexture);
+    glBindTexture(GL_TEXTURE_2D, this->atlasTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, atlas.width, atlas.height, 0, GL_RED, GL_UNSIGNED_BYTE, atlas.pixels.data());
+    
+    // 设置纹理选项
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    // 字形尺寸可能变了，保留文本全部重新排版
+    for (RetainedText& item : retained)
+        item.dirty = true;
+}
+
+unsigned int TextRenderer::layoutText(const char* text, size_t length, float x, float y, float scale, glm::vec3 color, std::vector<float>& out) const
+{
+    unsigned int glyphs = 0;
     
     // 遍历文本中的所有字符
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++)
+    for (size_t i = 0; i < length; i++)
     {
-        Character ch = Characters[*c];
+        const Character& ch = Characters[static_cast<unsigned char>(text[i]) & 0x7F];
         
         float xpos = x + ch.Bearing.x * scale;
         float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
@@ -144,32 +213,163 @@ void TextRenderer::RenderText(std::string text, float x, float y, float scale, g
         float w = ch.Size.x * scale;
         float h = ch.Size.y * scale;
         
-        // 为每个字符更新VBO
-        float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos,     ypos,       0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-            
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 0.0f }
-        };
+        // 空白字符只前进不出四边形
+        if (ch.Size.x > 0 && ch.Size.y > 0)
+        {
+            const float u0 = ch.UV.x, v0 = ch.UV.y, u1 = ch.UV.z, v1 = ch.UV.w;
+            const float vertices[6][FLOATS_PER_VERTEX] = {
+                { xpos,     ypos + h,   u0, v0, color.x, color.y, color.z },
+                { xpos,     ypos,       u0, v1, color.x, color.y, color.z },
+                { xpos + w, ypos,       u1, v1, color.x, color.y, color.z },
+                
+                { xpos,     ypos + h,   u0, v0, color.x, color.y, color.z },
+                { xpos + w, ypos,       u1, v1, color.x, color.y, color.z },
+                { xpos + w, ypos + h,   u1, v0, color.x, color.y, color.z }
+            };
+            out.insert(out.end(), &vertices[0][0], &vertices[0][0] + 6 * FLOATS_PER_VERTEX);
+            glyphs++;
+        }
         
-        // 渲染字形纹理
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
+        // 更新位置到下一个字形
+        x += (ch.Advance >> 6) * scale; // 位偏移是以1/64像素表示的，所以需要除以64
+    }
+    
+    return glyphs;
+}
+
+void TextRenderer::RenderText(const std::string& text, float x, float y, float scale, glm::vec3 color)
+{
+    auto start = std::chrono::steady_clock::now();
+    frameStats.glyphs += layoutText(text.data(), text.size(), x, y, scale, color, pending);
+    frameStats.cpuMilliseconds += elapsedMilliseconds(start);
+}
+
+TextHandle TextRenderer::CreateText()
+{
+    RetainedText item = { std::string(), 0.0f, 0.0f, 1.0f, glm::vec3(1.0f), 0, 0, true };
+    retained.push_back(item);
+    return static_cast<TextHandle>(retained.size() - 1);
+}
+
+void TextRenderer::SetText(TextHandle handle, const char* text, float x, float y, float scale, glm::vec3 color)
+{
+    RetainedText& item = retained[handle];
+    
+    // 与缓存比较，全部相同则什么都不做
+    if (item.text == text && item.x == x && item.y == y && item.scale == scale && item.color == color)
+        return;
+    
+    item.text = text;
+    item.x = x;
+    item.y = y;
+    item.scale = scale;
+    item.color = color;
+    item.dirty = true;
+}
+
+void TextRenderer::uploadRetained()
+{
+    const size_t stride = FLOATS_PER_VERTEX * sizeof(float);
+    
+    // 某条文本超出预留空间时整体重排，否则只覆盖变化的那一段
+    bool rebuild = false;
+    for (const RetainedText& item : retained)
+    {
+        if (item.dirty && item.text.size() * 6 > item.capacity)
+            rebuild = true;
+    }
+    
+    if (rebuild)
+    {
+        layoutScratch.clear();
+        for (RetainedText& item : retained)
+        {
+            item.firstVertex = layoutScratch.size() / FLOATS_PER_VERTEX;
+            item.capacity = (item.text.size() + RETAINED_SLACK_GLYPHS) * 6;
+            layoutText(item.text.data(), item.text.size(), item.x, item.y, item.scale, item.color, layoutScratch);
+            layoutScratch.resize((item.firstVertex + item.capacity) * FLOATS_PER_VERTEX, 0.0f);
+            item.dirty = false;
+            frameStats.layouts++;
+        }
+        
+        retainedVertices = layoutScratch.size() / FLOATS_PER_VERTEX;
+        glBindBuffer(GL_ARRAY_BUFFER, this->retainedVBO);
+        glBufferData(GL_ARRAY_BUFFER, layoutScratch.size() * sizeof(float), layoutScratch.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        frameStats.uploadBytes += layoutScratch.size() * sizeof(float);
+        return;
+    }
+    
+    for (RetainedText& item : retained)
+    {
+        if (!item.dirty)
+            continue;
         
-        // 更新VBO内存
+        // 未用完的预留部分填0，成为不产生片段的退化三角形
+        layoutScratch.clear();
+        layoutText(item.text.data(), item.text.size(), item.x, item.y, item.scale, item.color, layoutScratch);
+        layoutScratch.resize(item.capacity * FLOATS_PER_VERTEX, 0.0f);
+        
+        glBindBuffer(GL_ARRAY_BUFFER, this->retainedVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, item.firstVertex * stride, item.capacity * stride, layoutScratch.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        frameStats.uploadBytes += item.capacity * stride;
+        frameStats.layouts++;
+        item.dirty = false;
+    }
+}
+
+void TextRenderer::Flush()
+{
+    auto start = std::chrono::steady_clock::now();
+    
+    uploadRetained();
+    
+    if (retainedVertices > 0 || !pending.empty())
+    {
+        // 激活对应的渲染状态
+        glUseProgram(this->shader);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, this->atlasTexture);
+    }
+    
+    // 保留文本：缓冲已在GPU上，直接一次绘制
+    if (retainedVertices > 0)
+    {
+        glBindVertexArray(this->retainedVAO);
+        glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(retainedVertices));
+        frameStats.drawCalls++;
+    }
+    
+    if (!pending.empty())
+    {
+        glBindVertexArray(this->VAO);
         glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+        
+        // 容量不足时扩容，否则先orphan旧存储再写入，避免与上一帧的绘制同步
+        size_t bytes = pending.size() * sizeof(float);
+        if (bytes > bufferCapacity)
+            bufferCapacity = std::max(bytes, bufferCapacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, bufferCapacity, NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, pending.data());
         glBindBuffer(GL_ARRAY_BUFFER, 0);
+        frameStats.uploadBytes += bytes;
         
-        // 渲染四边形
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        // 一次绘制全部字形
+        glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(pending.size() / FLOATS_PER_VERTEX));
+        frameStats.drawCalls++;
         
-        // 更新位置到下一个字形
-        x += (ch.Advance >> 6) * scale; // 位偏移是以1/64像素表示的，所以需要除以64
+        // 保留容量，下一帧复用
+        pending.clear();
     }
     
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-} 
\ No newline at end of file
+    if (frameStats.drawCalls > 0)
+    {
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    
+    frameStats.cpuMilliseconds += elapsedMilliseconds(start);
+    lastStats = frameStats;
+    frameStats = TextStats();
+}
@@ -0,0 +1,127 @@
+// 网格简化的边界检查：开放网格逐级简化后，边界边只能连接原网格的边界顶点，轮廓不被拉进内部
+// 以及封闭网格的判断（isClosedMesh）
+#include "mesh_simplify.h"
+
+#include <cfloat>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// columns x rows个顶点的开放波浪网格，间距为1/64
+void buildGrid(unsigned int columns, unsigned int rows, std::vector<glm::vec3>& positions, std::vector<unsigned int>& indices)
+{
+    positions.clear();
+    indices.clear();
+    for (unsigned int j = 0; j < rows; j++) {
+        for (unsigned int i = 0; i < columns; i++) {
+            float x = i / 64.0f;
+            float y = j / 64.0f;
+            positions.push_back(glm::vec3(x, y, 0.1f * std::sin(3.0f * x) * std::cos(2.0f * y)));
+        }
+    }
+    for (unsigned int j = 0; j + 1 < rows; j++) {
+        for (unsigned int i = 0; i + 1 < columns; i++) {
+            unsigned int a = j * columns + i, b = a + 1, c = a + columns, d = c + 1;
+            indices.insert(indices.end(), { a, b, d, a, d, c });
+        }
+    }
+}
+
+// 只出现在一个三角形中的有向边
+std::vector<std::pair<unsigned int, unsigned int>> borderEdges(const unsigned int* indices, size_t count)
+{
+    std::map<std::pair<unsigned int, unsigned int>, int> edges;
+    for (size_t i = 0; i < count; i += 3)
+        for (int e = 0; e < 3; e++)
+            edges[{ indices[i + e], indices[i + (e + 1) % 3] }]++;
+
+    std::vector<std::pair<unsigned int, unsigned int>> border;
+    for (const auto& edge : edges)
+        if (!edges.count({ edge.first.second, edge.first.first }))
+            border.push_back(edge.first);
+    return border;
+}
+
+// 逐级简化，返回失败的检查数
+int checkGrid(unsigned int columns, unsigned int rows)
+{
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+    buildGrid(columns, rows, positions, indices);
+    std::cout << columns << "x" << rows << " grid:" << std::endl;
+
+    std::vector<unsigned char> onBorder(positions.size(), 0);
+    for (const auto& edge : borderEdges(indices.data(), indices.size()))
+        onBorder[edge.first] = onBorder[edge.second] = 1;
+
+    std::vector<unsigned int> lodIndices;
+    std::vector<MeshLod> lods;
+    buildLodChain(positions.data(), positions.size(), indices.data(), indices.size(), 8, lodIndices, lods);
+
+    int failures = 0;
+    for (size_t level = 1; level < lods.size(); level++) {
+        const MeshLod& lod = lods[level];
+        if (!(lod.error < FLT_MAX)) {
+            std::cout << "  LOD " << level << ": error is not finite" << std::endl;
+            failures++;
+        }
+
+        // 边界环仍由原边界顶点组成，且不会出现新的洞（边界边数不少于四条边）
+        std::vector<std::pair<unsigned int, unsigned int>> border = borderEdges(&lodIndices[lod.indexOffset], lod.indexCount);
+        size_t moved = 0;
+        for (const auto& edge : border)
+            if (!onBorder[edge.first] || !onBorder[edge.second])
+                moved++;
+        if (moved > 0 || border.size() < 4) {
+            std::cout << "  LOD " << level << ": " << moved << " of " << border.size()
+                      << " border edges leave the original outline" << std::endl;
+            failures++;
+        }
+        std::cout << "  LOD " << level << ": " << lod.indexCount / 3 << " triangles, error " << lod.error
+                  << ", " << border.size() << " border edges" << std::endl;
+    }
+
+    if (lods.size() < 3) {
+        std::cout << "  Only " << lods.size() << " LOD levels were built" << std::endl;
+        failures++;
+    }
+    return failures;
+}
+
+// 封闭网格判断：四面体封闭，去掉一个面或网格都是开放的
+int checkClosed()
+{
+    std::vector<unsigned int> tetrahedron = { 0, 2, 1, 0, 1, 3, 1, 2, 3, 2, 0, 3 };
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> grid;
+    buildGrid(16, 16, positions, grid);
+
+    int failures = 0;
+    if (!isClosedMesh(tetrahedron.data(), tetrahedron.size(), 4)) {
+        std::cout << "Tetrahedron is not reported closed" << std::endl;
+        failures++;
+    }
+    if (isClosedMesh(tetrahedron.data(), tetrahedron.size() - 3, 4)) {
+        std::cout << "Tetrahedron without a face is reported closed" << std::endl;
+        failures++;
+    }
+    if (isClosedMesh(grid.data(), grid.size(), positions.size())) {
+        std::cout << "Grid is reported closed" << std::endl;
+        failures++;
+    }
+    return failures;
+}
+
+} // namespace
+
+int main()
+{
+    // 方形网格，以及只有几行的长条：长条的内部边两端都是边界顶点，允许的折叠很快用完
+    int failures = checkGrid(64, 64) + checkGrid(200, 2) + checkGrid(200, 4) + checkClosed();
+    std::cout << (failures ? "FAILED" : "PASSED") << std::endl;
+    return failures ? 1 : 0;
+}